@@ -15,8 +15,11 @@
  * on <http://www.gnu.org/licenses/>.
 */
 
+#include <map>
+
 #include <ros/ros.h>
 #include <sensor_msgs/PointCloud2.h>
+#include <std_msgs/UInt64.h>
 
 namespace ros_tools
 {
@@ -40,28 +43,51 @@ namespace ros_tools
     bool rerouteOneToTopic(ros::Duration max_wait_time = ros::Duration(1));
     
     
-    /*! Reroutes the next incoming pointcloud to the service.
-     * @param max_wait_time Max wait time before rerouting is considered to have failed.
-     * @return True if a data packet was rerouted.
+    /*! Reroutes the next incoming pointcloud to the service. If the service only queued the cloud, it waits until its sequence number
+     * is published on the "<out_name>_integrated" topic, i.e. until the map contains it, or on the "<out_name>_dropped" topic.
+     * @param max_integration_time Max time to wait for a queued cloud to be integrated before rerouting is considered to have failed.
+     * @return True if a data packet was rerouted and integrated.
      */
-    bool rerouteOneToSrv();
+    bool rerouteOneToSrv( ros::Duration max_integration_time = ros::Duration(60) );
     
   protected:
     /*! Called for incoming pointclouds.
      */
     void pclCallback( const sensor_msgs::PointCloud2ConstPtr& msg );
     
+    /*! Called with the sequence numbers of integrated clouds.
+     */
+    void integratedCallback( const std_msgs::UInt64ConstPtr& msg );
+    
+    /*! Called with the sequence numbers of dropped clouds.
+     */
+    void droppedCallback( const std_msgs::UInt64ConstPtr& msg );
+    
+    /*! Records the final state of a cloud and stops waiting if it is the awaited one.
+     * @param sequence_nr Sequence number of the cloud.
+     * @param integrated True if it was integrated, false if it was dropped.
+     */
+    void setFinished( uint64_t sequence_nr, bool integrated );
+    
   protected:
     ros::NodeHandle nh_;
     ros::Subscriber pcl_subscriber_;
     ros::Publisher pcl_publisher_;
     ros::ServiceClient pcl_service_caller_;
+    ros::Subscriber integrated_subscriber_;
+    ros::Subscriber dropped_subscriber_;
     
     bool forward_one_;
     bool has_published_one_;
     
     bool one_to_srv_;
     bool service_response_;
+    
+    bool waiting_for_integration_; //! True while waiting for the integration of a queued cloud.
+    uint64_t awaited_sequence_nr_; //! Sequence number of the queued cloud.
+    std::map<uint64_t,bool> finished_; //! Whether the most recent finished clouds were integrated (true) or dropped (false).
+    ros::Duration max_integration_time_; //! Max time to wait for the integration of a queued cloud.
+    ros::Time integration_deadline_; //! Until when the integration of the awaited cloud is waited for.
   };
   
 }
\ No newline at end of file
@@ -26,10 +26,14 @@ namespace ros_tools
   , forward_one_(false)
   , has_published_one_(false)
   , one_to_srv_(false)
+  , waiting_for_integration_(false)
+  , awaited_sequence_nr_(0)
   {
     pcl_subscriber_ = nh_.subscribe( in_name,1, &PclRerouter::pclCallback, this );
     pcl_publisher_ = nh_.advertise<sensor_msgs::PointCloud2>(out_name, 1);
     pcl_service_caller_ = nh_.serviceClient<ig_active_reconstruction_msgs::PclInput>(out_name);
+    integrated_subscriber_ = nh_.subscribe( out_name+"_integrated",10, &PclRerouter::integratedCallback, this );
+    dropped_subscriber_ = nh_.subscribe( out_name+"_dropped",10, &PclRerouter::droppedCallback, this );
   }
   
   bool PclRerouter::rerouteOneToTopic(ros::Duration max_wait_time)
@@ -52,15 +56,24 @@ namespace ros_tools
     return has_published_one_;
   }
   
-  bool PclRerouter::rerouteOneToSrv()
+  bool PclRerouter::rerouteOneToSrv( ros::Duration max_integration_time )
   {
     has_published_one_ = false;
+    max_integration_time_ = max_integration_time;
     one_to_srv_ = true;
     ros::spinOnce();
     
-    while( one_to_srv_ && nh_.ok() )
+    while( (one_to_srv_ || waiting_for_integration_) && nh_.ok() )
     {
       ros::spinOnce();
+      
+      if( waiting_for_integration_ && ros::Time::now()>integration_deadline_ )
+      {
+	ROS_WARN_STREAM("PclRerouter::Pointcloud "<<awaited_sequence_nr_<<" wasn't reported as integrated or dropped in time, giving up.");
+	waiting_for_integration_ = false;
+	service_response_ = false;
+	break;
+      }
       ros::Duration(0.01).sleep();
     }
     return service_response_;
@@ -81,9 +94,49 @@ namespace ros_tools
       pcl_service_caller_.call(call);
       service_response_ = call.response.success;
       one_to_srv_ = false;
+      
+      // the input integrates the cloud asynchronously: wait until the map contains it or it was dropped
+      if( call.response.queued )
+      {
+	awaited_sequence_nr_ = call.response.sequence_nr;
+	integration_deadline_ = ros::Time::now() + max_integration_time_;
+	
+	std::map<uint64_t,bool>::iterator finished = finished_.find(awaited_sequence_nr_);
+	if( finished!=finished_.end() ) // was reported before the service returned
+	  service_response_ = finished->second;
+	else
+	  waiting_for_integration_ = true;
+      }
     }
     
     return;
   }
   
+  void PclRerouter::integratedCallback( const std_msgs::UInt64ConstPtr& msg )
+  {
+    setFinished(msg->data,true);
+  }
+  
+  void PclRerouter::droppedCallback( const std_msgs::UInt64ConstPtr& msg )
+  {
+    setFinished(msg->data,false);
+  }
+  
+  void PclRerouter::setFinished( uint64_t sequence_nr, bool integrated )
+  {
+    finished_[sequence_nr] = integrated;
+    
+    // only the most recent ones are kept
+    while( finished_.size()>1000 )
+    {
+      finished_.erase(finished_.begin());
+    }
+    
+    if( waiting_for_integration_ && sequence_nr==awaited_sequence_nr_ )
+    {
+      service_response_ = integrated;
+      waiting_for_integration_ = false;
+    }
+  }
+  
 }
\ No newline at end of file
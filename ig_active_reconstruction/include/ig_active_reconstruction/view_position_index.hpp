@@ -0,0 +1,156 @@
+/* Copyright (c) 2016, Stefan Isler, islerstefan@bluewin.ch
+ * (ETH Zurich / Robotics and Perception Group, University of Zurich, Switzerland)
+ *
+ * This file is part of ig_active_reconstruction, software for information gain based, active reconstruction.
+ *
+ * ig_active_reconstruction is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * ig_active_reconstruction is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ * Please refer to the GNU Lesser General Public License for details on the license,
+ * on <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <vector>
+#include <unordered_map>
+
+#include <Eigen/Core>
+#include "movements/core"
+#include "ig_active_reconstruction/view.hpp"
+
+namespace ig_active_reconstruction
+{
+  
+namespace views
+{
+  
+  /*! Viewing frustum of a pinhole camera, used for containment queries. The z-axis of the pose is the optical axis,
+   * the x-axis points to the right and the y-axis downwards (same convention as the ray caster).
+   */
+  struct Frustum
+  {
+    Frustum();
+    
+    /*! Whether a point (in world coordinates) lies within the frustum.
+     */
+    bool contains( const Eigen::Vector3d& point ) const;
+    
+    /*! Computes the eight corners of the frustum in world coordinates, first the four of the near plane, then those of the far plane.
+     */
+    void corners( std::vector<Eigen::Vector3d>& out ) const;
+    
+    movements::Pose pose; //! Pose of the camera in world coordinates.
+    double horizontal_fov_rad; //! Full horizontal field of view. Default: 1.0 (roughly 57°).
+    double vertical_fov_rad; //! Full vertical field of view. Default: 0.8.
+    double near_m; //! Minimal distance along the optical axis. Default: 0.
+    double far_m; //! Maximal distance along the optical axis. Default: 1.
+  };
+  
+  /*! Uniform grid over view positions, used by the ViewSpace to answer neighbour, range and frustum queries without
+   * scanning all views. Views are hashed into cubic cells, only occupied cells are stored. Insertions and deletions are
+   * O(1), queries only visit the cells that overlap the queried region (falling back to a scan over all occupied cells
+   * if the region covers more cells than are occupied).
+   * 
+   * The index only stores ids and positions: if the position of a view changes, it has to be erased and reinserted.
+   */
+  class ViewPositionIndex
+  {
+  public:
+    typedef View::IdType IdType;
+    typedef std::vector<IdType> IdSet;
+    
+  public:
+    /*! Constructor.
+     * @param cell_size_m Edge length of the grid cells. Ideally in the order of the typical query radius. Default: 0.25.
+     */
+    ViewPositionIndex( double cell_size_m = 0.25 );
+    
+    /*! Changes the cell size and rebuilds the grid.
+     */
+    void setCellSize( double cell_size_m );
+    
+    /*! Returns the edge length of the grid cells.
+     */
+    double cellSize() const;
+    
+    /*! Adds a view position to the index.
+     */
+    void insert( IdType id, const Eigen::Vector3d& position );
+    
+    /*! Removes a view from the index.
+     * @param id Id of the view.
+     * @param position Position with which the view was inserted.
+     * @return True if it was found (and therefore removed).
+     */
+    bool erase( IdType id, const Eigen::Vector3d& position );
+    
+    /*! Removes all entries.
+     */
+    void clear();
+    
+    /*! Returns the number of indexed views.
+     */
+    size_t size() const;
+    
+    /*! Returns the ids of the k views closest to a position, sorted by increasing distance (ties are sorted by id).
+     * If less than k views are indexed, all of them are returned.
+     * @param position Position to which the distances are calculated.
+     * @param k Number of neighbours.
+     * @param out (output) Found ids are appended.
+     */
+    void kNearest( const Eigen::Vector3d& position, unsigned int k, IdSet& out ) const;
+    
+    /*! Returns the ids of all views within a certain distance (<=) of a position, in no particular order.
+     * @param position Position to which the distances are calculated.
+     * @param distance Maximal distance.
+     * @param out (output) Found ids are appended.
+     */
+    void inRange( const Eigen::Vector3d& position, double distance, IdSet& out ) const;
+    
+    /*! Returns the ids of all views whose position lies within a frustum, in no particular order.
+     * @param frustum The frustum.
+     * @param out (output) Found ids are appended.
+     */
+    void inFrustum( const Frustum& frustum, IdSet& out ) const;
+    
+  private:
+    struct Entry
+    {
+      IdType id;
+      Eigen::Vector3d position;
+    };
+    typedef std::vector<Entry> Cell;
+    typedef uint64_t CellKey;
+    typedef std::unordered_map<CellKey,Cell> Grid;
+    
+  private:
+    /*! Cell coordinate of a scalar position along one axis.
+     */
+    long cellCoordinate( double value ) const;
+    
+    /*! Packs three cell coordinates into a key. Coordinates wrap around after 2^21 cells, which only makes distinct cells
+     * share a bucket (all candidates are checked against their actual position anyway).
+     */
+    static CellKey key( long x, long y, long z );
+    
+    /*! Calls visitor(id,position) for all entries in the cells overlapping the axis aligned box [min,max] (world coordinates), or for all
+     * entries if the box covers more cells than are occupied.
+     */
+    template<class VISITOR>
+    void visitBox( const Eigen::Vector3d& min, const Eigen::Vector3d& max, VISITOR& visitor ) const;
+    
+  private:
+    double cell_size_m_;
+    Grid grid_;
+    size_t size_;
+  };
+  
+}
+
+}
\ No newline at end of file
@@ -20,9 +20,12 @@
 
 #include <Eigen/StdVector>
 #include "ig_active_reconstruction/view.hpp"
+#include "ig_active_reconstruction/view_position_index.hpp"
 
-#include <map> //TODO use unordered map as soon as cpp03 is not needed anymore
+#include <unordered_map>
+#include <deque>
 #include <iterator>
+#include <cstdint>
 
 namespace ig_active_reconstruction
 {
@@ -32,18 +35,35 @@ namespace views
 
 /*! Container class for possible camera orientations (views).
  * 
- * TODO: Change internal implementation details to speed up insertions and deletions.
+ * Views are stored contiguously in slots, with an id->slot hash map for access by id. Deletions move the last view into the freed
+ * slot (swap and pop), hence iteration order is insertion order only as long as no views are deleted. Ids, poses, visit counts and
+ * the reachable/bad/visited flags are additionally mirrored in dense per-slot arrays (flags as bitsets), such that filters over the
+ * whole view space do not need to touch the View objects.
+ * 
+ * View positions are also kept in a uniform grid (ViewPositionIndex), such that neighbour, range and frustum queries
+ * only visit views close to the queried region. Poses, flags and visit counts must therefore not be changed through the iterators,
+ * but only through the setters of the view space.
+ * 
+ * Every modification increases the version of the view space. Together with the epoch, which identifies the view space instance
+ * (copies included), it allows remote copies to synchronize incrementally using getChangesSince.
  */
 class ViewSpace
 {
 public:
-  //typedef std::map<View::IdType, View >::iterator Iterator;
   class Iterator; // forward declaration for bidirectional iterator type to View
-  //typedef std::map<View::IdType, View >::const_iterator ConstIterator;
   class ConstIterator; // forward declaration for bidirectional iterator type to const View
   
   typedef std::vector<View::IdType> IdSet;
   
+  /*! Changes between two versions of the view space.
+   */
+  struct ChangeSet
+  {
+    IdSet updated; //! Views that were added or replaced (pose and all other data may have changed).
+    IdSet state_changed; //! Views of which only flags or the visit count changed.
+    IdSet deleted; //! Deleted views. A view may be deleted and then added again, thus deletions must be applied first.
+  };
+  
 public:
   
   ViewSpace();
@@ -53,6 +73,7 @@ public:
   std::vector<View, Eigen::aligned_allocator<View> > getViewSpace();
   
   /*! returns indexes of all view points in the view space as a vector that are reachable, are not "bad" and (optionally) have never been visited.
+   * Scans the flag bitsets, 64 views at a time.
    * @param ignore_visited whether already visited views are left out of the "good viewspace" or not
    */
   void getGoodViewSpace( IdSet& out, bool ignore_visited=true );
@@ -63,8 +84,13 @@ public:
    */
   View getView( View::IdType index );
   
-  /*! Removes the given view from the view space if it is found.
-   * TODO: Current implementation is rather slow.
+  /*!
+   * returns a reference to the view corresponding to index _index, without copying it. The reference is invalidated if views are added or deleted.
+   * @throws std::out_of_range if _index is invalid
+   */
+  const View& getViewRef( View::IdType index ) const;
+  
+  /*! Removes the given view from the view space if it is found. O(1): the last view is moved into the freed slot.
    * 
    * @param index Index of the view.
    * @return True if it was found (and therefore removed).
@@ -72,7 +98,6 @@ public:
   bool deleteView( View::IdType index );
   
   /*! Removes a set of views from the view space if they are found.
-   * TODO: Current implementation is slow.
    * 
    * @param index_set Set of indices of views that shall be deleted.
    * @return True if all views were found (and deleted). If it is false, some may still have been deleted.
@@ -92,6 +117,10 @@ public:
   void setUnReachable( View::IdType index );
   void setReachable( View::IdType index );
   
+  /*! Sets how many times the view with index _index has been visited.
+   */
+  void setTimesVisited( View::IdType index, unsigned int times_visited );
+  
   /*! adds a new view point to the view space
    * @param _new_vp the new view point
    */
@@ -103,6 +132,19 @@ public:
    */
   View getAClosestNeighbour( View& view );
   
+  /*! returns the id of the view closest to the position passed. If more than one views have the same distance, the one with the smallest id is returned.
+   * @param position position for which the closest view is sought
+   * @throws std::runtime_error if the view space is empty
+   */
+  View::IdType getAClosestNeighbourId( const Eigen::Vector3d& position ) const;
+  
+  /*! returns the ids of the k views closest to a position, ignoring orientation, sorted by increasing distance.
+   * @param position position from which the distances are calculated
+   * @param k number of neighbours. If the view space contains less views, all of them are returned.
+   * @param out (output) found ids are appended
+   */
+  void getKNearest( const Eigen::Vector3d& position, unsigned int k, IdSet& out ) const;
+  
   /*!
    * return the size of the view space
    */
@@ -115,14 +157,48 @@ public:
    */
   void getViewsInRange( View& reference_view, double distance, std::vector<View, Eigen::aligned_allocator<View> >& sub_space );
   
+  /*! returns the ids of all views within a certain range (distance) of a position, sorted by id
+   * @param position position from which the distances are calculated
+   * @param distance the distance (<=)
+   * @param out (output) found ids are appended
+   */
+  void getIdsInRange( const Eigen::Vector3d& position, double distance, IdSet& out ) const;
+  
+  /*! returns the ids of all views whose position lies within a viewing frustum, sorted by id
+   * @param frustum the frustum
+   * @param out (output) found ids are appended
+   */
+  void getIdsInFrustum( const Frustum& frustum, IdSet& out ) const;
+  
+  /*! Sets the edge length of the grid cells used to index the view positions and rebuilds the index. It should be in the order
+   * of the typical query radius. Default: 0.25.
+   */
+  void setIndexCellSize( double cell_size_m );
+  
   /*!
-   * saves the poses in the view space to file
+   * saves the poses in the view space to file (text format, see loadFromFile), with enough digits to restore them exactly
    */
   void saveToFile( std::string filename );
   
-  /*! Loads the viewspace from file
+  /*! Saves the view space to a binary file that can be memory mapped when loading. Stores poses, reachable/bad/non viewspace
+   * flags, visit counts, source frames and additional fields (view ids are per process and not stored).
    * 
-   * Format (first number of views in the file, then each view represented by its position and a quaternion for its orientation):
+   * Format (version 1, host byte order): a header with magic bytes "IGVSPACE", version, byte order mark, number of views and the
+   * offsets of the following sections, each starting 8 byte aligned:
+   * - poses: 7 doubles per view (position x,y,z, orientation x,y,z,w)
+   * - visit counts: one uint32 per view
+   * - flags: one byte per view
+   * - record index: nr_of_views+1 uint64 offsets into the record section
+   * - records: per view the source frame, the number of additional field names and values, the names and the values
+   * 
+   * @param filename Path to the file.
+   * @return False if the file could not be written.
+   */
+  bool saveToBinaryFile( std::string filename );
+  
+  /*! Loads the viewspace from file. Binary files (see saveToBinaryFile) are detected by their magic bytes and loaded with loadFromBinaryFile.
+   * 
+   * Text format (first number of views in the file, then each view represented by its position and a quaternion for its orientation):
    * Nr_of_views
    * pos_1.x pos_1.y pos_1.z orientation_1.x orientation_1.y orientation_1.zorientation_1.w
    * pos_2.x pos_2.y pos_2.z orientation_2.x orientation_2.y orientation_2.z orientation_2.w
@@ -132,6 +208,17 @@ public:
    */
   void loadFromFile( std::string filename );
   
+  /*! Loads views from a binary file written by saveToBinaryFile, which is memory mapped and read in place. The views are added to
+   * the existing ones.
+   * @param filename Path to the file.
+   * @return False if the file could not be opened or is not a valid viewspace file (views read until the error are kept).
+   */
+  bool loadFromBinaryFile( std::string filename );
+  
+  /*! Reserves memory for a total of nr_of_views views.
+   */
+  void reserve( size_t nr_of_views );
+  
   /*! Providing means to iterate over view space
    */
   Iterator begin();
@@ -146,14 +233,63 @@ public:
    */
   bool empty() const;
   
-protected:
-  /*! Recalculates the internal index map.
+  /*! Returns a random number that identifies this view space instance and its copies. Versions of different epochs are unrelated.
+   */
+  uint64_t epoch() const;
+  
+  /*! Returns the current version, increased by one with every modification.
+   */
+  uint64_t version() const;
+  
+  /*! Collects all changes after a given version. Only the most recent deletions are logged, hence changes are only available back to a
+   * certain version.
+   * @param version Version after which changes are sought.
+   * @param changes (output) Changes since the given version, all sets sorted by id.
+   * @return False if the changes since the given version are not available anymore (or the version lies in the future). In that case
+   * the whole view space has to be synchronized.
+   */
+  bool getChangesSince( uint64_t version, ChangeSet& changes ) const;
+  
+private:
+  typedef std::vector<uint64_t> Bitset;
+  
+  /*! Returns the slot of a view.
+   * @throws std::out_of_range if the index is invalid
+   */
+  size_t slot( View::IdType index ) const;
+  
+  /*! Sets or clears the bit of a slot.
+   */
+  static void setFlag( Bitset& bits, size_t slot, bool value );
+  
+  /*! Copies the flags and visit count of the view in the given slot to the mirrored arrays.
+   */
+  void mirrorState( size_t slot );
+  
+  /*! Increases the version and marks flags or visit count of the view in the given slot as changed.
    */
-  void recalculateIndexMap();
+  void markStateChanged( size_t slot );
   
 private:
-  std::vector<View, Eigen::aligned_allocator<View> > view_space_; //! Actual storage, used for iterations.
-  std::map<View::IdType, View > views_index_map_; //! For access by index.
+  std::vector<View, Eigen::aligned_allocator<View> > view_space_; //! Actual storage, one view per slot, used for iterations.
+  std::unordered_map<View::IdType, size_t> slot_map_; //! For access by index: id -> slot.
+  
+  // mirrored per slot:
+  IdSet ids_; //! Id of the view in each slot.
+  std::vector<movements::Pose, Eigen::aligned_allocator<movements::Pose> > poses_; //! Pose of the view in each slot.
+  std::vector<unsigned int> times_visited_; //! Visit count of the view in each slot.
+  Bitset reachable_; //! Bit set if the view in the slot is reachable.
+  Bitset bad_; //! Bit set if the view in the slot is bad.
+  Bitset visited_; //! Bit set if the view in the slot has been visited at least once.
+  std::vector<uint64_t> content_version_; //! Version at which the view in the slot was added or replaced.
+  std::vector<uint64_t> state_version_; //! Version at which flags or visit count of the view in the slot last changed.
+  
+  ViewPositionIndex position_index_; //! Spatial index over the view positions.
+  
+  uint64_t epoch_;
+  uint64_t version_;
+  std::deque< std::pair<uint64_t,View::IdType> > deletions_; //! Log of the most recent deletions: version and id.
+  uint64_t oldest_delta_version_; //! Oldest version from which on all changes are known.
 };
 
 /*! Bidirectional iterator
@@ -161,7 +297,7 @@ private:
 class ViewSpace::Iterator: public std::iterator<std::bidirectional_iterator_tag, View>
 {
 public:
-  typedef std::map<View::IdType, View >::iterator InternalIteratorType;
+  typedef std::vector<View, Eigen::aligned_allocator<View> >::iterator InternalIteratorType;
   
 public:
   Iterator();
@@ -188,7 +324,7 @@ private:
 class ViewSpace::ConstIterator
 {
 public:
-  typedef std::map<View::IdType, View >::const_iterator InternalIteratorType;
+  typedef std::vector<View, Eigen::aligned_allocator<View> >::const_iterator InternalIteratorType;
   
 public:
   ConstIterator();
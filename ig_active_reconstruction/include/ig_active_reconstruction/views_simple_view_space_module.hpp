@@ -38,9 +38,9 @@ namespace views
     
     virtual ~SimpleViewSpaceModule(){};
     
-    /*! Loads the viewspace from file
+    /*! Loads the viewspace from file. Binary files written by saveToBinaryFile are detected automatically.
      * 
-     * Format (first number of views in the file, then each view represented by its position and a quaternion for its orientation):
+     * Text format (first number of views in the file, then each view represented by its position and a quaternion for its orientation):
      * Nr_of_views
      * pos_1.x pos_1.y pos_1.z orientation_1.x orientation_1.y orientation_1.z orientation_1.w
      * pos_2.x pos_2.y pos_2.z orientation_2.x orientation_2.y orientation_2.z orientation_2.w
@@ -62,6 +62,14 @@ namespace views
      */
     void saveToFile( std::string filename );
     
+    /*! Saves the current viewspace to a binary file, including flags, visit counts and additional fields (see ViewSpace::saveToBinaryFile).
+     * Loading it is considerably faster than loading a text file.
+     * 
+     * @param path Path to the file.
+     * @return False if the file could not be written.
+     */
+    bool saveToBinaryFile( std::string filename );
+    
     /*! Returns the view space that is available for planning.
       * @param _space pointer to the ViewSpace object that should be filled
       */
@@ -17,7 +17,10 @@
 
 #pragma once
 
+#include <atomic>
+
 #include "ig_active_reconstruction/utility_calculator.hpp"
+#include "ig_active_reconstruction/worker_pool.hpp"
 #include "ig_active_reconstruction/world_representation_communication_interface.hpp"
 #include "ig_active_reconstruction/robot_communication_interface.hpp"
 
@@ -26,7 +29,10 @@ namespace ig_active_reconstruction
   /*! Retrieves ig and cost for given view set, then calculates
    * a linear, but weighted combination, each normalized over the total ig and cost for all views respectively.
    * 
-   * IG retrieval is in this implementation not multithreaded and thus takes some time.
+   * Information gains are retrieved by a persistent pool of threads. The views are split into chunks that the threads claim one after
+   * another through a shared index, such that threads that hit cheap views simply process more chunks. Each chunk is sent to the world
+   * representation as one request, the number of requests in flight at the same time can be limited separately for local and remote
+   * world representations.
    */
   class WeightedLinearUtility: public UtilityCalculator
   {    
@@ -58,6 +64,22 @@ namespace ig_active_reconstruction
      */
     virtual void setRobotCommUnit( boost::shared_ptr<robot::CommunicationInterface> robot_comm_unit );
     
+    /*! Sets the number of threads that retrieve information gains, including the calling one. The worker threads are kept alive between calls of getNbv.
+     * @param nr_of_threads 0: One per hardware core, 1: Serial retrieval without worker pool. (default=8)
+     */
+    virtual void setNumberOfThreads( unsigned int nr_of_threads );
+    
+    /*! Sets the maximal number of information gain requests that are sent to the world representation at the same time. The effective number is also limited by the number of threads.
+     * @param local Limit for world representations residing in the same process. 0: No limit. (default=0)
+     * @param remote Limit for world representations that are called remotely (see CommunicationInterface::isRemote). 0: No limit. (default=8)
+     */
+    virtual void setMaxRequestsInFlight( unsigned int local, unsigned int remote );
+    
+    /*! Sets the number of views that are sent to the world representation within one request.
+     * @param views_per_request 0: Chosen automatically such that each request slot processes about four chunks. (default=0)
+     */
+    virtual void setViewsPerRequest( unsigned int views_per_request );
+    
     /*! Returns the view id of the best view within the given subset of the viewspace.
      * @param id_set Id-subset of views that shall be considered.
      * @param viewspace The complete viewspace object
@@ -65,16 +87,23 @@ namespace ig_active_reconstruction
     virtual views::View::IdType getNbv( views::ViewSpace::IdSet& id_set, boost::shared_ptr<views::ViewSpace> viewspace );  
     
   protected:
-    /*! Helper function for multithreaded ig retrieval.
-     * @param ig_vector (output) Vector in which the ig values will be set, must already have correct size
-     * @param total_ig (output) total information gain calculated within this function
-     * @param command Prebuilt command structure, only lacking the path entry
-     * @param id_set Set of views for which getNbv was called.
-     * @param viewspace Corresponding viewspace
-     * @param base_index Which entry within the batch is processed by this function [0-(batch_size-1)]. All id's are separated into batches of size batch_size. This function will process every base_index-th of it. E.g. batch_size = 3, base_index=2: The function will process the 2th, 5th, 8th, 11th, etc entry...
-     * @param batch_size Size of the batch, matches the number of spawned threads.
+    /*! State shared by all threads retrieving the information gains of one getNbv call.
+     */
+    struct IgRetrievalJob
+    {
+      world_representation::CommunicationInterface::ViewspaceIgRetrievalCommand command; //! Prebuilt command structure, only lacking the views entry.
+      views::ViewSpace::IdSet* id_set; //! Set of views for which getNbv was called.
+      views::ViewSpace* viewspace; //! Corresponding viewspace.
+      std::vector<double>* ig_vector; //! (output) Weighted ig per entry of id_set, must already have the correct size.
+      size_t chunk_size; //! Number of views per request.
+      std::atomic<size_t> next_index; //! First entry of id_set that has not been claimed by any thread yet.
+    };
+    
+  protected:
+    /*! Helper function for multithreaded ig retrieval: Claims chunks of views from the job until all are claimed and sends each of them to the world representation as a single batch.
+     * @param job Shared retrieval state.
      */
-    void getIg(std::vector<double>& ig_vector, double& total_ig, world_representation::CommunicationInterface::IgRetrievalCommand command, views::ViewSpace::IdSet& id_set, boost::shared_ptr<views::ViewSpace> viewspace, unsigned int base_index, unsigned int batch_size );
+    void getIg( IgRetrievalJob& job );
     
   protected:
     boost::shared_ptr<world_representation::CommunicationInterface> world_comm_unit_; //! Interface to world representation.
@@ -86,6 +115,11 @@ namespace ig_active_reconstruction
     std::vector<double> ig_weights_; //! Weight of the information gains.
     double cost_weight_;
     
+    unsigned int nr_of_threads_; //! Number of threads retrieving igs, including the calling one.
+    unsigned int max_local_requests_; //! Maximal number of concurrent requests to a local world representation, 0: no limit.
+    unsigned int max_remote_requests_; //! Maximal number of concurrent requests to a remote world representation, 0: no limit.
+    unsigned int views_per_request_; //! Number of views per request, 0: automatic.
+    boost::shared_ptr<WorkerPool> worker_pool_; //! Threads that retrieve igs, NULL if they are retrieved serially or the pool wasn't needed yet.
   };
   
 }
\ No newline at end of file
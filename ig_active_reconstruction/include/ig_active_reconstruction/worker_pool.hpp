@@ -0,0 +1,115 @@
+/* Copyright (c) 2016, Stefan Isler, islerstefan@bluewin.ch
+ * (ETH Zurich / Robotics and Perception Group, University of Zurich, Switzerland)
+ *
+ * This file is part of ig_active_reconstruction, software for information gain based, active reconstruction.
+ *
+ * ig_active_reconstruction is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * ig_active_reconstruction is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ * Please refer to the GNU Lesser General Public License for details on the license,
+ * on <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <vector>
+#include <deque>
+
+#include <boost/function.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+
+namespace ig_active_reconstruction
+{
+
+  /*! Persistent pool of worker threads with one task queue per worker (work stealing). Workers take tasks from the front of
+   * their own queue and steal from the back of the other queues once it runs dry.
+   *
+   * A call to run() distributes a batch of tasks over all queues and returns once every task of the batch was executed. The calling
+   * thread helps executing queued tasks while it waits, such that run() may also be called from within a task (nested parallelism)
+   * and a pool of size zero simply executes everything in the calling thread.
+   *
+   * The header only depends on boost, such that it can be used from the cpp03 packages as well.
+   */
+  class WorkerPool
+  {
+  public:
+    typedef boost::function<void()> Task;
+
+  public:
+    /*! Constructor, starts the worker threads.
+     * @param nr_of_threads Number of worker threads. If zero, one thread per hardware core is started.
+     */
+    WorkerPool( unsigned int nr_of_threads = 0 );
+
+    /*! Waits for all queued tasks to finish, then stops and joins all worker threads.
+     */
+    virtual ~WorkerPool();
+
+    /*! Returns the number of worker threads.
+     */
+    unsigned int size() const;
+
+    /*! Executes all tasks and blocks until all of them have finished. Tasks must not throw.
+     * @param tasks Tasks to execute. The order in which they are executed is undefined.
+     */
+    void run( std::vector<Task>& tasks );
+
+  private:
+    struct Batch
+    {
+      Batch( size_t nr_of_tasks ):remaining(nr_of_tasks){};
+
+      boost::mutex mutex;
+      boost::condition_variable done;
+      size_t remaining; //! Number of tasks of the batch that have not finished yet.
+    };
+
+    struct Job
+    {
+      Task task;
+      Batch* batch;
+    };
+
+    struct Queue
+    {
+      boost::mutex mutex;
+      std::deque<Job> jobs;
+    };
+
+  private:
+    /*! Main loop of a worker thread.
+     * @param queue_id Id of the queue owned by the worker.
+     */
+    void work( unsigned int queue_id );
+
+    /*! Pops a job, first trying the front of the given queue, then stealing from the back of all others.
+     * @param queue_id Preferred queue.
+     * @param job (output) Retrieved job.
+     * @return True if a job was retrieved.
+     */
+    bool retrieveJob( unsigned int queue_id, Job& job );
+
+    /*! Executes a job and updates its batch.
+     */
+    void execute( Job& job );
+
+  private:
+    std::vector< boost::shared_ptr<Queue> > queues_; //! One queue per worker, plus one for external callers.
+    boost::thread_group workers_;
+
+    boost::mutex state_mutex_;
+    boost::condition_variable work_available_;
+    size_t nr_of_queued_jobs_; //! Number of jobs waiting in any of the queues.
+    unsigned int next_queue_; //! Round robin start index for distributing the next batch.
+    bool shutdown_;
+  };
+
+}
@@ -109,6 +109,25 @@ namespace world_representation
       IgRetrievalConfig config;
     };
     
+    /*! Command structure for the batched information gain retrieval for a whole set of views. All views are evaluated
+     * independently of each other, using the same metrics and configuration. The struct features a constructor that sets all members
+     * to default values. See member descriptions for details.
+     */
+    struct ViewspaceIgRetrievalCommand
+    {
+      
+    public:
+      /*! Constructor loads default values.
+       */
+      ViewspaceIgRetrievalCommand();
+      
+    public:
+      movements::PoseVector views; //! Set of views for which the information gains shall be calculated.
+      std::vector<std::string> metric_names; //! Vector with the names of all metrics that shall be calculated. Only considered if metric_ids is empty.
+      std::vector<unsigned int> metric_ids; //! Vector with the ids of all metrics that shall be calculated. Takes precedence over metric_names.
+      IgRetrievalConfig config;
+    };
+    
     /*! Result of a metric calculation call.
      */
     struct MapMetricRetrievalResult
@@ -143,6 +162,14 @@ namespace world_representation
      */
     virtual ResultInformation computeViewIg(IgRetrievalCommand& command, ViewIgResult& output_ig)=0;
     
+    /*! Calculates a set of information gains for each view of a set of views in one call. The default implementation calls computeViewIg
+     * once per view, implementations that are able to schedule the whole batch internally (or that communicate over a network) should overwrite it.
+     * @param command Specifies the views and which information gains have to be calculated for them, along with further parameters that define how the ig('s) will be collected.
+     * @param output_ig (Output) One ViewIgResult per view, in the order of the views within the passed command. Each ViewIgResult is ordered like the metrics in the command.
+     * @return FAILED if the calculation failed for at least one view, SUCCEEDED otherwise.
+     */
+    virtual ResultInformation computeViewspaceIg(ViewspaceIgRetrievalCommand& command, ViewspaceIgResult& output_ig);
+    
     /*! Calculates a set of evaluation metrics on the complete map.
      * @param command Specifies which metrics shall be calculated.
      */
@@ -157,6 +184,11 @@ namespace world_representation
      * @param available_map_metrics (output) Set of available map metrics.
      */
     virtual void availableMapMetrics( std::vector<MetricInfo>& available_map_metrics )=0;
+    
+    /*! Returns whether calls are forwarded to a remote process, e.g. over a network. Callers may use this to choose how many requests
+     * they issue concurrently. The default implementation returns false.
+     */
+    virtual bool isRemote() const{ return false; };
   };
   
   
@@ -92,6 +92,13 @@ namespace world_representation
      */
     virtual boost::shared_ptr<RaySet> getRaySet( movements::Pose& sensor_pose );
     
+    /*! Writes the set of rays cast from sensor_pose with the current configuration into a batch, reusing its memory.
+     * The directions are rotated with AVX or SSE2 instructions if the build enables them.
+     * @param sensor_pose Position from which rays are cast.
+     * @param batch (output) Rays.
+     */
+    virtual void getRayBatch( const movements::Pose& sensor_pose, RayBatch& batch ) const;
+    
     /*! Returns the set of ray directions as the would be cast from the given sensor_pose with the current configuration.
      * @param sensor_pose Position from which rays are cast.
      * @return Pointer to a set of ray directions.
@@ -108,10 +115,15 @@ namespace world_representation
      */
     void computeRelRayDirections();
     
+    /*! Rotates a set of directions given as separate component arrays, out_i = rotation*in_i.
+     */
+    static void rotateDirections( const Eigen::Matrix3f& rotation, const float* in_x, const float* in_y, const float* in_z, float* out_x, float* out_y, float* out_z, size_t nr_of_directions );
+    
   protected:
     Config config_; //! Configuration.
     
     boost::shared_ptr<RayDirectionSet> ray_directions_; //! Precomputed set of ray directions relative to the camera (sensor) coordinate frame.
+    std::vector<float> rel_x_, rel_y_, rel_z_; //! Components of the precomputed relative ray directions, for batch generation.
   };
   
 }
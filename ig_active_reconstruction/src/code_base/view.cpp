@@ -33,7 +33,8 @@ View::View():
   index_(runningIndex_++),
   is_reachable_(true),
   is_bad_(false),
-  visited_(0)
+  visited_(0),
+  non_viewspace_(false)
 {
   if( runningIndex_==std::numeric_limits<IdType>::max() )
     std::cerr<<"Attention::View::index_ is about to overflow! (Next: "<<runningIndex_<<", and the one after: "<<runningIndex_+1<<".";
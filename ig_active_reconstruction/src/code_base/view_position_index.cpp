@@ -0,0 +1,358 @@
+/* Copyright (c) 2016, Stefan Isler, islerstefan@bluewin.ch
+ * (ETH Zurich / Robotics and Perception Group, University of Zurich, Switzerland)
+ *
+ * This file is part of ig_active_reconstruction, software for information gain based, active reconstruction.
+ *
+ * ig_active_reconstruction is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * ig_active_reconstruction is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ * Please refer to the GNU Lesser General Public License for details on the license,
+ * on <http://www.gnu.org/licenses/>.
+*/
+
+#include "ig_active_reconstruction/view_position_index.hpp"
+
+#include <cmath>
+#include <queue>
+#include <algorithm>
+
+namespace ig_active_reconstruction
+{
+  
+namespace views
+{
+  
+  namespace
+  {
+    typedef std::pair<double,View::IdType> Candidate; //! Squared distance and id.
+    
+    /*! Keeps the k best candidates in a max heap.
+     */
+    struct KNearestCollector
+    {
+      KNearestCollector( const Eigen::Vector3d& probe, unsigned int k ): probe(probe), k(k){};
+      
+      void operator()( View::IdType id, const Eigen::Vector3d& position )
+      {
+	Candidate candidate( (position-probe).squaredNorm(), id );
+	if( best.size()<k )
+	{
+	  best.push(candidate);
+	}
+	else if( candidate<best.top() )
+	{
+	  best.pop();
+	  best.push(candidate);
+	}
+      }
+      
+      const Eigen::Vector3d& probe;
+      unsigned int k;
+      std::priority_queue<Candidate> best;
+    };
+    
+    struct RangeCollector
+    {
+      RangeCollector( const Eigen::Vector3d& probe, double distance, ViewPositionIndex::IdSet& out ): probe(probe), squared_distance(distance*distance), out(out){};
+      
+      void operator()( View::IdType id, const Eigen::Vector3d& position )
+      {
+	if( (position-probe).squaredNorm()<=squared_distance )
+	  out.push_back(id);
+      }
+      
+      const Eigen::Vector3d& probe;
+      double squared_distance;
+      ViewPositionIndex::IdSet& out;
+    };
+    
+    /*! Same test as Frustum::contains, with the rotation and the field of view slopes computed only once.
+     */
+    struct FrustumCollector
+    {
+      FrustumCollector( const Frustum& frustum, ViewPositionIndex::IdSet& out )
+      : frustum(frustum)
+      , world_to_camera( frustum.pose.orientation.inverse().toRotationMatrix() )
+      , tan_h( std::tan(0.5*frustum.horizontal_fov_rad) )
+      , tan_v( std::tan(0.5*frustum.vertical_fov_rad) )
+      , out(out)
+      {};
+      
+      void operator()( View::IdType id, const Eigen::Vector3d& position )
+      {
+	Eigen::Vector3d rel = world_to_camera*(position-frustum.pose.position);
+	if( rel.z()>=frustum.near_m && rel.z()<=frustum.far_m && std::fabs(rel.x())<=rel.z()*tan_h && std::fabs(rel.y())<=rel.z()*tan_v )
+	  out.push_back(id);
+      }
+      
+      const Frustum& frustum;
+      Eigen::Matrix3d world_to_camera;
+      double tan_h;
+      double tan_v;
+      ViewPositionIndex::IdSet& out;
+    };
+  }
+  
+  Frustum::Frustum()
+  : horizontal_fov_rad(1.0)
+  , vertical_fov_rad(0.8)
+  , near_m(0)
+  , far_m(1)
+  {
+    
+  }
+  
+  bool Frustum::contains( const Eigen::Vector3d& point ) const
+  {
+    Eigen::Vector3d rel = pose.orientation.inverse()*(point-pose.position);
+    
+    if( rel.z()<near_m || rel.z()>far_m )
+      return false;
+    
+    return std::fabs(rel.x())<=rel.z()*std::tan(0.5*horizontal_fov_rad) && std::fabs(rel.y())<=rel.z()*std::tan(0.5*vertical_fov_rad);
+  }
+  
+  void Frustum::corners( std::vector<Eigen::Vector3d>& out ) const
+  {
+    double tan_h = std::tan(0.5*horizontal_fov_rad);
+    double tan_v = std::tan(0.5*vertical_fov_rad);
+    
+    double depths[2] = {near_m, far_m};
+    for( double depth: depths )
+    {
+      for( int sx=-1; sx<=1; sx+=2 )
+      {
+	for( int sy=-1; sy<=1; sy+=2 )
+	{
+	  Eigen::Vector3d corner( sx*depth*tan_h, sy*depth*tan_v, depth );
+	  out.push_back( pose.position + pose.orientation*corner );
+	}
+      }
+    }
+  }
+  
+  ViewPositionIndex::ViewPositionIndex( double cell_size_m )
+  : cell_size_m_(cell_size_m)
+  , size_(0)
+  {
+    
+  }
+  
+  void ViewPositionIndex::setCellSize( double cell_size_m )
+  {
+    Grid old_grid;
+    old_grid.swap(grid_);
+    
+    cell_size_m_ = cell_size_m;
+    size_ = 0;
+    
+    for( auto& cell: old_grid )
+    {
+      for( Entry& entry: cell.second )
+      {
+	insert(entry.id,entry.position);
+      }
+    }
+  }
+  
+  double ViewPositionIndex::cellSize() const
+  {
+    return cell_size_m_;
+  }
+  
+  void ViewPositionIndex::insert( IdType id, const Eigen::Vector3d& position )
+  {
+    Entry entry;
+    entry.id = id;
+    entry.position = position;
+    
+    grid_[ key( cellCoordinate(position.x()), cellCoordinate(position.y()), cellCoordinate(position.z()) ) ].push_back(entry);
+    ++size_;
+  }
+  
+  bool ViewPositionIndex::erase( IdType id, const Eigen::Vector3d& position )
+  {
+    Grid::iterator cell_it = grid_.find( key( cellCoordinate(position.x()), cellCoordinate(position.y()), cellCoordinate(position.z()) ) );
+    if( cell_it==grid_.end() )
+      return false;
+    
+    Cell& cell = cell_it->second;
+    for( size_t i=0; i<cell.size(); ++i )
+    {
+      if( cell[i].id==id )
+      {
+	cell[i] = cell.back();
+	cell.pop_back();
+	if( cell.empty() )
+	  grid_.erase(cell_it);
+	--size_;
+	return true;
+      }
+    }
+    return false;
+  }
+  
+  void ViewPositionIndex::clear()
+  {
+    grid_.clear();
+    size_ = 0;
+  }
+  
+  size_t ViewPositionIndex::size() const
+  {
+    return size_;
+  }
+  
+  template<class VISITOR>
+  void ViewPositionIndex::visitBox( const Eigen::Vector3d& min, const Eigen::Vector3d& max, VISITOR& visitor ) const
+  {
+    long min_x = cellCoordinate(min.x()), max_x = cellCoordinate(max.x());
+    long min_y = cellCoordinate(min.y()), max_y = cellCoordinate(max.y());
+    long min_z = cellCoordinate(min.z()), max_z = cellCoordinate(max.z());
+    
+    double nr_of_cells = double(max_x-min_x+1)*double(max_y-min_y+1)*double(max_z-min_z+1);
+    if( nr_of_cells>grid_.size() )
+    {
+      for( auto& cell: grid_ )
+      {
+	for( const Entry& entry: cell.second )
+	{
+	  visitor(entry.id,entry.position);
+	}
+      }
+      return;
+    }
+    
+    for( long x=min_x; x<=max_x; ++x )
+    {
+      for( long y=min_y; y<=max_y; ++y )
+      {
+	for( long z=min_z; z<=max_z; ++z )
+	{
+	  Grid::const_iterator cell_it = grid_.find( key(x,y,z) );
+	  if( cell_it==grid_.end() )
+	    continue;
+	  
+	  for( const Entry& entry: cell_it->second )
+	  {
+	    visitor(entry.id,entry.position);
+	  }
+	}
+      }
+    }
+  }
+  
+  void ViewPositionIndex::kNearest( const Eigen::Vector3d& position, unsigned int k, IdSet& out ) const
+  {
+    if( k==0 || size_==0 )
+      return;
+    
+    KNearestCollector collector(position,k);
+    
+    long cx = cellCoordinate(position.x());
+    long cy = cellCoordinate(position.y());
+    long cz = cellCoordinate(position.z());
+    size_t nr_of_visited = 0;
+    
+    // search shells of cells with increasing chebyshev distance r to the cell of the probe. All entries outside
+    // the first r shells are at least r*cell_size away.
+    for( long r=0; ; ++r )
+    {
+      double edge = 2*r+1;
+      if( edge*edge*edge>grid_.size() ) // sparse: visiting all occupied cells is cheaper
+      {
+	collector.best = std::priority_queue<Candidate>();
+	for( auto& cell: grid_ )
+	{
+	  for( const Entry& entry: cell.second )
+	  {
+	    collector(entry.id,entry.position);
+	  }
+	}
+	break;
+      }
+      
+      for( long dx=-r; dx<=r; ++dx )
+      {
+	for( long dy=-r; dy<=r; ++dy )
+	{
+	  // inside the shell only the two cells with |dz|==r are new
+	  long dz_step = ( dx==-r || dx==r || dy==-r || dy==r || r==0 )? 1 : 2*r;
+	  for( long dz=-r; dz<=r; dz+=dz_step )
+	  {
+	    Grid::const_iterator cell_it = grid_.find( key(cx+dx,cy+dy,cz+dz) );
+	    if( cell_it==grid_.end() )
+	      continue;
+	    
+	    for( const Entry& entry: cell_it->second )
+	    {
+	      collector(entry.id,entry.position);
+	    }
+	    nr_of_visited += cell_it->second.size();
+	  }
+	}
+      }
+      
+      if( nr_of_visited==size_ )
+	break;
+      
+      double min_unvisited_distance = r*cell_size_m_;
+      if( collector.best.size()==k && collector.best.top().first<min_unvisited_distance*min_unvisited_distance )
+	break;
+    }
+    
+    size_t first = out.size();
+    out.resize( first+collector.best.size() );
+    for( size_t i=out.size(); i>first; --i )
+    {
+      out[i-1] = collector.best.top().second;
+      collector.best.pop();
+    }
+  }
+  
+  void ViewPositionIndex::inRange( const Eigen::Vector3d& position, double distance, IdSet& out ) const
+  {
+    if( distance<0 )
+      return;
+    
+    RangeCollector collector(position,distance,out);
+    Eigen::Vector3d extent(distance,distance,distance);
+    visitBox( position-extent, position+extent, collector );
+  }
+  
+  void ViewPositionIndex::inFrustum( const Frustum& frustum, IdSet& out ) const
+  {
+    std::vector<Eigen::Vector3d> corners;
+    frustum.corners(corners);
+    
+    Eigen::Vector3d min = corners[0];
+    Eigen::Vector3d max = corners[0];
+    for( Eigen::Vector3d& corner: corners )
+    {
+      min = min.cwiseMin(corner);
+      max = max.cwiseMax(corner);
+    }
+    
+    FrustumCollector collector(frustum,out);
+    visitBox( min, max, collector );
+  }
+  
+  long ViewPositionIndex::cellCoordinate( double value ) const
+  {
+    return static_cast<long>( std::floor(value/cell_size_m_) );
+  }
+  
+  ViewPositionIndex::CellKey ViewPositionIndex::key( long x, long y, long z )
+  {
+    const CellKey mask = (CellKey(1)<<21)-1;
+    return ( (CellKey(x)&mask)<<42 ) | ( (CellKey(y)&mask)<<21 ) | ( CellKey(z)&mask );
+  }
+  
+}
+
+}
\ No newline at end of file
@@ -18,6 +18,17 @@
 #include "ig_active_reconstruction/view_space.hpp"
 #include <fstream>
 #include <stdexcept>
+#include <algorithm>
+#include <iomanip>
+#include <limits>
+#include <cstring>
+#include <utility>
+#include <random>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 namespace ig_active_reconstruction
 {
@@ -25,9 +36,147 @@ namespace ig_active_reconstruction
 namespace views
 {
 
-ViewSpace::ViewSpace()
+namespace
 {
+  const char BINARY_MAGIC[8] = {'I','G','V','S','P','A','C','E'};
+  const uint32_t BINARY_VERSION = 1;
+  const uint32_t BYTE_ORDER_MARK = 0x01020304;
+  
+  const uint8_t FLAG_REACHABLE = 1;
+  const uint8_t FLAG_BAD = 2;
+  const uint8_t FLAG_NON_VIEWSPACE = 4;
+  
+  const size_t MAX_LOGGED_DELETIONS = 100000; //! Deltas can be computed as long as at most this many views were deleted since.
+  
+  /*! Header of the binary viewspace format. All sections start at 8 byte aligned offsets, such that the
+   * pose section can be read in place from a memory mapping.
+   */
+  struct BinaryHeader
+  {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order_mark; //! Files are written in host byte order, loading fails on a mismatch.
+    uint64_t nr_of_views;
+    uint64_t poses_offset; //! nr_of_views x 7 doubles: position x,y,z and orientation x,y,z,w.
+    uint64_t times_visited_offset; //! nr_of_views x uint32_t.
+    uint64_t flags_offset; //! nr_of_views x uint8_t, see FLAG_*.
+    uint64_t records_index_offset; //! (nr_of_views+1) x uint64_t, start of each view's record in the records section (relative to it), the last entry is its size.
+    uint64_t records_offset; //! Per view: source frame, number of additional fields, their names and values.
+    uint64_t file_size;
+  };
+  
+  uint64_t aligned( uint64_t offset )
+  {
+    return (offset+7) & ~uint64_t(7);
+  }
+  
+  template<typename T>
+  void append( std::string& buffer, const T& value )
+  {
+    buffer.append( reinterpret_cast<const char*>(&value), sizeof(T) );
+  }
+  
+  void appendString( std::string& buffer, const std::string& value )
+  {
+    append( buffer, static_cast<uint32_t>(value.size()) );
+    buffer.append(value);
+  }
+  
+  /*! Bounds checked sequential reads from a memory block.
+   */
+  class Reader
+  {
+  public:
+    Reader( const char* begin, const char* end ): pos_(begin), end_(end){};
+    
+    template<typename T>
+    bool read( T& value )
+    {
+      if( size_t(end_-pos_)<sizeof(T) )
+	return false;
+      std::memcpy( &value, pos_, sizeof(T) );
+      pos_ += sizeof(T);
+      return true;
+    }
+    
+    bool readString( std::string& value )
+    {
+      uint32_t length;
+      if( !read(length) || size_t(end_-pos_)<length )
+	return false;
+      value.assign( pos_, length );
+      pos_ += length;
+      return true;
+    }
+    
+  private:
+    const char* pos_;
+    const char* end_;
+  };
+  
+  /*! Read only memory mapping of a whole file, unmapped on destruction.
+   */
+  class MappedFile
+  {
+  public:
+    MappedFile( const std::string& filename )
+    : data_(NULL)
+    , size_(0)
+    {
+      int fd = ::open( filename.c_str(), O_RDONLY );
+      if( fd<0 )
+	return;
+      
+      struct stat file_stat;
+      if( ::fstat(fd,&file_stat)==0 && file_stat.st_size>0 )
+      {
+	void* data = ::mmap( NULL, file_stat.st_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+	if( data!=MAP_FAILED )
+	{
+	  data_ = static_cast<const char*>(data);
+	  size_ = file_stat.st_size;
+	}
+      }
+      ::close(fd);
+    }
+    
+    ~MappedFile()
+    {
+      if( data_!=NULL )
+	::munmap( const_cast<char*>(data_), size_ );
+    }
+    
+    const char* data() const{ return data_; }
+    size_t size() const{ return size_; }
+    
+  private:
+    MappedFile( const MappedFile& );
+    MappedFile& operator=( const MappedFile& );
+    
+  private:
+    const char* data_;
+    size_t size_;
+  };
   
+  /*! Whether a file starts with the magic bytes of the binary format.
+   */
+  bool isBinaryFile( const std::string& filename )
+  {
+    std::ifstream in( filename, std::ifstream::binary );
+    char magic[8];
+    return in.read(magic,8) && std::memcmp(magic,BINARY_MAGIC,8)==0;
+  }
+}
+
+ViewSpace::ViewSpace()
+: version_(0)
+, oldest_delta_version_(0)
+{
+  std::random_device random;
+  do
+  {
+    epoch_ = ( uint64_t(random())<<32 ) | random();
+  }while( epoch_==0 ); // zero is used by clients to denote "no epoch"
 }
 
 std::vector<View, Eigen::aligned_allocator<View> > ViewSpace::getViewSpace()
@@ -37,12 +186,15 @@ std::vector<View, Eigen::aligned_allocator<View> > ViewSpace::getViewSpace()
 
 void ViewSpace::getGoodViewSpace( IdSet& out, bool ignore_visited )
 {
-  for( auto& pair: views_index_map_ )
+  for( size_t word=0; word<reachable_.size(); ++word )
   {
-    View& view = pair.second;
-    if( view.reachable() && (view.timesVisited()==0||!ignore_visited) && !view.bad() )
+    uint64_t good = reachable_[word] & ~bad_[word];
+    if( ignore_visited )
+      good &= ~visited_[word];
+    
+    for( ; good!=0; good &= good-1 ) // clears the lowest set bit
     {
-      out.push_back(view.index());
+      out.push_back( ids_[ word*64 + __builtin_ctzll(good) ] );
     }
   }
 }
@@ -51,7 +203,7 @@ View ViewSpace::getView( View::IdType index )
 {
   try
   {
-    return views_index_map_.at(index);
+    return view_space_[ slot(index) ];
   }
   catch(...)
   {
@@ -59,21 +211,65 @@ View ViewSpace::getView( View::IdType index )
   }
 }
 
+const View& ViewSpace::getViewRef( View::IdType index ) const
+{
+  try
+  {
+    return view_space_[ slot(index) ];
+  }
+  catch(...)
+  {
+    throw std::out_of_range("ViewSpace::getViewRef: the given index is out of range");
+  }
+}
+
 bool ViewSpace::deleteView( View::IdType index )
 {
-  decltype(views_index_map_)::iterator it = views_index_map_.begin();
-  decltype(views_index_map_)::iterator end = views_index_map_.end();
+  decltype(slot_map_)::iterator it = slot_map_.find(index);
+  
+  if( it==slot_map_.end() )
+    return false;
+  
+  size_t freed = it->second;
+  size_t last = view_space_.size()-1;
   
-  for( ; it!=end; ++it )
+  position_index_.erase( index, poses_[freed].position );
+  slot_map_.erase(it);
+  
+  if( freed!=last ) // move the last view into the freed slot
   {
-    if( it->second.index()==index )
-    {
-      views_index_map_.erase(it);
-      recalculateIndexMap();
-      return true;
-    }
+    view_space_[freed] = std::move(view_space_[last]);
+    ids_[freed] = ids_[last];
+    poses_[freed] = poses_[last];
+    content_version_[freed] = content_version_[last];
+    state_version_[freed] = state_version_[last];
+    mirrorState(freed);
+    slot_map_[ ids_[freed] ] = freed;
+  }
+  
+  view_space_.pop_back();
+  ids_.pop_back();
+  poses_.pop_back();
+  times_visited_.pop_back();
+  content_version_.pop_back();
+  state_version_.pop_back();
+  setFlag(reachable_,last,false);
+  setFlag(bad_,last,false);
+  setFlag(visited_,last,false);
+  if( last%64==0 )
+  {
+    reachable_.pop_back();
+    bad_.pop_back();
+    visited_.pop_back();
   }
-  return false;
+  
+  deletions_.push_back( std::make_pair(++version_,index) );
+  if( deletions_.size()>MAX_LOGGED_DELETIONS )
+  {
+    oldest_delta_version_ = deletions_.front().first;
+    deletions_.pop_front();
+  }
+  return true;
 }
 
 bool ViewSpace::deleteViews( std::vector<View::IdType>& index_set )
@@ -91,7 +287,7 @@ unsigned int ViewSpace::timesVisited( View::IdType index )
 {
   try
   {
-    return static_cast<View&>(views_index_map_.at(index)).timesVisited();
+    return times_visited_[ slot(index) ];
   }
   catch(...)
   {
@@ -103,7 +299,10 @@ void ViewSpace::setBad( View::IdType index )
 {
   try
   {
-    static_cast<View&>(views_index_map_.at(index)).bad()=true;
+    size_t s = slot(index);
+    view_space_[s].bad() = true;
+    setFlag(bad_,s,true);
+    markStateChanged(s);
     return;
   }
   catch(...)
@@ -116,7 +315,10 @@ void ViewSpace::setGood( View::IdType index )
 {
   try
   {
-    static_cast<View&>(views_index_map_.at(index)).bad()=false;
+    size_t s = slot(index);
+    view_space_[s].bad() = false;
+    setFlag(bad_,s,false);
+    markStateChanged(s);
     return;
   }
   catch(...)
@@ -129,7 +331,26 @@ void ViewSpace::setVisited( View::IdType index )
 {
   try
   {
-    static_cast<View&>(views_index_map_.at(index)).timesVisited() += 1;
+    size_t s = slot(index);
+    view_space_[s].timesVisited() += 1;
+    mirrorState(s);
+    markStateChanged(s);
+    return;
+  }
+  catch(...)
+  {
+    return;
+  }
+}
+
+void ViewSpace::setTimesVisited( View::IdType index, unsigned int times_visited )
+{
+  try
+  {
+    size_t s = slot(index);
+    view_space_[s].timesVisited() = times_visited;
+    mirrorState(s);
+    markStateChanged(s);
     return;
   }
   catch(...)
@@ -142,7 +363,10 @@ void ViewSpace::setUnReachable( View::IdType index )
 {
   try
   {
-    static_cast<View&>(views_index_map_.at(index)).reachable() = false;
+    size_t s = slot(index);
+    view_space_[s].reachable() = false;
+    setFlag(reachable_,s,false);
+    markStateChanged(s);
     return;
   }
   catch(...)
@@ -155,7 +379,10 @@ void ViewSpace::setReachable( View::IdType index )
 {
   try
   {
-    static_cast<View&>(views_index_map_.at(index)).reachable() = true;
+    size_t s = slot(index);
+    view_space_[s].reachable() = true;
+    setFlag(reachable_,s,true);
+    markStateChanged(s);
     return;
   }
   catch(...)
@@ -167,65 +394,104 @@ void ViewSpace::setReachable( View::IdType index )
 
 void ViewSpace::push_back( View new_vp )
 {
-  //view_space_.push_back(new_vp);
-  //View& view_ref = view_space_.back();
-  views_index_map_[new_vp.index()] = new_vp;//std::reference_wrapper<View>(view_ref);
+  View::IdType id = new_vp.index();
+  decltype(slot_map_)::iterator it = slot_map_.find(id);
+  
+  size_t s;
+  if( it!=slot_map_.end() ) // replaces an existing view
+  {
+    s = it->second;
+    position_index_.erase( id, poses_[s].position );
+    poses_[s] = new_vp.pose();
+    view_space_[s] = std::move(new_vp);
+  }
+  else
+  {
+    s = view_space_.size();
+    slot_map_[id] = s;
+    ids_.push_back(id);
+    poses_.push_back(new_vp.pose());
+    times_visited_.push_back(0);
+    content_version_.push_back(0);
+    state_version_.push_back(0);
+    if( s%64==0 )
+    {
+      reachable_.push_back(0);
+      bad_.push_back(0);
+      visited_.push_back(0);
+    }
+    view_space_.push_back( std::move(new_vp) );
+  }
+  mirrorState(s);
+  content_version_[s] = state_version_[s] = ++version_;
+  position_index_.insert( id, poses_[s].position );
 }
 
 View ViewSpace::getAClosestNeighbour( View& _view )
 {
-  if( views_index_map_.empty() )
+  return view_space_[ slot( getAClosestNeighbourId(_view.pose().position) ) ];
+}
+
+View::IdType ViewSpace::getAClosestNeighbourId( const Eigen::Vector3d& position ) const
+{
+  if( view_space_.empty() )
     throw std::runtime_error("ViewSpace::getAClosestNeighbour::Cannot find a closest neighbour since the view space is empty.");
-    
-  Eigen::Vector3d probe = _view.pose().position;
-  View closest = (views_index_map_.begin())->second;//view_space_[0];
-  Eigen::Vector3d dist_vec = probe - closest.pose().position;
-  double distance = dist_vec.norm();
   
-  for( auto& pair: views_index_map_ )
-  {
-    View& view = pair.second;
-    dist_vec = probe - view.pose().position;
-    double norm = dist_vec.norm();
-    if( norm<distance )
-    {
-      distance=norm;
-      closest = view;
-    }
-  }
-  return closest;
+  IdSet closest;
+  position_index_.kNearest(position,1,closest);
+  return closest.front();
+}
+
+void ViewSpace::getKNearest( const Eigen::Vector3d& position, unsigned int k, IdSet& out ) const
+{
+  position_index_.kNearest(position,k,out);
 }
 
 unsigned int ViewSpace::size()
 {
-  return views_index_map_.size();
+  return view_space_.size();
 }
 
 void ViewSpace::getViewsInRange( View& _reference_view, double _distance, std::vector<View, Eigen::aligned_allocator<View> >& _sub_space )
 {
-  for( auto& pair: views_index_map_ )
+  IdSet in_range;
+  getIdsInRange( _reference_view.pose().position, _distance, in_range );
+  
+  for( View::IdType& id: in_range )
   {
-    View& view = pair.second;
-    Eigen::Vector3d dist_vec = view.pose().position - _reference_view.pose().position;
-    if( dist_vec.norm()<=_distance )
-    {
-      _sub_space.push_back(view);
-    }
+    _sub_space.push_back( view_space_[ slot(id) ] );
   }
 }
 
+void ViewSpace::getIdsInRange( const Eigen::Vector3d& position, double distance, IdSet& out ) const
+{
+  size_t first = out.size();
+  position_index_.inRange(position,distance,out);
+  std::sort( out.begin()+first, out.end() );
+}
+
+void ViewSpace::getIdsInFrustum( const Frustum& frustum, IdSet& out ) const
+{
+  size_t first = out.size();
+  position_index_.inFrustum(frustum,out);
+  std::sort( out.begin()+first, out.end() );
+}
+
+void ViewSpace::setIndexCellSize( double cell_size_m )
+{
+  position_index_.setCellSize(cell_size_m);
+}
+
 void ViewSpace::saveToFile( std::string _filename )
 {
   std::ofstream out( _filename, std::ofstream::trunc );
+  out << std::setprecision( std::numeric_limits<double>::max_digits10 ); // such that poses round-trip exactly
   
-  out<<views_index_map_.size();
+  out<<poses_.size();
   
-  //for( unsigned int i=0; i<view_space_.size(); ++i )
-  for( auto& pair: views_index_map_)
+  for( movements::Pose& pose: poses_ )
   {
-    View& view = pair.second;
     out<<"\n";
-    movements::Pose pose = view.pose();//view_space_[i].pose();
     out << pose.position.x();
     out << " " << pose.position.y();
     out << " " << pose.position.z();
@@ -238,12 +504,85 @@ void ViewSpace::saveToFile( std::string _filename )
   out.close();
 }
 
+bool ViewSpace::saveToBinaryFile( std::string filename )
+{
+  uint64_t nr_of_views = view_space_.size();
+  
+  std::vector<uint64_t> records_index;
+  std::string records;
+  records_index.reserve(nr_of_views+1);
+  for( View& view: view_space_ )
+  {
+    records_index.push_back( records.size() );
+    appendString( records, view.sourceFrame() );
+    
+    const std::vector<std::string>& names = view.additionalFieldsNames();
+    const std::vector<double>& values = view.additionalFieldsValues();
+    append( records, static_cast<uint32_t>(names.size()) );
+    append( records, static_cast<uint32_t>(values.size()) );
+    for( const std::string& name: names )
+    {
+      appendString( records, name );
+    }
+    for( const double& value: values )
+    {
+      append( records, value );
+    }
+  }
+  records_index.push_back( records.size() );
+  
+  BinaryHeader header;
+  std::memset( &header, 0, sizeof(header) );
+  std::memcpy( header.magic, BINARY_MAGIC, 8 );
+  header.version = BINARY_VERSION;
+  header.byte_order_mark = BYTE_ORDER_MARK;
+  header.nr_of_views = nr_of_views;
+  header.poses_offset = aligned( sizeof(BinaryHeader) );
+  header.times_visited_offset = aligned( header.poses_offset + 7*sizeof(double)*nr_of_views );
+  header.flags_offset = aligned( header.times_visited_offset + sizeof(uint32_t)*nr_of_views );
+  header.records_index_offset = aligned( header.flags_offset + nr_of_views );
+  header.records_offset = aligned( header.records_index_offset + sizeof(uint64_t)*(nr_of_views+1) );
+  header.file_size = header.records_offset + records.size();
+  
+  std::string data( header.records_offset, '\0' );
+  std::memcpy( &data[0], &header, sizeof(header) );
+  
+  double* poses = reinterpret_cast<double*>( &data[header.poses_offset] );
+  uint32_t* times_visited = reinterpret_cast<uint32_t*>( &data[header.times_visited_offset] );
+  uint8_t* flags = reinterpret_cast<uint8_t*>( &data[header.flags_offset] );
+  for( size_t i=0; i<nr_of_views; ++i )
+  {
+    const movements::Pose& pose = poses_[i];
+    double* p = poses + 7*i;
+    p[0] = pose.position.x(); p[1] = pose.position.y(); p[2] = pose.position.z();
+    p[3] = pose.orientation.x(); p[4] = pose.orientation.y(); p[5] = pose.orientation.z(); p[6] = pose.orientation.w();
+    
+    const View& view = view_space_[i];
+    times_visited[i] = view.timesVisited();
+    flags[i] = (view.reachable()? FLAG_REACHABLE : 0) | (view.bad()? FLAG_BAD : 0) | (view.nonViewSpace()? FLAG_NON_VIEWSPACE : 0);
+  }
+  std::memcpy( &data[header.records_index_offset], records_index.data(), sizeof(uint64_t)*records_index.size() );
+  
+  std::ofstream out( filename, std::ofstream::trunc | std::ofstream::binary );
+  out.write( data.data(), data.size() );
+  out.write( records.data(), records.size() );
+  out.close();
+  
+  return !out.fail();
+}
+
 void ViewSpace::loadFromFile( std::string _filename )
 {
+  if( isBinaryFile(_filename) )
+  {
+    loadFromBinaryFile(_filename);
+    return;
+  }
+  
   std::ifstream in(_filename, std::ifstream::in);
   
   unsigned int nr_of_views;
-  bool success = (in >> nr_of_views);
+  bool success = static_cast<bool>(in >> nr_of_views);
   
   if(!success)
     return;
@@ -266,44 +605,182 @@ void ViewSpace::loadFromFile( std::string _filename )
     new_pose.reachable() = true;
     new_pose.timesVisited() = 0;
     
-    //view_space_.push_back(new_pose);
-    views_index_map_[new_pose.index()] = new_pose;//view_space_.back();
+    push_back(new_pose);
+  }
+}
+
+bool ViewSpace::loadFromBinaryFile( std::string filename )
+{
+  MappedFile file(filename);
+  
+  BinaryHeader header;
+  if( file.size()<sizeof(BinaryHeader) )
+    return false;
+  std::memcpy( &header, file.data(), sizeof(header) );
+  
+  if( std::memcmp(header.magic,BINARY_MAGIC,8)!=0 || header.version!=BINARY_VERSION || header.byte_order_mark!=BYTE_ORDER_MARK || header.file_size!=file.size() )
+    return false;
+  
+  // every view takes at least 7 doubles, which bounds nr_of_views and prevents overflows in the checks below
+  uint64_t nr_of_views = header.nr_of_views;
+  if( nr_of_views>file.size()/(7*sizeof(double)) )
+    return false;
+  if( header.poses_offset%8!=0 || header.poses_offset+7*sizeof(double)*nr_of_views>file.size()
+    || header.times_visited_offset%4!=0 || header.times_visited_offset+sizeof(uint32_t)*nr_of_views>file.size()
+    || header.flags_offset+nr_of_views>file.size()
+    || header.records_index_offset%8!=0 || header.records_index_offset+sizeof(uint64_t)*(nr_of_views+1)>file.size()
+    || header.records_offset>file.size() )
+    return false;
+  
+  const char* data = file.data();
+  const double* poses = reinterpret_cast<const double*>( data+header.poses_offset );
+  const uint32_t* times_visited = reinterpret_cast<const uint32_t*>( data+header.times_visited_offset );
+  const uint8_t* flags = reinterpret_cast<const uint8_t*>( data+header.flags_offset );
+  const uint64_t* records_index = reinterpret_cast<const uint64_t*>( data+header.records_index_offset );
+  const char* records = data+header.records_offset;
+  uint64_t records_size = file.size()-header.records_offset;
+  
+  reserve( size()+nr_of_views );
+  
+  for( size_t i=0; i<nr_of_views; ++i )
+  {
+    if( records_index[i]>records_index[i+1] || records_index[i+1]>records_size )
+      return false;
+    
+    View view;
+    const double* p = poses + 7*i;
+    view.pose().position = Eigen::Vector3d( p[0], p[1], p[2] );
+    view.pose().orientation = Eigen::Quaterniond( p[6], p[3], p[4], p[5] );
+    view.timesVisited() = times_visited[i];
+    view.reachable() = (flags[i] & FLAG_REACHABLE)!=0;
+    view.bad() = (flags[i] & FLAG_BAD)!=0;
+    view.nonViewSpace() = (flags[i] & FLAG_NON_VIEWSPACE)!=0;
+    
+    Reader record( records+records_index[i], records+records_index[i+1] );
+    uint32_t nr_of_names, nr_of_values;
+    if( !record.readString(view.sourceFrame()) || !record.read(nr_of_names) || !record.read(nr_of_values) )
+      return false;
+    
+    std::vector<std::string>& names = view.additionalFieldsNames();
+    std::vector<double>& values = view.additionalFieldsValues();
+    names.resize(nr_of_names);
+    values.resize(nr_of_values);
+    for( std::string& name: names )
+    {
+      if( !record.readString(name) )
+	return false;
+    }
+    for( double& value: values )
+    {
+      if( !record.read(value) )
+	return false;
+    }
+    
+    push_back( std::move(view) );
   }
+  return true;
+}
+
+void ViewSpace::reserve( size_t nr_of_views )
+{
+  view_space_.reserve(nr_of_views);
+  slot_map_.reserve(nr_of_views);
+  ids_.reserve(nr_of_views);
+  poses_.reserve(nr_of_views);
+  times_visited_.reserve(nr_of_views);
+  content_version_.reserve(nr_of_views);
+  state_version_.reserve(nr_of_views);
+  reachable_.reserve( (nr_of_views+63)/64 );
+  bad_.reserve( (nr_of_views+63)/64 );
+  visited_.reserve( (nr_of_views+63)/64 );
 }
 
 ViewSpace::Iterator ViewSpace::begin()
 {
-  return Iterator(views_index_map_.begin());
+  return Iterator(view_space_.begin());
 }
 
 ViewSpace::ConstIterator ViewSpace::begin() const
 {
-  return ConstIterator(views_index_map_.begin());
+  return ConstIterator(view_space_.begin());
 }
 
 ViewSpace::Iterator ViewSpace::end()
 {
-  return Iterator(views_index_map_.end());
+  return Iterator(view_space_.end());
 }
 
 ViewSpace::ConstIterator ViewSpace::end() const
 {
-  return ConstIterator(views_index_map_.end());
+  return ConstIterator(view_space_.end());
 }
 
 bool ViewSpace::empty() const
 {
-  return views_index_map_.empty();
+  return view_space_.empty();
+}
+
+uint64_t ViewSpace::epoch() const
+{
+  return epoch_;
+}
+
+uint64_t ViewSpace::version() const
+{
+  return version_;
 }
 
-void ViewSpace::recalculateIndexMap()
+bool ViewSpace::getChangesSince( uint64_t version, ChangeSet& changes ) const
 {
-  /*views_index_map_.clear();
+  if( version<oldest_delta_version_ || version>version_ )
+    return false;
   
-  for( View& view: view_space_ )
+  for( size_t s=0; s<ids_.size(); ++s )
+  {
+    if( content_version_[s]>version )
+      changes.updated.push_back(ids_[s]);
+    else if( state_version_[s]>version )
+      changes.state_changed.push_back(ids_[s]);
+  }
+  
+  for( auto it=deletions_.rbegin(); it!=deletions_.rend() && it->first>version; ++it )
   {
-    views_index_map_[view.index()] = view;
-  }*/
+    changes.deleted.push_back(it->second);
+  }
+  
+  std::sort( changes.updated.begin(), changes.updated.end() );
+  std::sort( changes.state_changed.begin(), changes.state_changed.end() );
+  std::sort( changes.deleted.begin(), changes.deleted.end() );
+  changes.deleted.erase( std::unique(changes.deleted.begin(),changes.deleted.end()), changes.deleted.end() ); // deleted, readded and deleted again
+  return true;
+}
+
+size_t ViewSpace::slot( View::IdType index ) const
+{
+  return slot_map_.at(index);
+}
+
+void ViewSpace::setFlag( Bitset& bits, size_t slot, bool value )
+{
+  uint64_t mask = uint64_t(1)<<(slot%64);
+  if( value )
+    bits[slot/64] |= mask;
+  else
+    bits[slot/64] &= ~mask;
+}
+
+void ViewSpace::markStateChanged( size_t slot )
+{
+  state_version_[slot] = ++version_;
+}
+
+void ViewSpace::mirrorState( size_t slot )
+{
+  View& view = view_space_[slot];
+  times_visited_[slot] = view.timesVisited();
+  setFlag( reachable_, slot, view.reachable() );
+  setFlag( bad_, slot, view.bad() );
+  setFlag( visited_, slot, view.timesVisited()!=0 );
 }
 
 // Iterator ***************************************************************************
@@ -331,12 +808,12 @@ void ViewSpace::recalculateIndexMap()
   
   View& ViewSpace::Iterator::operator*() const
   {
-    return it_->second;
+    return *it_;
   }
   
   View* ViewSpace::Iterator::operator->() const
   {
-    return &it_->second;
+    return &(*it_);
   }
   
   
@@ -391,12 +868,12 @@ void ViewSpace::recalculateIndexMap()
   
   const View& ViewSpace::ConstIterator::operator*() const
   {
-    return it_->second;
+    return *it_;
   }
   
   const View* ViewSpace::ConstIterator::operator->() const
   {
-    return &it_->second;
+    return &(*it_);
   }
   
   
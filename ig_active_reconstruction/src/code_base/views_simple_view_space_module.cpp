@@ -42,6 +42,11 @@ namespace views
     viewspace_.saveToFile(filename);
   }
   
+  bool SimpleViewSpaceModule::saveToBinaryFile( std::string filename )
+  {
+    return viewspace_.saveToBinaryFile(filename);
+  }
+  
   const ViewSpace & SimpleViewSpaceModule::getViewSpace()
   {
     return viewspace_;
@@ -80,4 +85,4 @@ namespace views
   
 }
 
-}
+}
\ No newline at end of file
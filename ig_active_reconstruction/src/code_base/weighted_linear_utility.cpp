@@ -17,8 +17,11 @@
 
 #include "ig_active_reconstruction/weighted_linear_utility.hpp"
 
-#include <thread>
 #include <iostream>
+#include <algorithm>
+
+#include <boost/bind.hpp>
+#include <boost/make_shared.hpp>
 
 namespace ig_active_reconstruction
 {
@@ -27,6 +30,10 @@ namespace ig_active_reconstruction
   : world_comm_unit_(nullptr)
   , robot_comm_unit_(nullptr)
   , cost_weight_(cost_weight)
+  , nr_of_threads_(8)
+  , max_local_requests_(0)
+  , max_remote_requests_(8)
+  , views_per_request_(0)
   {
     
   }
@@ -57,6 +64,25 @@ namespace ig_active_reconstruction
     robot_comm_unit_ = robot_comm_unit;
   }
   
+  void WeightedLinearUtility::setNumberOfThreads( unsigned int nr_of_threads )
+  {
+    if( nr_of_threads!=nr_of_threads_ )
+      worker_pool_.reset(); // recreated with the new size when needed
+    
+    nr_of_threads_ = nr_of_threads;
+  }
+  
+  void WeightedLinearUtility::setMaxRequestsInFlight( unsigned int local, unsigned int remote )
+  {
+    max_local_requests_ = local;
+    max_remote_requests_ = remote;
+  }
+  
+  void WeightedLinearUtility::setViewsPerRequest( unsigned int views_per_request )
+  {
+    views_per_request_ = views_per_request;
+  }
+  
   views::View::IdType WeightedLinearUtility::getNbv( views::ViewSpace::IdSet& id_set, boost::shared_ptr<views::ViewSpace> viewspace )
   {
     // structure to store received values
@@ -66,7 +92,7 @@ namespace ig_active_reconstruction
     double total_cost=0;
     double total_ig=0;
     
-    world_representation::CommunicationInterface::IgRetrievalCommand command;
+    world_representation::CommunicationInterface::ViewspaceIgRetrievalCommand command;
     command.config = ig_retrieval_config_;
     command.metric_names = information_gains_;
     
@@ -117,18 +143,43 @@ namespace ig_active_reconstruction
     }
     
     // multithreaded information gain retrieval
-    unsigned int number_of_threads = 8;
     ig_vector.resize(id_set.size(),0);
-    std::vector<double> total_multitthread_ig(number_of_threads,0);
-    std::vector<std::thread> threads;
-    for( size_t i = 0; i<number_of_threads; ++i )
-    {
-      threads.push_back( std::thread(&WeightedLinearUtility::getIg,this,std::ref(ig_vector),std::ref(total_multitthread_ig[i]),command, std::ref(id_set), viewspace, i, number_of_threads ) );
-    }
-    for( size_t i = 0; i<number_of_threads; ++i )
+    
+    if( world_comm_unit_!=nullptr && !id_set.empty() )
     {
-      threads[i].join();
-      total_ig += total_multitthread_ig[i];
+      unsigned int nr_of_threads = (nr_of_threads_!=0)?nr_of_threads_:boost::thread::hardware_concurrency();
+      if( nr_of_threads>1 && worker_pool_==nullptr )
+	worker_pool_ = boost::make_shared<WorkerPool>(nr_of_threads-1);
+      
+      // one task per request that may be in flight
+      size_t nr_of_tasks = (worker_pool_!=nullptr)?worker_pool_->size()+1:1;
+      unsigned int max_requests = world_comm_unit_->isRemote()?max_remote_requests_:max_local_requests_;
+      if( max_requests!=0 )
+	nr_of_tasks = std::min<size_t>(nr_of_tasks,max_requests);
+      
+      IgRetrievalJob job;
+      job.command = command;
+      job.id_set = &id_set;
+      job.viewspace = viewspace.get();
+      job.ig_vector = &ig_vector;
+      job.chunk_size = (views_per_request_!=0)?views_per_request_:std::max<size_t>(1,id_set.size()/(4*nr_of_tasks));
+      job.next_index = 0;
+      
+      nr_of_tasks = std::min(nr_of_tasks,(id_set.size()+job.chunk_size-1)/job.chunk_size);
+      
+      if( nr_of_tasks>1 )
+      {
+	std::vector<WorkerPool::Task> tasks( nr_of_tasks, boost::bind(&WeightedLinearUtility::getIg,this,boost::ref(job)) );
+	worker_pool_->run(tasks);
+      }
+      else
+	getIg(job);
+      
+      // summed up in order, such that the result doesn't depend on the thread scheduling
+      for( double& ig_val: ig_vector )
+      {
+	total_ig += ig_val;
+      }
     }
     
     // calculate utility and choose nbv
@@ -159,40 +210,43 @@ namespace ig_active_reconstruction
     return nbv;
   }
   
-  void WeightedLinearUtility::getIg(std::vector<double>& ig_vector,double& total_ig, world_representation::CommunicationInterface::IgRetrievalCommand command, views::ViewSpace::IdSet& id_set, boost::shared_ptr<views::ViewSpace> viewspace, unsigned int base_index, unsigned int batch_size )
+  void WeightedLinearUtility::getIg( IgRetrievalJob& job )
   {
+    world_representation::CommunicationInterface::ViewspaceIgRetrievalCommand command = job.command;
+    size_t nr_of_views = job.id_set->size();
     
-    // information gain
-    if( world_comm_unit_!=nullptr )
+    while( true )
     {
-      for( size_t i = base_index; i<id_set.size(); i+=batch_size )
-      {	
-	views::View view = viewspace->getView( id_set[i] );
-	
-	world_representation::CommunicationInterface::ViewIgResult information_gains;
+      size_t start = job.next_index.fetch_add(job.chunk_size);
+      if( start>=nr_of_views )
+	return;
+      size_t end = std::min(start+job.chunk_size,nr_of_views);
+      
+      command.views.clear();
+      for( size_t i = start; i<end; ++i )
+      {
+	command.views.push_back( job.viewspace->getViewRef( (*job.id_set)[i] ).pose() );
+      }
+      
+      world_representation::CommunicationInterface::ViewspaceIgResult information_gains;
+      world_comm_unit_->computeViewspaceIg(command,information_gains);
+      
+      for( size_t j = 0; j<information_gains.size() && start+j<end; ++j )
+      {
 	double ig_val = 0;
-	
-	command.path.clear();
-	command.path.push_back( view.pose() );
-	
-	world_comm_unit_->computeViewIg(command,information_gains);
-	
-	for( unsigned int i= 0; i<information_gains.size(); ++i )
+	for( unsigned int i= 0; i<information_gains[j].size(); ++i )
 	{
-	  if( information_gains[i].status == world_representation::CommunicationInterface::ResultInformation::SUCCEEDED )
+	  if( information_gains[j][i].status == world_representation::CommunicationInterface::ResultInformation::SUCCEEDED )
 	  {
-	    //std::cout<<"\nReturned gain of metric "<<i<<":"<<information_gains[i].predicted_gain;
-	    ig_val += ig_weights_[i]*information_gains[i].predicted_gain;
+	    //std::cout<<"\nReturned gain of metric "<<i<<":"<<information_gains[j][i].predicted_gain;
+	    ig_val += ig_weights_[i]*information_gains[j][i].predicted_gain;
 	  }
 	}
-	total_ig += ig_val;
-	ig_vector[i] = ig_val;
+	(*job.ig_vector)[start+j] = ig_val;
       }
-      return;
     }
-    else
-      return;
   }
+
     
   
 }
\ No newline at end of file
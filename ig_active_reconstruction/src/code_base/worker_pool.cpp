@@ -0,0 +1,182 @@
+/* Copyright (c) 2016, Stefan Isler, islerstefan@bluewin.ch
+ * (ETH Zurich / Robotics and Perception Group, University of Zurich, Switzerland)
+ *
+ * This file is part of ig_active_reconstruction, software for information gain based, active reconstruction.
+ *
+ * ig_active_reconstruction is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * ig_active_reconstruction is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ * Please refer to the GNU Lesser General Public License for details on the license,
+ * on <http://www.gnu.org/licenses/>.
+*/
+
+#include "ig_active_reconstruction/worker_pool.hpp"
+
+#include <boost/bind.hpp>
+#include <boost/make_shared.hpp>
+
+namespace ig_active_reconstruction
+{
+
+  WorkerPool::WorkerPool( unsigned int nr_of_threads )
+  : nr_of_queued_jobs_(0)
+  , next_queue_(0)
+  , shutdown_(false)
+  {
+    if( nr_of_threads==0 )
+      nr_of_threads = boost::thread::hardware_concurrency();
+
+    // the last queue is used by external callers of run()
+    for( unsigned int i=0; i<=nr_of_threads; ++i )
+    {
+      queues_.push_back( boost::make_shared<Queue>() );
+    }
+
+    for( unsigned int i=0; i<nr_of_threads; ++i )
+    {
+      workers_.create_thread( boost::bind(&WorkerPool::work,this,i) );
+    }
+  }
+
+  WorkerPool::~WorkerPool()
+  {
+    {
+      boost::mutex::scoped_lock lock(state_mutex_);
+      shutdown_ = true;
+    }
+    work_available_.notify_all();
+    workers_.join_all();
+  }
+
+  unsigned int WorkerPool::size() const
+  {
+    return queues_.size()-1;
+  }
+
+  void WorkerPool::run( std::vector<Task>& tasks )
+  {
+    if( tasks.empty() )
+      return;
+
+    Batch batch( tasks.size() );
+
+    unsigned int nr_of_queues = queues_.size();
+    unsigned int queue_id;
+    {
+      boost::mutex::scoped_lock lock(state_mutex_);
+      queue_id = next_queue_;
+      next_queue_ = (next_queue_+1)%nr_of_queues;
+    }
+
+    // distribute round robin, such that every worker starts on a contiguous part of its queue
+    for( size_t i=0; i<tasks.size(); ++i )
+    {
+      Job job;
+      job.task = tasks[i];
+      job.batch = &batch;
+
+      Queue& queue = *queues_[ (queue_id+i)%nr_of_queues ];
+      boost::mutex::scoped_lock lock(queue.mutex);
+      queue.jobs.push_back(job);
+    }
+    {
+      boost::mutex::scoped_lock lock(state_mutex_);
+      nr_of_queued_jobs_ += tasks.size();
+    }
+    work_available_.notify_all();
+
+    // help out until all jobs of the batch are done
+    unsigned int caller_queue = nr_of_queues-1;
+    while( true )
+    {
+      {
+	boost::mutex::scoped_lock lock(batch.mutex);
+	if( batch.remaining==0 )
+	  return;
+      }
+
+      Job job;
+      if( retrieveJob(caller_queue,job) )
+      {
+	execute(job);
+      }
+      else
+      {
+	// everything is being worked on: wait for the batch to finish
+	boost::mutex::scoped_lock lock(batch.mutex);
+	while( batch.remaining!=0 )
+	{
+	  batch.done.wait(lock);
+	}
+	return;
+      }
+    }
+  }
+
+  void WorkerPool::work( unsigned int queue_id )
+  {
+    while( true )
+    {
+      Job job;
+      if( retrieveJob(queue_id,job) )
+      {
+	execute(job);
+	continue;
+      }
+
+      boost::mutex::scoped_lock lock(state_mutex_);
+      while( nr_of_queued_jobs_==0 && !shutdown_ )
+      {
+	work_available_.wait(lock);
+      }
+      if( nr_of_queued_jobs_==0 && shutdown_ )
+	return;
+    }
+  }
+
+  bool WorkerPool::retrieveJob( unsigned int queue_id, Job& job )
+  {
+    unsigned int nr_of_queues = queues_.size();
+
+    for( unsigned int i=0; i<nr_of_queues; ++i )
+    {
+      Queue& queue = *queues_[ (queue_id+i)%nr_of_queues ];
+      boost::mutex::scoped_lock lock(queue.mutex);
+
+      if( queue.jobs.empty() )
+	continue;
+
+      if( i==0 ) // own queue
+      {
+	job = queue.jobs.front();
+	queue.jobs.pop_front();
+      }
+      else // steal
+      {
+	job = queue.jobs.back();
+	queue.jobs.pop_back();
+      }
+      lock.unlock();
+
+      boost::mutex::scoped_lock state_lock(state_mutex_);
+      --nr_of_queued_jobs_;
+      return true;
+    }
+    return false;
+  }
+
+  void WorkerPool::execute( Job& job )
+  {
+    job.task();
+
+    boost::mutex::scoped_lock lock(job.batch->mutex);
+    if( --job.batch->remaining==0 )
+      job.batch->done.notify_all();
+  }
+
+}
@@ -41,6 +41,37 @@ namespace world_representation
   {
   }
   
+  CommunicationInterface::ViewspaceIgRetrievalCommand::ViewspaceIgRetrievalCommand()
+  : config()
+  {
+  }
+  
+  CommunicationInterface::ResultInformation CommunicationInterface::computeViewspaceIg(ViewspaceIgRetrievalCommand& command, ViewspaceIgResult& output_ig)
+  {
+    ResultInformation status = ResultInformation::SUCCEEDED;
+    
+    IgRetrievalCommand view_command;
+    view_command.metric_names = command.metric_names;
+    view_command.metric_ids = command.metric_ids;
+    view_command.config = command.config;
+    
+    output_ig.reserve( output_ig.size()+command.views.size() );
+    
+    for( unsigned int i=0; i<command.views.size(); ++i )
+    {
+      view_command.path.clear();
+      view_command.path.push_back( command.views[i] );
+      
+      ViewIgResult view_ig;
+      ResultInformation view_status = computeViewIg(view_command, view_ig);
+      if( view_status!=ResultInformation::SUCCEEDED )
+	status = ResultInformation::FAILED;
+      
+      output_ig.push_back(view_ig);
+    }
+    return status;
+  }
+  
 }
 
 
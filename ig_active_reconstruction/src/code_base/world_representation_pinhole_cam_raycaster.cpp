@@ -19,6 +19,12 @@
 
 #include <boost/smart_ptr.hpp>
 
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 namespace ig_active_reconstruction
 {
   
@@ -108,6 +114,19 @@ namespace world_representation
     return ray_set;
   }
   
+  void PinholeCamRayCaster::getRayBatch( const movements::Pose& sensor_pose, RayBatch& batch ) const
+  {
+    size_t nr_of_rays = rel_x_.size();
+    batch.origin = sensor_pose.position;
+    batch.resize(nr_of_rays);
+    
+    if( nr_of_rays==0 )
+      return;
+    
+    Eigen::Matrix3f rotation = sensor_pose.orientation.toRotationMatrix().cast<float>();
+    rotateDirections( rotation, &rel_x_[0], &rel_y_[0], &rel_z_[0], &batch.x[0], &batch.y[0], &batch.z[0], nr_of_rays );
+  }
+  
   boost::shared_ptr<PinholeCamRayCaster::RayDirectionSet> PinholeCamRayCaster::getRayDirectionSet( movements::Pose& sensor_pose )
   {
     boost::shared_ptr<PinholeCamRayCaster::RayDirectionSet> ray_dirs = boost::make_shared<PinholeCamRayCaster::RayDirectionSet>();
@@ -147,6 +166,58 @@ namespace world_representation
 	ray_directions_->push_back(ray_dir);
       }
     }
+    
+    rel_x_.resize( ray_directions_->size() );
+    rel_y_.resize( ray_directions_->size() );
+    rel_z_.resize( ray_directions_->size() );
+    for( size_t i=0; i<ray_directions_->size(); ++i )
+    {
+      rel_x_[i] = (*ray_directions_)[i](0);
+      rel_y_[i] = (*ray_directions_)[i](1);
+      rel_z_[i] = (*ray_directions_)[i](2);
+    }
+  }
+  
+  void PinholeCamRayCaster::rotateDirections( const Eigen::Matrix3f& r, const float* in_x, const float* in_y, const float* in_z, float* out_x, float* out_y, float* out_z, size_t nr_of_directions )
+  {
+    size_t i = 0;
+    
+#if defined(__AVX__)
+    __m256 r00 = _mm256_set1_ps(r(0,0)), r01 = _mm256_set1_ps(r(0,1)), r02 = _mm256_set1_ps(r(0,2));
+    __m256 r10 = _mm256_set1_ps(r(1,0)), r11 = _mm256_set1_ps(r(1,1)), r12 = _mm256_set1_ps(r(1,2));
+    __m256 r20 = _mm256_set1_ps(r(2,0)), r21 = _mm256_set1_ps(r(2,1)), r22 = _mm256_set1_ps(r(2,2));
+    for( ; i+8<=nr_of_directions; i+=8 )
+    {
+      __m256 x = _mm256_loadu_ps(in_x+i);
+      __m256 y = _mm256_loadu_ps(in_y+i);
+      __m256 z = _mm256_loadu_ps(in_z+i);
+      _mm256_storeu_ps( out_x+i, _mm256_add_ps( _mm256_add_ps( _mm256_mul_ps(r00,x), _mm256_mul_ps(r01,y) ), _mm256_mul_ps(r02,z) ) );
+      _mm256_storeu_ps( out_y+i, _mm256_add_ps( _mm256_add_ps( _mm256_mul_ps(r10,x), _mm256_mul_ps(r11,y) ), _mm256_mul_ps(r12,z) ) );
+      _mm256_storeu_ps( out_z+i, _mm256_add_ps( _mm256_add_ps( _mm256_mul_ps(r20,x), _mm256_mul_ps(r21,y) ), _mm256_mul_ps(r22,z) ) );
+    }
+#elif defined(__SSE2__)
+    __m128 r00 = _mm_set1_ps(r(0,0)), r01 = _mm_set1_ps(r(0,1)), r02 = _mm_set1_ps(r(0,2));
+    __m128 r10 = _mm_set1_ps(r(1,0)), r11 = _mm_set1_ps(r(1,1)), r12 = _mm_set1_ps(r(1,2));
+    __m128 r20 = _mm_set1_ps(r(2,0)), r21 = _mm_set1_ps(r(2,1)), r22 = _mm_set1_ps(r(2,2));
+    for( ; i+4<=nr_of_directions; i+=4 )
+    {
+      __m128 x = _mm_loadu_ps(in_x+i);
+      __m128 y = _mm_loadu_ps(in_y+i);
+      __m128 z = _mm_loadu_ps(in_z+i);
+      _mm_storeu_ps( out_x+i, _mm_add_ps( _mm_add_ps( _mm_mul_ps(r00,x), _mm_mul_ps(r01,y) ), _mm_mul_ps(r02,z) ) );
+      _mm_storeu_ps( out_y+i, _mm_add_ps( _mm_add_ps( _mm_mul_ps(r10,x), _mm_mul_ps(r11,y) ), _mm_mul_ps(r12,z) ) );
+      _mm_storeu_ps( out_z+i, _mm_add_ps( _mm_add_ps( _mm_mul_ps(r20,x), _mm_mul_ps(r21,y) ), _mm_mul_ps(r22,z) ) );
+    }
+#endif
+    
+    // scalar fallback and remainder
+    for( ; i<nr_of_directions; ++i )
+    {
+      float x = in_x[i], y = in_y[i], z = in_z[i];
+      out_x[i] = r(0,0)*x + r(0,1)*y + r(0,2)*z;
+      out_y[i] = r(1,0)*x + r(1,1)*y + r(1,2)*z;
+      out_z[i] = r(2,0)*x + r(2,1)*y + r(2,2)*z;
+    }
   }
   
 }
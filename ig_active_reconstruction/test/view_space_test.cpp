@@ -0,0 +1,447 @@
+/* Copyright (c) 2016, Stefan Isler, islerstefan@bluewin.ch
+ * (ETH Zurich / Robotics and Perception Group, University of Zurich, Switzerland)
+ *
+ * This file is part of ig_active_reconstruction, software for information gain based, active reconstruction.
+ *
+ * ig_active_reconstruction is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * ig_active_reconstruction is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ * Please refer to the GNU Lesser General Public License for details on the license,
+ * on <http://www.gnu.org/licenses/>.
+*/
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <unistd.h>
+
+#include <gtest/gtest.h>
+
+#include "ig_active_reconstruction/view_space.hpp"
+
+using namespace ig_active_reconstruction::views;
+
+namespace
+{
+  typedef ViewSpace::IdSet IdSet;
+  
+  View viewAt( double x, double y, double z, std::string source_frame = "world" )
+  {
+    View view(source_frame);
+    view.pose().position = Eigen::Vector3d(x,y,z);
+    view.pose().orientation = Eigen::Quaterniond( Eigen::AngleAxisd(x/3,Eigen::Vector3d(1,2,3).normalized()) );
+    return view;
+  }
+  
+  IdSet sorted( IdSet ids )
+  {
+    std::sort( ids.begin(), ids.end() );
+    return ids;
+  }
+  
+  /*! Returns the path of a new, empty temporary file.
+   */
+  std::string temporaryFile()
+  {
+    char name[] = "/tmp/ig_active_reconstruction_view_space_test_XXXXXX";
+    int file = mkstemp(name);
+    close(file);
+    return name;
+  }
+  
+  void expectSamePoses( const ViewSpace& expected, const ViewSpace& actual )
+  {
+    ViewSpace::ConstIterator it = expected.begin(), other = actual.begin();
+    for( ; it!=expected.end() && other!=actual.end(); ++it, ++other )
+    {
+      EXPECT_EQ( it->pose().position, other->pose().position );
+      EXPECT_EQ( it->pose().orientation.coeffs(), other->pose().orientation.coeffs() );
+    }
+    EXPECT_TRUE( it==expected.end() && other==actual.end() );
+  }
+  
+  /*! Random point on a 0.25 m lattice around the origin, such that many distances are exactly equal.
+   */
+  Eigen::Vector3d latticePoint( std::mt19937& generator )
+  {
+    std::uniform_int_distribution<int> step(-12,12);
+    return 0.25*Eigen::Vector3d( step(generator), step(generator), step(generator) );
+  }
+  
+  /*! Adds views at random lattice points, every tenth one at the position of an earlier view and a few far away
+   * in the negative octant. Returns the ids of the added views.
+   */
+  IdSet addRandomViews( ViewSpace& view_space, unsigned int count, std::mt19937& generator )
+  {
+    IdSet ids;
+    std::vector<Eigen::Vector3d> positions;
+    for( unsigned int i=0; i<count; ++i )
+    {
+      Eigen::Vector3d position = latticePoint(generator);
+      if( i%10==9 )
+	position = positions[ generator()%positions.size() ];
+      else if( i%50==7 )
+	position -= Eigen::Vector3d(250,0,100);
+      positions.push_back(position);
+      
+      View view = viewAt( position.x(), position.y(), position.z() );
+      view_space.push_back(view);
+      ids.push_back( view.index() );
+    }
+    return ids;
+  }
+  
+  /*! The k views closest to the position, ties broken by the smaller id.
+   */
+  IdSet bruteForceKNearest( const ViewSpace& view_space, const Eigen::Vector3d& position, unsigned int k )
+  {
+    std::vector< std::pair<double,View::IdType> > candidates;
+    for( ViewSpace::ConstIterator it = view_space.begin(); it!=view_space.end(); ++it )
+      candidates.push_back( std::make_pair( (it->pose().position-position).squaredNorm(), it->index() ) );
+    std::sort( candidates.begin(), candidates.end() );
+    
+    IdSet ids;
+    for( size_t i=0; i<candidates.size() && i<k; ++i )
+      ids.push_back( candidates[i].second );
+    return ids;
+  }
+  
+  IdSet bruteForceInRange( const ViewSpace& view_space, const Eigen::Vector3d& position, double distance )
+  {
+    IdSet ids;
+    for( ViewSpace::ConstIterator it = view_space.begin(); it!=view_space.end(); ++it )
+      if( (it->pose().position-position).squaredNorm()<=distance*distance )
+	ids.push_back( it->index() );
+    return sorted(ids);
+  }
+  
+  IdSet bruteForceInFrustum( const ViewSpace& view_space, const Frustum& frustum )
+  {
+    IdSet ids;
+    for( ViewSpace::ConstIterator it = view_space.begin(); it!=view_space.end(); ++it )
+      if( frustum.contains( it->pose().position ) )
+	ids.push_back( it->index() );
+    return sorted(ids);
+  }
+  
+  /*! Compares the neighbour, range and frustum queries of the view space with a scan over all views, for probes on
+   * the lattice (ties) and off it, and k up to more than the number of views.
+   */
+  void expectQueriesMatchBruteForce( ViewSpace& view_space, std::mt19937& generator )
+  {
+    std::uniform_real_distribution<double> uniform(-1,1);
+    unsigned int size = view_space.size();
+    unsigned int ks[] = {0, 1, 5, 32, size, size+7};
+    double distances[] = {0, 0.25, 0.6, 1.5, 400};
+    
+    for( int i=0; i<20; ++i )
+    {
+      Eigen::Vector3d probe = latticePoint(generator);
+      if( i%2==1 )
+	probe += 0.3*Eigen::Vector3d( uniform(generator), uniform(generator), uniform(generator) );
+      if( i==19 )
+	probe = Eigen::Vector3d(-250,0.1,-100);
+      SCOPED_TRACE( testing::Message() << "probe " << probe.transpose() );
+      
+      for( unsigned int k: ks )
+      {
+	IdSet nearest;
+	view_space.getKNearest( probe, k, nearest );
+	EXPECT_EQ( bruteForceKNearest(view_space,probe,k), nearest ) << "k=" << k;
+      }
+      
+      for( double distance: distances )
+      {
+	IdSet in_range;
+	view_space.getIdsInRange( probe, distance, in_range );
+	EXPECT_EQ( bruteForceInRange(view_space,probe,distance), in_range ) << "distance=" << distance;
+      }
+      
+      Frustum frustum;
+      frustum.pose.position = probe;
+      frustum.pose.orientation = Eigen::AngleAxisd( 3*uniform(generator), Eigen::Vector3d( uniform(generator), uniform(generator), uniform(generator) ).normalized() );
+      frustum.near_m = 0.1*(i%3);
+      frustum.far_m = 1+i%4;
+      IdSet in_frustum;
+      view_space.getIdsInFrustum( frustum, in_frustum );
+      EXPECT_EQ( bruteForceInFrustum(view_space,frustum), in_frustum );
+    }
+  }
+}
+
+TEST(ViewSpaceTest, changesSinceIncludeDeletedAndReAddedViews)
+{
+  ViewSpace view_space;
+  View a = viewAt(0,0,0), b = viewAt(1,0,0), c = viewAt(2,0,0);
+  view_space.push_back(a);
+  view_space.push_back(b);
+  view_space.push_back(c);
+  uint64_t synced_version = view_space.version();
+  
+  view_space.setBad( a.index() );
+  view_space.deleteView( b.index() );
+  View b_again( b.index() );
+  b_again.pose().position = Eigen::Vector3d(1,1,0);
+  view_space.push_back(b_again);
+  
+  ViewSpace::ChangeSet changes;
+  ASSERT_TRUE( view_space.getChangesSince(synced_version,changes) );
+  EXPECT_EQ( IdSet(1,b.index()), changes.updated );
+  EXPECT_EQ( IdSet(1,a.index()), changes.state_changed );
+  EXPECT_EQ( IdSet(1,b.index()), changes.deleted );
+  
+  // deleted again: reported once as deleted, and not as updated anymore
+  view_space.deleteView( b.index() );
+  changes = ViewSpace::ChangeSet();
+  ASSERT_TRUE( view_space.getChangesSince(synced_version,changes) );
+  EXPECT_TRUE( changes.updated.empty() );
+  EXPECT_EQ( IdSet(1,a.index()), changes.state_changed );
+  EXPECT_EQ( IdSet(1,b.index()), changes.deleted );
+  
+  // no changes since the current version, and none known for future ones
+  changes = ViewSpace::ChangeSet();
+  ASSERT_TRUE( view_space.getChangesSince(view_space.version(),changes) );
+  EXPECT_TRUE( changes.updated.empty() && changes.state_changed.empty() && changes.deleted.empty() );
+  EXPECT_FALSE( view_space.getChangesSince(view_space.version()+1,changes) );
+}
+
+TEST(ViewSpaceTest, changesSinceReproduceViewSpaceOnCopy)
+{
+  ViewSpace view_space;
+  IdSet ids;
+  for( int i=0; i<10; ++i )
+  {
+    View view = viewAt(i,0,0);
+    view_space.push_back(view);
+    ids.push_back( view.index() );
+  }
+  ViewSpace replica = view_space;
+  EXPECT_EQ( view_space.epoch(), replica.epoch() );
+  uint64_t synced_version = view_space.version();
+  
+  view_space.deleteView( ids[2] );
+  view_space.deleteView( ids[7] );
+  View replaced( ids[7] );
+  replaced.pose().position = Eigen::Vector3d(7,7,7);
+  view_space.push_back(replaced);
+  view_space.push_back( viewAt(10,0,0) );
+  view_space.setVisited( ids[4] );
+  view_space.setUnReachable( ids[5] );
+  
+  // deletions first, then updates and state changes
+  ViewSpace::ChangeSet changes;
+  ASSERT_TRUE( view_space.getChangesSince(synced_version,changes) );
+  for( size_t i=0; i<changes.deleted.size(); ++i )
+    replica.deleteView( changes.deleted[i] );
+  for( size_t i=0; i<changes.updated.size(); ++i )
+    replica.push_back( view_space.getView(changes.updated[i]) );
+  for( size_t i=0; i<changes.state_changed.size(); ++i )
+  {
+    const View& view = view_space.getViewRef( changes.state_changed[i] );
+    view.reachable()? replica.setReachable(view.index()) : replica.setUnReachable(view.index());
+    replica.setTimesVisited( view.index(), view.timesVisited() );
+  }
+  
+  ASSERT_EQ( view_space.size(), replica.size() );
+  for( ViewSpace::Iterator it=view_space.begin(); it!=view_space.end(); ++it )
+  {
+    const View& copy = replica.getViewRef( it->index() );
+    EXPECT_EQ( it->pose().position, copy.pose().position );
+    EXPECT_EQ( it->reachable(), copy.reachable() );
+    EXPECT_EQ( it->timesVisited(), copy.timesVisited() );
+  }
+}
+
+TEST(ViewSpaceTest, changesAreUnavailableBeyondTheDeletionLog)
+{
+  ViewSpace view_space;
+  uint64_t synced_version = view_space.version();
+  
+  for( int i=0; i<100001; ++i ) // one more deletion than logged
+  {
+    View view;
+    view_space.push_back(view);
+    view_space.deleteView( view.index() );
+  }
+  
+  ViewSpace::ChangeSet changes;
+  EXPECT_FALSE( view_space.getChangesSince(synced_version,changes) );
+  EXPECT_TRUE( view_space.getChangesSince(view_space.version()-2,changes) );
+  EXPECT_EQ( 1u, changes.deleted.size() );
+}
+
+TEST(ViewSpaceTest, deletionMovesLastViewIntoFreedSlot)
+{
+  // spans two words of the flag bitsets
+  ViewSpace view_space;
+  IdSet ids;
+  for( int i=0; i<66; ++i )
+  {
+    View view = viewAt(i,0,0);
+    view_space.push_back(view);
+    ids.push_back( view.index() );
+  }
+  view_space.setBad( ids[65] );
+  view_space.setTimesVisited( ids[65], 3 );
+  view_space.setUnReachable( ids[64] );
+  view_space.setVisited( ids[2] );
+  
+  EXPECT_TRUE( view_space.deleteView(ids[1]) );
+  EXPECT_FALSE( view_space.deleteView(ids[1]) );
+  ASSERT_EQ( 65u, view_space.size() );
+  
+  // the last view took the freed slot, the order of the others is kept
+  ViewSpace::Iterator it = view_space.begin();
+  EXPECT_EQ( ids[0], (it++)->index() );
+  EXPECT_EQ( ids[65], (it++)->index() );
+  EXPECT_EQ( ids[2], (it++)->index() );
+  
+  // and took its state and position along
+  EXPECT_TRUE( view_space.getViewRef(ids[65]).bad() );
+  EXPECT_EQ( 3u, view_space.timesVisited(ids[65]) );
+  EXPECT_EQ( 65, view_space.getViewRef(ids[65]).pose().position.x() );
+  EXPECT_EQ( ids[65], view_space.getAClosestNeighbourId(Eigen::Vector3d(65.1,0,0)) );
+  EXPECT_EQ( ids[0], view_space.getAClosestNeighbourId(Eigen::Vector3d(0.6,0,0)) );
+  
+  // deleting the first view moves the view of slot 64, emptying the second bitset word
+  EXPECT_TRUE( view_space.deleteView(ids[0]) );
+  EXPECT_EQ( ids[64], view_space.begin()->index() );
+  EXPECT_THROW( view_space.getViewRef(ids[0]), std::out_of_range );
+  
+  IdSet expected_good, expected_unvisited;
+  for( int i=2; i<64; ++i )
+  {
+    expected_good.push_back( ids[i] );
+    if( i!=2 )
+      expected_unvisited.push_back( ids[i] );
+  }
+  IdSet good, unvisited;
+  view_space.getGoodViewSpace( good, false );
+  view_space.getGoodViewSpace( unvisited, true );
+  EXPECT_EQ( expected_good, sorted(good) );
+  EXPECT_EQ( expected_unvisited, sorted(unvisited) );
+  
+  // a view added after the deletions gets a new slot in the second word again
+  View added = viewAt(66,0,0);
+  view_space.push_back(added);
+  good.clear();
+  view_space.getGoodViewSpace( good, false );
+  expected_good.push_back( added.index() );
+  EXPECT_EQ( expected_good, sorted(good) );
+}
+
+TEST(ViewSpaceTest, binaryFileRoundTrip)
+{
+  ViewSpace view_space;
+  View plain = viewAt(0.1,1.0/3,-2e-7);
+  View flagged = viewAt(-4.5,0.7,1e5,"map");
+  flagged.reachable() = false;
+  flagged.bad() = true;
+  flagged.nonViewSpace() = true;
+  flagged.timesVisited() = 7;
+  View with_fields = viewAt(3,2,1,"");
+  with_fields.additionalFieldsNames().push_back("joint_1");
+  with_fields.additionalFieldsValues().push_back(0.25);
+  with_fields.additionalFieldsNames().push_back("joint_2");
+  with_fields.additionalFieldsValues().push_back(-1.5);
+  view_space.push_back(plain);
+  view_space.push_back(flagged);
+  view_space.push_back(with_fields);
+  
+  std::string file = temporaryFile();
+  ASSERT_TRUE( view_space.saveToBinaryFile(file) );
+  ViewSpace loaded;
+  loaded.loadFromFile(file);
+  std::remove( file.c_str() );
+  
+  ASSERT_EQ( view_space.size(), loaded.size() );
+  expectSamePoses( view_space, loaded );
+  for( ViewSpace::Iterator it = view_space.begin(), other = loaded.begin(); it!=view_space.end(); ++it, ++other )
+  {
+    EXPECT_EQ( it->sourceFrame(), other->sourceFrame() );
+    EXPECT_EQ( it->reachable(), other->reachable() );
+    EXPECT_EQ( it->bad(), other->bad() );
+    EXPECT_EQ( it->nonViewSpace(), other->nonViewSpace() );
+    EXPECT_EQ( it->timesVisited(), other->timesVisited() );
+    EXPECT_EQ( it->additionalFieldsNames(), other->additionalFieldsNames() );
+    EXPECT_EQ( it->additionalFieldsValues(), other->additionalFieldsValues() );
+    EXPECT_EQ( it->timesVisited(), loaded.timesVisited(other->index()) );
+  }
+  IdSet good;
+  loaded.getGoodViewSpace( good, false );
+  EXPECT_EQ( 2u, good.size() );
+}
+
+TEST(ViewSpaceTest, textFileRoundTrip)
+{
+  ViewSpace view_space;
+  view_space.push_back( viewAt(0.1,1.0/3,-2e-7) );
+  view_space.push_back( viewAt(-4.5,0.7,1e5) );
+  view_space.push_back( viewAt(3,2,1) );
+  
+  std::string file = temporaryFile();
+  view_space.saveToFile(file);
+  ViewSpace loaded;
+  loaded.loadFromFile(file);
+  std::remove( file.c_str() );
+  
+  ASSERT_EQ( view_space.size(), loaded.size() );
+  expectSamePoses( view_space, loaded );
+}
+
+TEST(ViewSpaceTest, positionQueriesMatchBruteForce)
+{
+  std::mt19937 generator(42);
+  ViewSpace view_space;
+  addRandomViews( view_space, 400, generator );
+  expectQueriesMatchBruteForce( view_space, generator );
+  
+  // cells much smaller than the queries (sparse fallback) and a few cells containing everything
+  view_space.setIndexCellSize(0.05);
+  expectQueriesMatchBruteForce( view_space, generator );
+  view_space.setIndexCellSize(5);
+  expectQueriesMatchBruteForce( view_space, generator );
+}
+
+TEST(ViewSpaceTest, positionQueriesMatchBruteForceAfterDeletions)
+{
+  std::mt19937 generator(7);
+  ViewSpace view_space;
+  IdSet nothing;
+  view_space.getKNearest( Eigen::Vector3d::Zero(), 3, nothing );
+  EXPECT_TRUE( nothing.empty() );
+  
+  IdSet ids = addRandomViews( view_space, 300, generator );
+  for( size_t i=0; i<ids.size(); i+=3 )
+    ASSERT_TRUE( view_space.deleteView(ids[i]) );
+  
+  // some of the deleted ids are added again at other positions
+  for( size_t i=0; i<ids.size(); i+=9 )
+  {
+    View moved( ids[i] );
+    moved.pose().position = latticePoint(generator);
+    view_space.push_back(moved);
+  }
+  addRandomViews( view_space, 50, generator );
+  expectQueriesMatchBruteForce( view_space, generator );
+  
+  view_space.setIndexCellSize(0.6);
+  expectQueriesMatchBruteForce( view_space, generator );
+  
+  // deleting everything but one view
+  for( ViewSpace::Iterator it = view_space.begin(); view_space.size()>1; it = view_space.begin() )
+    view_space.deleteView( it->index() );
+  expectQueriesMatchBruteForce( view_space, generator );
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
\ No newline at end of file
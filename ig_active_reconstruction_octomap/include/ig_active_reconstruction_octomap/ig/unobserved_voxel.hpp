@@ -39,6 +39,7 @@ namespace octomap
     typedef typename InformationGain<TREE_TYPE>::Utils Utils;
     typedef typename InformationGain<TREE_TYPE>::Utils::Config Config;
     typedef typename InformationGain<TREE_TYPE>::GainType GainType;
+    typedef typename InformationGain<TREE_TYPE>::Voxel Voxel;
     
   public:
     
@@ -73,6 +74,16 @@ namespace octomap
      */
     virtual void includeEndPointMeasurement( typename TREE_TYPE::NodeType* node );
     
+    /*! Includes a measurement on the ray (non-virtual version for statically dispatched metric sets).
+     * @param voxel Voxel traversed by the ray.
+     */
+    void includeRayMeasurement( const Voxel& voxel );
+    
+    /*! Includes the endpoint of a ray (non-virtual version for statically dispatched metric sets).
+     * @param voxel Voxel at the end of the ray.
+     */
+    void includeEndPointMeasurement( const Voxel& voxel );
+    
     /*! Informs the metric that a complete ray was cast through empty space without
      * retrieving any measurements.
      */
@@ -82,11 +93,17 @@ namespace octomap
      */
     virtual uint64_t voxelCount();
     
+    /*! Adds the data accumulated by another instance of the same metric type, e.g. on a different set of rays, to this one.
+     * Only whole rays are merged: Must be called in between rays.
+     * @param other Instance of the same metric type. Throws std::bad_cast otherwise.
+     */
+    virtual void merge( const InformationGain<TREE_TYPE>& other, unsigned int weight=1 );
+    
   protected:
     /*! Helper function
-     * @param node Octomap node traversed by the ray.
+     * @param voxel Voxel traversed by the ray.
      */
-    virtual void includeMeasurement( typename TREE_TYPE::NodeType* node );
+    void includeMeasurement( const Voxel& voxel );
     
     
   private:
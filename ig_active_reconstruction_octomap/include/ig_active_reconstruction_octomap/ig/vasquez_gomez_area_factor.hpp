@@ -34,6 +34,7 @@ namespace octomap
   {
   public:
     typedef typename InformationGain<TREE_TYPE>::GainType GainType;
+    typedef typename InformationGain<TREE_TYPE>::Voxel Voxel;
     typedef typename InformationGain<TREE_TYPE>::Utils::Config Config;
     
     class Utils: public InformationGain<TREE_TYPE>::Utils
@@ -87,6 +88,16 @@ namespace octomap
      */
     virtual void includeEndPointMeasurement( typename TREE_TYPE::NodeType* node );
     
+    /*! Includes a measurement on the ray (non-virtual version for statically dispatched metric sets).
+     * @param voxel Voxel traversed by the ray.
+     */
+    void includeRayMeasurement( const Voxel& voxel );
+    
+    /*! Includes the endpoint of a ray (non-virtual version for statically dispatched metric sets).
+     * @param voxel Voxel at the end of the ray.
+     */
+    void includeEndPointMeasurement( const Voxel& voxel );
+    
     /*! Informs the metric that a complete ray was cast through empty space without
      * retrieving any measurements.
      */
@@ -96,11 +107,17 @@ namespace octomap
      */
     virtual uint64_t voxelCount();
     
+    /*! Adds the data accumulated by another instance of the same metric type, e.g. on a different set of rays, to this one.
+     * Only whole rays are merged: Must be called in between rays.
+     * @param other Instance of the same metric type. Throws std::bad_cast otherwise.
+     */
+    virtual void merge( const InformationGain<TREE_TYPE>& other, unsigned int weight=1 );
+    
   protected:
     /*! Helper function
-     * @param node Octomap node traversed by the ray.
+     * @param voxel Voxel traversed by the ray.
      */
-    virtual bool includeMeasurement( typename TREE_TYPE::NodeType* node );
+    bool includeMeasurement( const Voxel& voxel );
     
     /*! Helper function to speed up calculations: Precomputes needed coefficients for a given alpha.
      */
@@ -125,7 +142,7 @@ namespace octomap
     
     uint64_t voxel_count_; //! Voxels integrated for the information gain calculation.
     
-    bool no_known_voxel_so_far_;
+    bool no_known_voxel_so_far_; //! Whether no known voxel has been traversed yet on the current ray.
     bool previous_voxel_free_;
     bool ray_is_already_registered_; //! To ensure that every ray is only registered once.
     
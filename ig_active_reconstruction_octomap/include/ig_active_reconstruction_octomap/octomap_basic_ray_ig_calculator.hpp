@@ -19,7 +19,11 @@
 
 
 #include "ig_active_reconstruction_octomap/octomap_ig_calculator.hpp"
+#include "ig_active_reconstruction_octomap/octomap_node_lookup.hpp"
 #include "ig_active_reconstruction/world_representation_pinhole_cam_raycaster.hpp"
+#include "ig_active_reconstruction/worker_pool.hpp"
+
+#include <boost/thread/tss.hpp>
 
 namespace ig_active_reconstruction
 {
@@ -40,6 +44,7 @@ namespace octomap
     
     typedef typename IgCalculator<TREE_TYPE>::ResultInformation ResultInformation;
     typedef typename IgCalculator<TREE_TYPE>::IgRetrievalCommand IgRetrievalCommand;
+    typedef typename IgCalculator<TREE_TYPE>::IgRetrievalConfig IgRetrievalConfig;
     typedef typename IgCalculator<TREE_TYPE>::IgRetrievalResult IgRetrievalResult;
     typedef typename IgCalculator<TREE_TYPE>::MapMetricRetrievalCommand MapMetricRetrievalCommand;
     typedef typename IgCalculator<TREE_TYPE>::MapMetricRetrievalResult MapMetricRetrievalResult;
@@ -57,6 +62,15 @@ namespace octomap
       Config();
     public:
       PinholeCamRayCaster::Config ray_caster_config; //! Configuration for the pinhole ray casting module.
+      unsigned int nr_of_threads; //! Number of threads that evaluate the rays of a view, including the calling one. 0: One per hardware core, 1: Serial evaluation without worker pool. Default: 0.
+      unsigned int rays_per_chunk; //! Number of rays that are traversed as one task by the worker pool. Default: 1000.
+      
+      bool hierarchical_ig; //! If true, the image is divided into tiles and a single coarse ray per tile is cast first. Only the tiles with the highest entropy along their coarse ray are evaluated with all rays, the others with their center ray only, which then stands in for all rays of its tile. Default: false.
+      unsigned int tile_size_rays; //! Side length of the tiles used for hierarchical information gain calculation, in rays of the ray casting resolution along each image axis. Default: 4.
+      unsigned int coarse_depth_offset; //! Number of octree levels above the leaves at which the coarse rays are traversed, using the aggregated occupancy of inner nodes. Default: 2.
+      double refined_tile_fraction; //! Fraction of tiles that are refined, i.e. evaluated with all their rays [0.0-1.0]. Scaled per call by the ray resolution of the IgRetrievalConfig (ray_resolution_x*ray_resolution_y), and only tiles that overlap its ray window are refined. Default: 0.25.
+      
+      typename InformationGain<TREE_TYPE>::Config ig_config; //! Occupancy and entropy configuration with which the tiles are scored for hierarchical information gain calculation. Calculators with a fixed metric set use it for all their metrics.
     };
     
   public:
@@ -98,13 +112,77 @@ namespace octomap
     
     struct RayCastSettings
     {
+      RayCastSettings():max_ray_depth(0),octree(NULL),depth(0){};
+      
       //double min_ray_depth; //! Minimal ray length (where it starts).
       double max_ray_depth; //! Maximal ray length.
+      const TREE_TYPE* octree; //! Octree (snapshot) through which the rays are cast.
+      unsigned int depth; //! Octree depth at which the rays are traversed, 0 for the full depth (leaves).
       //double occupied_passthrough_threshold; //! If an occupied voxel's occupancy likelihood is lower than this threshold, ray casting is continued.
       //unsigned int ray_step_size; //! Voxel resolution along ray.
     };
     
+    typedef std::vector< boost::shared_ptr< InformationGain<TREE_TYPE> > > IgSet;
+    
+    /*! Voxel sink that passes all traversed voxels directly on to a set of information gain metrics.
+     */
+    class IgSetSink
+    {
+    public:
+      IgSetSink( IgSet& ig_set ):ig_set_(ig_set){};
+      
+      void startRay();
+      void includeRayMeasurement( typename TREE_TYPE::NodeType* node );
+      void includeEndPointMeasurement( typename TREE_TYPE::NodeType* node );
+      void informAboutVoidRay();
+      
+    private:
+      IgSet& ig_set_;
+    };
+    
+    /*! Voxel sink that sums up the entropy of all traversed voxels, used to score the coarse rays of hierarchical information gain calculation.
+     */
+    class EntropySink
+    {
+    public:
+      EntropySink( typename InformationGain<TREE_TYPE>::Config config ):entropy(0),utils_(config){};
+      
+      void startRay(){ entropy = 0; };
+      void includeRayMeasurement( typename TREE_TYPE::NodeType* node ){ entropy += utils_.entropy(node); };
+      void includeEndPointMeasurement( typename TREE_TYPE::NodeType* node ){ entropy += utils_.entropy(node); };
+      void informAboutVoidRay(){};
+      
+    public:
+      double entropy; //! Entropy [nat] along the last ray.
+      
+    private:
+      typename InformationGain<TREE_TYPE>::Utils utils_;
+    };
+    
   protected:
+    /*! Instantiates the metrics requested by a command and adds a result entry for every requested metric to the output, with
+     * status SUCCEEDED if the metric is available and UNKNOWN_METRIC otherwise.
+     * @param command Information gain retrieval command.
+     * @param octree Octree on which the metrics are evaluated.
+     * @param ig_set (output) Instantiated metrics.
+     * @param ig_ids (output) Factory ids of the instantiated metrics.
+     * @param output_ig (output) Result entries for all requested metrics.
+     */
+    void buildIgSet( IgRetrievalCommand& command, const TREE_TYPE* octree, IgSet& ig_set, std::vector<unsigned int>& ig_ids, ViewIgRetrievalResult& output_ig );
+    
+    /*! Instantiates further metrics with the factory ids of a set built with buildIgSet, e.g. for a chunk of rays.
+     * @param ig_ids Factory ids of the metrics.
+     * @param octree Octree on which the metrics are evaluated.
+     * @param ig_set (output) Instantiated metrics.
+     */
+    void createIgSet( const std::vector<unsigned int>& ig_ids, const TREE_TYPE* octree, IgSet& ig_set );
+    
+    /*! Writes the information gains of a metric set into the succeeded entries of a result built with buildIgSet.
+     * @param ig_set Evaluated metrics.
+     * @param output_ig (output) Result entries.
+     */
+    void collectIgs( IgSet& ig_set, ViewIgRetrievalResult& output_ig );
+    
     /*! Retrieves an information for a given ray.
      * @param ray Ray which is cast.
      * @param ig_set Set of information gains to be calculated.
@@ -112,9 +190,53 @@ namespace octomap
      */
     void calculateIgsOnRay( RayCaster::Ray& ray, std::vector< boost::shared_ptr< InformationGain<TREE_TYPE> > >& ig_set, RayCastSettings& setting );
     
+    /*! Returns the octree through which rays are cast: The current snapshot if available, otherwise the linked octree, in which case
+     * the passed lock is acquired.
+     * @param map_lock Deferred lock on the octree mutex of the link.
+     */
+    boost::shared_ptr<const TREE_TYPE> pinOctree( typename WorldRepresentation<TREE_TYPE>::ReadLock& map_lock );
+    
+    /*! Returns the rays that are cast for a view. For hierarchical information gain calculation, these are all rays of the
+     * refined tiles and the center rays of all other tiles, each weighted with the number of rays of its tile.
+     * @param sensor_pose Pose of the sensor.
+     * @param ig_config Retrieval configuration of the call, sets the refinement budget for hierarchical information gain calculation.
+     * @param utils_config Occupancy and entropy configuration, including the lookup table, with which the tiles are scored.
+     * @param setting Ray casting settings for the octree which will be evaluated.
+     * @param rays (output) Rays to cast.
+     * @param ray_weights (output) Number of rays each ray of the batch stands for. Left empty if every ray stands for itself only.
+     */
+    void getViewRays( movements::Pose& sensor_pose, const IgRetrievalConfig& ig_config, const typename InformationGain<TREE_TYPE>::Config& utils_config, RayCastSettings setting, RayCaster::RayBatch& rays, std::vector<unsigned int>& ray_weights );
+    
+    /*! Returns the ray batch buffer of the calling thread, which is reused for all views evaluated by the thread.
+     */
+    RayCaster::RayBatch& rayBuffer();
+    
+    /*! Casts a ray through the octree and passes all traversed voxels to a sink, up to and including the first occupied one.
+     * @param origin Origin of the ray.
+     * @param direction Direction of the ray.
+     * @param setting Additional ray casting settings.
+     * @param sink Receives the voxels, must provide startRay(), includeRayMeasurement(NodeType*), includeEndPointMeasurement(NodeType*) and informAboutVoidRay().
+     */
+    template<class VOXEL_SINK>
+    void traverseRay( const RayCaster::RayOrigin& origin, const RayCaster::RayDirection& direction, RayCastSettings& setting, VOXEL_SINK& sink );
+    
+    /*! Evaluates a consecutive range of rays on a separate set of information gain metrics. Executed as task by the worker pool.
+     * Rays with a weight above one are evaluated on a scratch set of metric instances, which is merged with the weight as factor.
+     * @param rays Set of rays.
+     * @param ray_weights Weights of the rays, empty if all are one.
+     * @param first Index of the first ray to evaluate.
+     * @param last Index of the last ray + 1.
+     * @param setting Additional ray casting settings.
+     * @param ig_ids Factory ids of the metrics in ig_set.
+     * @param ig_set (output) Metrics in which the information of the rays is accumulated.
+     */
+    void calculateIgsOnRays( const RayCaster::RayBatch* rays, const std::vector<unsigned int>* ray_weights, size_t first, size_t last, RayCastSettings setting, const std::vector<unsigned int>* ig_ids, IgSet* ig_set );
+    
   protected:
     Config config_; //! Configuration...
     PinholeCamRayCaster ray_caster_; //! Ray caster module.
+    boost::shared_ptr<WorkerPool> worker_pool_; //! Threads that evaluate ray chunks, NULL if the rays are evaluated serially.
+    boost::thread_specific_ptr<RayCaster::RayBatch> ray_buffer_; //! Ray batch of every thread that evaluates views.
   };
 }
 
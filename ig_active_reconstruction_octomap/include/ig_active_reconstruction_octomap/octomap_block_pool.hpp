@@ -0,0 +1,162 @@
+/* Copyright (c) 2016, Stefan Isler, islerstefan@bluewin.ch
+ * (ETH Zurich / Robotics and Perception Group, University of Zurich, Switzerland)
+ *
+ * This file is part of ig_active_reconstruction, software for information gain based, active reconstruction.
+ *
+ * ig_active_reconstruction is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * ig_active_reconstruction is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ * Please refer to the GNU Lesser General Public License for details on the license,
+ * on <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <cstddef>
+
+#include <boost/cstdint.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/tss.hpp>
+
+namespace ig_active_reconstruction
+{
+  
+namespace world_representation
+{
+
+namespace octomap
+{
+  
+  /*! Thread safe slab allocator for blocks of a fixed size, e.g. octree nodes. Blocks are carved from slabs of many blocks and
+   * recycled through free lists when they are released, such that the many small allocations of node expansions and prunings
+   * neither hit the heap nor fragment it.
+   * 
+   * Every thread keeps its own free list, allocations and releases only lock the pool when a thread's list runs empty or grows
+   * beyond twice the batch size, and then move a whole batch of blocks at once. Slabs are aligned to their size and start with
+   * their bookkeeping, such that the slab of a released block is found from its address alone. A slab is returned to the system
+   * as soon as none of its blocks is in use or held in a free list of a thread anymore, except for the one that is currently
+   * allocated from, such that clearing or deleting a tree frees its memory even while other trees still hold blocks of the same
+   * pool.
+   */
+  class BlockPool
+  {
+  public:
+    /*! Constructor.
+     * @param block_size Size of the blocks [bytes]. Rounded up to a multiple of the pointer size.
+     * @param slab_size Size of the slabs [bytes]. Rounded up to a power of two that holds at least 64 blocks.
+     */
+    BlockPool( size_t block_size, size_t slab_size = 65536 );
+    
+    /*! Frees all slabs - unless blocks are still in use, in which case they are leaked rather than invalidated.
+     */
+    ~BlockPool();
+    
+    /*! Returns an uninitialized block.
+     */
+    void* allocate();
+    
+    /*! Returns a block to the free list of the calling thread, or to the heap if pooling is disabled.
+     * @param block Block previously obtained from allocate().
+     */
+    void deallocate( void* block );
+    
+    /*! Returns the free list of the calling thread to the pool and all slabs to the system if no block is in use anymore (bulk free).
+     * @return True if the memory was released.
+     */
+    bool releaseMemory();
+    
+    /*! Returns the number of blocks currently in use, including those held in the free lists of other threads.
+     */
+    size_t blocksInUse();
+    
+    /*! Returns the memory currently held by the pool [bytes].
+     */
+    size_t reservedBytes();
+    
+    /*! Enables or disables pooling. While disabled, blocks are allocated from the heap, e.g. to compare against pooled allocation.
+     * Only possible while no block is in use (after returning the free list of the calling thread), must not be called
+     * concurrently with allocations.
+     * @param pooling True to allocate from the pool.
+     * @return False if blocks are in use, in which case nothing changes.
+     */
+    bool setPooling( bool pooling );
+    
+  private:
+    struct FreeBlock
+    {
+      FreeBlock* next;
+    };
+    
+    /*! Bookkeeping at the start of every slab.
+     */
+    struct Slab
+    {
+      size_t unused; //! Number of blocks at the end of the slab that were never handed out.
+      FreeBlock* free_list; //! Released blocks.
+      size_t blocks_in_use; //! Blocks handed out to threads.
+      Slab* prev_available; //! Neighbours in the list of slabs with free blocks.
+      Slab* next_available;
+      bool is_available; //! True if the slab is in the list of slabs with free blocks.
+    };
+    
+    /*! Free list of a thread.
+     */
+    struct ThreadCache
+    {
+      BlockPool* pool;
+      FreeBlock* free_list;
+      size_t size;
+    };
+    
+    /*! Returns the slab containing a pooled block.
+     */
+    Slab* slabOf( void* block );
+    
+    /*! Returns the free list of the calling thread.
+     */
+    ThreadCache& threadCache();
+    
+    /*! Moves a batch of blocks from the slabs to the free list of a thread.
+     */
+    void refill( ThreadCache& cache );
+    
+    /*! Returns blocks from the free list of a thread to their slabs, freeing slabs that are not in use anymore.
+     * @param nr_of_blocks Number of blocks to return, at most the size of the list.
+     */
+    void flush( ThreadCache& cache, size_t nr_of_blocks );
+    
+    /*! Returns the free list of a thread that exits to the pool.
+     */
+    static void returnThreadCache( ThreadCache* cache );
+    
+    void addAvailable( Slab* slab );
+    void removeAvailable( Slab* slab );
+    
+  private:
+    static const size_t BATCH_SIZE = 64; //! Number of blocks moved between the slabs and the free lists of the threads at once.
+    
+    size_t block_size_;
+    size_t slab_size_;
+    size_t blocks_offset_; //! Offset of the first block within a slab [bytes].
+    size_t blocks_per_slab_;
+    bool pooling_;
+    
+    boost::mutex mutex_; //! Guards the slabs.
+    Slab* available_; //! First slab with free blocks, NULL if none.
+    Slab* current_; //! Slab that is currently allocated from, NULL if none.
+    size_t nr_of_slabs_;
+    size_t blocks_in_use_; //! Blocks handed out to threads.
+    
+    boost::thread_specific_ptr<ThreadCache> caches_; //! Free lists of the threads, destroyed first.
+  };
+  
+}
+
+}
+
+}
\ No newline at end of file
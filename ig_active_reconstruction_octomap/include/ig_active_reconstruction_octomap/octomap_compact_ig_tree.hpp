@@ -0,0 +1,107 @@
+/* Copyright (c) 2016, Stefan Isler, islerstefan@bluewin.ch
+ * (ETH Zurich / Robotics and Perception Group, University of Zurich, Switzerland)
+ *
+ * This file is part of ig_active_reconstruction, software for information gain based, active reconstruction.
+ *
+ * ig_active_reconstruction is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * ig_active_reconstruction is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ * Please refer to the GNU Lesser General Public License for details on the license,
+ * on <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <octomap/OccupancyOcTreeBase.h>
+
+#include "ig_active_reconstruction_octomap/octomap_ig_tree.hpp"
+#include "ig_active_reconstruction_octomap/octomap_compact_ig_tree_node.hpp"
+
+namespace ig_active_reconstruction
+{
+  
+namespace world_representation
+{
+
+namespace octomap
+{
+  
+  /*! Occupancy OcTree class that uses the memory efficient CompactIgTreeNode class as node type. Can be used in place of IgTree,
+   * e.g. for large maps.
+   */
+  class CompactIgTree: public ::octomap::OccupancyOcTreeBase<CompactIgTreeNode>
+  {
+  public:
+    typedef CompactIgTreeNode NodeType;
+    typedef IgTree::Config Config; //! Same configuration as the IgTree.
+    
+  public:
+    //! Default constructor, sets resolution of leafs
+    CompactIgTree(double resolution_m);
+    
+    /*! Constructor with complete configuration
+     */
+    CompactIgTree(Config config);
+    
+    /*! Deep copy constructor, copies all nodes and the configuration.
+     */
+    CompactIgTree(const CompactIgTree& rhs);
+
+    /*! virtual constructor: creates a new object of same type
+     * (Covariant return type requires an up-to-date compiler)
+     */
+    CompactIgTree* create() const;
+
+    std::string getTreeType() const;
+    
+    /*! Returns the current configuration.
+     */
+    const Config& config() const;
+    
+    /*! Returns the maximal occlusion update distance that was used when the occlusion distance of a node was registered.
+     */
+    double maxDist( NodeType* node ) const;
+    
+    /*! Sets the maximal occlusion update distance used when registering the occlusion distance of a node. Stored
+     * once for all nodes of the tree.
+     */
+    void setMaxDist( NodeType* node, double max_dist );
+    
+  protected:
+    /*! Sets octree options based on current configuration
+     */
+    void updateOctreeConfig();
+    
+  protected:
+    Config config_;
+    double max_dist_; //! Maximal occlusion update distance, shared by all nodes of the tree.
+
+
+  protected:
+    /*!
+    * Static member object which ensures that this OcTree's prototype
+    * ends up in the classIDMapping only once
+    */
+    class StaticMemberInitializer{
+    public:
+    StaticMemberInitializer() {
+	CompactIgTree* tree = new CompactIgTree(0.1);
+	AbstractOcTree::registerTreeType(tree);
+    }
+    };
+    //! to ensure static initialization (only once)
+    static StaticMemberInitializer compactIgTreeMemberInit;
+
+  };
+  
+  
+}
+
+}
+
+}
\ No newline at end of file
@@ -0,0 +1,147 @@
+/* Copyright (c) 2016, Stefan Isler, islerstefan@bluewin.ch
+ * (ETH Zurich / Robotics and Perception Group, University of Zurich, Switzerland)
+ *
+ * This file is part of ig_active_reconstruction, software for information gain based, active reconstruction.
+ *
+ * ig_active_reconstruction is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * ig_active_reconstruction is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ * Please refer to the GNU Lesser General Public License for details on the license,
+ * on <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+
+#include <octomap/octomap_types.h>
+#include <octomap/octomap_utils.h>
+#include <octomap/OcTreeNode.h>
+
+#include <boost/cstdint.hpp>
+#include <limits>
+
+namespace ig_active_reconstruction
+{
+  
+namespace world_representation
+{
+
+namespace octomap
+{
+
+  /*!
+   * Memory efficient variant of IgTreeNode with the same interface (except for the maximal occlusion distance) and, for integer
+   * occlusion distances (as set by the RayOcclusionCalculator), identical behaviour:
+   * - The occlusion distance is stored as 15 bit unsigned integer [cells], saturating at 32766 and rounded to the closest integer.
+   * - The measurement flag is packed into the remaining bit.
+   * - The maximal occlusion distance is not stored per node but once per tree (see CompactIgTree::maxDist), since an occlusion
+   *   calculator sets the same value for all nodes anyway.
+   * This reduces the payload per node from 20 bytes (plus padding) to 6 bytes.
+   */
+  class CompactIgTreeNode : public ::octomap::OcTreeNode
+  {
+
+  public:
+    CompactIgTreeNode();
+    
+    /*! Deep copy, including all children. (The base class copy constructor would create children of the base node type.)
+     */
+    CompactIgTreeNode( const CompactIgTreeNode& rhs );
+    
+    ~CompactIgTreeNode();
+    
+    void expandNode();
+    bool pruneNode();
+    
+    bool operator==(const CompactIgTreeNode& rhs) const;
+    bool collapsible() const;
+    void deleteChild(unsigned int i);
+
+    bool createChild(unsigned int i);
+
+    // overloaded, so that the return type is correct:
+    inline CompactIgTreeNode* getChild(unsigned int i)
+    {
+      return static_cast<CompactIgTreeNode*> (::octomap::OcTreeDataNode<float>::getChild(i));
+    }
+    inline const CompactIgTreeNode* getChild(unsigned int i) const
+    {
+      return static_cast<const CompactIgTreeNode*> (::octomap::OcTreeDataNode<float>::getChild(i));
+    }
+
+    // -- node occupancy  ----------------------------
+
+    /// \return occupancy probability of node
+    inline double getOccupancy() const { return ::octomap::probability(value); }
+
+    /// \return log odds representation of occupancy probability of node
+    inline float getLogOdds() const{ return value; }
+    /// sets log odds occupancy of node
+    inline void setLogOdds(float l) { value = l; }
+
+    /**
+     * @return mean of all children's occupancy probabilities, in log odds
+     */
+    double getMeanChildLogOdds() const;
+
+    /**
+     * @return maximum of children's occupancy probabilities, in log odds
+     */
+    float getMaxChildLogOdds() const;
+
+    /// update this node's occupancy according to its children's maximum occupancy
+    inline void updateOccupancyChildren()
+    {
+      this->setLogOdds(this->getMaxChildLogOdds());  // conservative
+    }
+
+    /// adds p to the node's logOdds value (with no boundary / threshold checking!)
+    void addValue(const float& p);
+    
+
+    double occDist(){return (double)(occ_dist_and_flags_&OCC_DIST_MASK) - 1;};
+    // sets occDist if it's smaller than the previous value
+    void updateOccDist( double occDist )
+    {
+	double stored = occDist + 1.5; // quantize to the closest integer, 0 is reserved for "not registered"
+	if( stored<1 )
+	    stored = 1;
+	else if( stored>OCC_DIST_MASK )
+	    stored = OCC_DIST_MASK;
+	
+	boost::uint16_t new_occ_dist = (boost::uint16_t)stored;
+	boost::uint16_t occ_dist = occ_dist_and_flags_&OCC_DIST_MASK;
+	if( occ_dist==0 || new_occ_dist<occ_dist )
+	    occ_dist_and_flags_ = (occ_dist_and_flags_&NO_MEASUREMENT_FLAG) | new_occ_dist;
+    };
+    
+    // whether this node has been measured or not
+    bool hasMeasurement(){return (occ_dist_and_flags_&NO_MEASUREMENT_FLAG)==0;};
+    void updateHasMeasurement( bool hasMeasurement )
+    {
+	if( hasMeasurement )
+	    occ_dist_and_flags_ &= OCC_DIST_MASK;
+	else
+	    occ_dist_and_flags_ |= NO_MEASUREMENT_FLAG;
+    };
+    
+  protected:
+    enum
+    {
+      NO_MEASUREMENT_FLAG = 0x8000,
+      OCC_DIST_MASK = 0x7FFF
+    };
+    
+    boost::uint16_t occ_dist_and_flags_; //! Bit 15: Set if this node was setup for additional data but was not actually part of a measurement (not free and not occupied). Bits 0-14: Shortest distance from an occupied node for which an occlusion was registered + 1 [cells], 0 if not registered so far.
+  };
+
+} // end namespace
+
+}
+
+}
\ No newline at end of file
@@ -17,6 +17,8 @@
 
 #pragma once
 
+#include <boost/thread/mutex.hpp>
+
 #include "ig_active_reconstruction/world_representation_communication_interface.hpp"
 #include "ig_active_reconstruction_octomap/octomap_world_representation.hpp"
 
@@ -94,9 +96,20 @@ namespace octomap
     template<template<typename> class IG_METRIC_TYPE>
     boost::shared_ptr< InformationGain<TREE_TYPE> > makeShared(typename IG_METRIC_TYPE<TREE_TYPE>::Utils::Config utils);
     
+    /*! Sets the occupancy and entropy lookup table of an information gain configuration if it uses one but none is set yet.
+     * The table is built for the clamping thresholds of the linked octree and shared by all metrics until the configuration changes.
+     * @param utils Information gain configuration.
+     * @return Configuration including the lookup table.
+     */
+    typename InformationGain<TREE_TYPE>::Config withLookupTable( typename InformationGain<TREE_TYPE>::Config utils );
+    
   protected:
     IgFactory ig_factory_; //! Information gain factory.
     MmFactory mm_factory_; //! Map metric factory.
+    
+  private:
+    boost::shared_ptr<const LogOddsTable> lookup_table_; //! Most recently built lookup table.
+    boost::mutex lookup_table_mutex_;
   };
 }
 
@@ -61,6 +61,14 @@ namespace octomap
     /*! Constructor with complete configuration
      */
     IgTree(Config config);
+    
+    /*! Deep copy constructor, copies all nodes and the configuration.
+     */
+    IgTree(const IgTree& rhs);
+    
+    /*! Deletes all nodes, returning their memory to the system, and frees the node pools completely if no other tree holds nodes anymore.
+     */
+    virtual ~IgTree();
 
     /*! virtual constructor: creates a new object of same type
      * (Covariant return type requires an up-to-date compiler)
@@ -73,6 +81,14 @@ namespace octomap
      */
     const Config& config() const;
     
+    /*! Returns the maximal occlusion update distance that was used when the occlusion distance of a node was registered.
+     */
+    double maxDist( NodeType* node ) const{ return node->maxDist(); };
+    
+    /*! Sets the maximal occlusion update distance used when registering the occlusion distance of a node.
+     */
+    void setMaxDist( NodeType* node, double max_dist ){ node->setMaxDist(max_dist); };
+    
   protected:
     /*! Sets octree options based on current configuration
      */
@@ -24,6 +24,8 @@
 
 #include <limits>
 
+#include "ig_active_reconstruction_octomap/octomap_block_pool.hpp"
+
 namespace ig_active_reconstruction
 {
   
@@ -37,14 +39,38 @@ namespace octomap
    * The IgTreeNode is based on octomaps OcTreeNode class, adding
    * some functionality needed for information gain calculations.
    *
+   * Nodes and their children arrays are allocated from block pools instead of the heap. The pools are shared by all trees,
+   * memory of nodes that are deleted when a tree is cleared or destroyed is returned to the system slab-wise.
    */
   class IgTreeNode : public ::octomap::OcTreeNode
   {
 
   public:
     IgTreeNode();
+    
+    /*! Deep copy, including all children. (The base class copy constructor would create children of the base node type.)
+     */
+    IgTreeNode( const IgTreeNode& rhs );
+    
+    /*! Deletes all children, returning their memory to the pools.
+     */
     ~IgTreeNode();
     
+    /*! Allocates nodes from the node pool.
+     */
+    static void* operator new( size_t size );
+    static void operator delete( void* node, size_t size );
+    
+    /*! Returns the memory of the node pools to the system if no node is alive anymore.
+     */
+    static void releasePooledMemory();
+    
+    /*! Enables or disables pooled allocation. Only possible while no node is alive.
+     * @param pooling If false, nodes and children arrays are allocated from the heap.
+     * @return False if nodes are alive, in which case nothing changes.
+     */
+    static bool setPooledAllocation( bool pooling );
+    
     void expandNode();
     bool pruneNode();
     
@@ -113,6 +139,18 @@ namespace octomap
     void updateHasMeasurement( bool hasMeasurement ){has_no_measurement_=!hasMeasurement;};
     
   protected:
+    /*! Allocates an empty children array from the pool.
+     */
+    void allocPooledChildren();
+    
+    /*! Deletes all children and returns the children array to the pool.
+     */
+    void deletePooledChildren();
+    
+  protected:
+    static BlockPool node_pool_; //! Memory for nodes.
+    static BlockPool children_pool_; //! Memory for the children arrays of nodes.
+    
     double occ_dist_; //! if node is occluded this sets the shortest distance from an occupied node for which the occlusion was registered, -1 if not registered so far
     double max_dist_; //! Maximal occlusion update distance used when calculating occlusions.
     bool has_no_measurement_; //! True if this node was setup for additional data but was not actually part of a measurement (not free and not occupied)
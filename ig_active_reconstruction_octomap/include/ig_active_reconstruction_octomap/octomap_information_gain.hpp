@@ -17,6 +17,10 @@
 
 #pragma once
 
+#include <boost/shared_ptr.hpp>
+
+#include "ig_active_reconstruction_octomap/octomap_log_odds_table.hpp"
+
 namespace ig_active_reconstruction
 {
   
@@ -33,6 +37,14 @@ namespace octomap
    * on every voxel the ray traversed but the last one, for which includeEndPointMeasurement(...) is called.
    * If a ray was cast through empty (unknown, uninitialized) space solely, informAboutVoidRay() is called.
    * The calculated information gain is retrieved after the last ray was cast through getInformation().
+   * 
+   * Metrics additionally provide non-virtual includeRayMeasurement(const Voxel&) and includeEndPointMeasurement(const Voxel&)
+   * overloads that take the precalculated occupancy and entropy of the voxel, such that metric sets whose types are known at
+   * compile time can be evaluated without virtual calls and without recalculating them for every metric.
+   * 
+   * The rays of a view can also be split among several instances of the same metric, e.g. to evaluate them in parallel.
+   * The partial results are then combined with merge(...), which yields the same result as if all rays had been passed
+   * to a single instance.
    */
   template<class TREE_TYPE>
   class InformationGain
@@ -40,6 +52,7 @@ namespace octomap
   public:
     typedef double GainType;
     typedef boost::shared_ptr< InformationGain<TREE_TYPE> > Ptr;
+    
         
     /*! Helper class for common calculation in information gain metrics.
      */
@@ -58,6 +71,9 @@ namespace octomap
 	double p_unknown_upper_bound; //! Upper bound for voxels to still be considered uncertain. Default: 0.8.
 	double p_unknown_lower_bound; //! Lower bound for voxels to still be considered uncertain. Default: 0.2.
 	unsigned int voxels_in_void_ray; //! How many voxels are considered to be part of a void ray. Default: 100.
+	bool use_lookup_table; //! Whether occupancies and entropies are looked up in a precalculated table instead of being calculated for every voxel. Default: true.
+	double lookup_table_resolution; //! Log odds step between two entries of the lookup table. Default: 0.001.
+	boost::shared_ptr<const LogOddsTable> lookup_table; //! Lookup table, set by the information gain calculators based on the clamping thresholds of the octree if use_lookup_table is set. Default: NULL.
       } config;
       
     public:
@@ -75,6 +91,11 @@ namespace octomap
        */
       double pOccupancy( typename TREE_TYPE::NodeType* voxel );
       
+      /*! Retrieves occupancy probability and entropy of the passed voxel from the lookup table.
+       * @return False if no lookup table is set or if the voxel's occupancy isn't covered by it. The outputs are not set in this case.
+       */
+      bool lookUp( typename TREE_TYPE::NodeType* voxel, double& p_occ, double& entropy );
+      
       /*! Returns true if the likelihood lies within the unknown bounds.
        */
       bool isUnknown( typename TREE_TYPE::NodeType* voxel);
@@ -102,7 +123,37 @@ namespace octomap
     
     typedef typename Utils::Config Config;
     
+    /*! Voxel traversed by a ray. Occupancy likelihood and entropy are calculated on first access and then cached, such
+     * that they are calculated at most once per voxel, even if several metrics are evaluated on the same ray.
+     */
+    class Voxel
+    {
+    public:
+      /*! Constructor.
+       * @param node Octree node, NULL if it doesn't exist.
+       * @param utils Used to calculate occupancy and entropy, must outlive the object.
+       */
+      Voxel( typename TREE_TYPE::NodeType* node, Utils& utils );
+      
+      /*! Returns the occupancy likelihood of the voxel (prior for unknown voxels).
+       */
+      double pOccupancy() const;
+      
+      /*! Returns the entropy [nat] of the voxel's occupancy likelihood.
+       */
+      double entropy() const;
+      
+    public:
+      typename TREE_TYPE::NodeType* node; //! Octree node, NULL if it doesn't exist.
+      
+    private:
+      Utils* utils_;
+      mutable double p_occ_; //! Cached occupancy likelihood, negative if not calculated yet.
+      mutable double entropy_; //! Cached entropy, negative if not calculated yet.
+    };
+    
   public:
+    InformationGain():octree_(NULL){};
     
     /*! Returns the name of the method.
      */
@@ -140,6 +191,21 @@ namespace octomap
      */
     virtual uint64_t voxelCount()=0;
     
+    /*! Adds the data accumulated by another instance of the same metric type, e.g. on a different set of rays, to this one.
+     * Only whole rays are merged: Must be called in between rays.
+     * @param other Instance of the same metric type. Throws std::bad_cast otherwise.
+     * @param weight Number of times the data of the other instance is added, as if its rays had been evaluated that many times.
+     */
+    virtual void merge( const InformationGain<TREE_TYPE>& other, unsigned int weight=1 )=0;
+    
+    /*! Sets the octree on which the metric is evaluated, which provides the voxel data that is stored per tree instead of per
+     * node, such as the maximal occlusion distance. Set by the information gain calculators before rays are cast.
+     * @param octree Octree (snapshot) through which the rays are cast.
+     */
+    void setOctree( const TREE_TYPE* octree ){ octree_ = octree; };
+    
+  protected:
+    const TREE_TYPE* octree_; //! Octree on which the metric is evaluated, NULL if not set.
     
   };
   
@@ -0,0 +1,109 @@
+/* Copyright (c) 2016, Stefan Isler, islerstefan@bluewin.ch
+ * (ETH Zurich / Robotics and Perception Group, University of Zurich, Switzerland)
+ *
+ * This file is part of ig_active_reconstruction, software for information gain based, active reconstruction.
+ *
+ * ig_active_reconstruction is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * ig_active_reconstruction is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ * Please refer to the GNU Lesser General Public License for details on the license,
+ * on <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <vector>
+#include <cstddef>
+
+namespace ig_active_reconstruction
+{
+  
+namespace world_representation
+{
+
+namespace octomap
+{
+  
+  /*! Precalculated occupancy likelihoods and entropies for a range of log odds values, such that they can be looked up instead of
+   * evaluating the logistic function and two logarithms for every voxel traversed during the information gain calculation.
+   * The occupancy of a voxel in a clamped octree always lies within the clamping thresholds, so these bound the table.
+   * Values in between the entries are interpolated linearly.
+   */
+  class LogOddsTable
+  {
+  public:
+    /*! Constructor, calculates the table.
+     * @param min_log_odds Lower end of the covered range, e.g. the lower clamping threshold of the octree [log odds].
+     * @param max_log_odds Upper end of the covered range, e.g. the upper clamping threshold of the octree [log odds].
+     * @param resolution Log odds step between two entries.
+     * @param p_unknown_prior Occupancy likelihood of unknown voxels.
+     */
+    LogOddsTable( double min_log_odds, double max_log_odds, double resolution, double p_unknown_prior );
+    
+    /*! Looks up occupancy likelihood and entropy [nat] for a log odds value.
+     * @param log_odds Log odds occupancy.
+     * @param p_occ (output) Occupancy likelihood.
+     * @param entropy (output) Entropy of the occupancy likelihood.
+     * @return False if the value lies outside of the table. The outputs are not set in this case.
+     */
+    inline bool lookUp( float log_odds, double& p_occ, double& entropy ) const
+    {
+      double pos = (log_odds-first_log_odds_)*inv_resolution_;
+      if( !(pos>=0 && pos<last_pos_) )
+	return false;
+      
+      size_t i = static_cast<size_t>(pos);
+      double weight = pos-i;
+      const Entry& lower = entries_[i];
+      const Entry& upper = entries_[i+1];
+      p_occ = lower.p_occ + weight*(upper.p_occ-lower.p_occ);
+      entropy = lower.entropy + weight*(upper.entropy-lower.entropy);
+      return true;
+    }
+    
+    /*! Returns the occupancy likelihood of unknown voxels the table was built for.
+     */
+    double priorOccupancy() const;
+    
+    /*! Returns the entropy of the unknown voxel prior.
+     */
+    double priorEntropy() const;
+    
+    /*! Returns true if the table was built with the given parameters.
+     */
+    bool matches( double min_log_odds, double max_log_odds, double resolution, double p_unknown_prior ) const;
+    
+    /*! Calculates the entropy [nat] for a given likelihood.
+     */
+    static double entropy( double likelihood );
+    
+  private:
+    struct Entry
+    {
+      double p_occ;
+      double entropy;
+    };
+    
+  private:
+    double min_log_odds_;
+    double max_log_odds_;
+    double resolution_;
+    double p_unknown_prior_;
+    double prior_entropy_;
+    
+    double first_log_odds_; //! Log odds value of the first entry.
+    double inv_resolution_;
+    double last_pos_; //! Index of the last entry: Lookups must lie below it.
+    std::vector<Entry> entries_;
+  };
+  
+}
+
+}
+
+}
\ No newline at end of file
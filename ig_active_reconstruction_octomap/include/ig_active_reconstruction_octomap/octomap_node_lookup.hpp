@@ -0,0 +1,70 @@
+/* Copyright (c) 2016, Stefan Isler, islerstefan@bluewin.ch
+ * (ETH Zurich / Robotics and Perception Group, University of Zurich, Switzerland)
+ *
+ * This file is part of ig_active_reconstruction, software for information gain based, active reconstruction.
+ *
+ * ig_active_reconstruction is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * ig_active_reconstruction is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ * Please refer to the GNU Lesser General Public License for details on the license,
+ * on <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <octomap/OcTreeKey.h>
+
+namespace ig_active_reconstruction
+{
+  
+namespace world_representation
+{
+
+namespace octomap
+{
+  /*! Octree search for sequences of neighbouring keys, e.g. the voxels along a ray. The path from the root to the node found
+   * for the previous key is kept, and a search restarts from the deepest ancestor that the previous and the new key have in
+   * common instead of descending from the root again. Neighbouring keys typically share all but the last few levels.
+   * The returned node is the same as for TREE_TYPE::search(key).
+   * The tree must not be modified while the lookup object is in use.
+   */
+  template<class TREE_TYPE>
+  class NodeLookup
+  {
+  public:
+    typedef typename TREE_TYPE::NodeType NodeType;
+    
+  public:
+    /*! Constructor.
+     * @param octree Octree in which is searched.
+     */
+    NodeLookup( const TREE_TYPE& octree );
+    
+    /*! Returns the node containing a key at the given depth (or the pruned leaf containing it), NULL if it doesn't exist.
+     * @param key Key to search.
+     * @param depth Depth at which the search stops, 0 for the full tree depth.
+     */
+    NodeType* search( const ::octomap::OcTreeKey& key, unsigned int depth = 0 );
+    
+  private:
+    unsigned int tree_depth_;
+    std::vector<NodeType*> path_; //! path_[i] is the node at depth i on the path of the previous search, path_[0] is the root.
+    unsigned int path_length_; //! Depth of the node at which the previous search ended.
+    ::octomap::OcTreeKey previous_key_; //! Key of the previous search.
+    bool has_previous_; //! Whether there was a previous search.
+  };
+  
+}
+
+}
+
+}
+
+#include "../src/code_base/octomap_node_lookup.inl"
\ No newline at end of file
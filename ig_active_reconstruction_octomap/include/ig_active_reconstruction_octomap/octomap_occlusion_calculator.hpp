@@ -36,6 +36,15 @@ namespace octomap
   template<class TREE_TYPE, class POINTCLOUD_TYPE>
   class OcclusionCalculator: public WorldRepresentation<TREE_TYPE>::LinkedObject
   {
+  public:
+    /*! Base class for updates computed by prepare(), each implementation derives its own.
+     */
+    class PreparedUpdate
+    {
+    public:
+      virtual ~PreparedUpdate(){};
+    };
+    
   public:
     virtual ~OcclusionCalculator(){};
     
@@ -47,6 +56,22 @@ namespace octomap
      */
     virtual void insert( const Eigen::Vector3d& origin, const POINTCLOUD_TYPE& pcl, std::vector<int>& valid_indices )=0;
     
+    /*! Optional two-phase alternative to insert(): prepare() may only depend on the geometry of the octree (e.g. compute keys) and
+     * can thus run concurrently to other updates of the octree, commit() applies the prepared update while the octree is locked for
+     * writing. The prepared update is owned by the caller, such that several pointclouds may be prepared at the same time.
+     * The default implementation doesn't support it.
+     * @param origin Origin of the sensor, position from which pointcloud was obtained.
+     * @param pcl The pointcloud. Doesn't need to outlive the call.
+     * @param valid_indices Vector with the indices of all points in the pointcloud that should be considered
+     * @return The prepared update, NULL if preparation isn't supported and insert() must be used instead.
+     */
+    virtual boost::shared_ptr<PreparedUpdate> prepare( const Eigen::Vector3d& origin, const POINTCLOUD_TYPE& pcl, std::vector<int>& valid_indices ){ return boost::shared_ptr<PreparedUpdate>(); };
+    
+    /*! Applies an update computed by prepare().
+     * @param update Update returned by prepare() of the same calculator.
+     */
+    virtual void commit( const PreparedUpdate& update ){};
+    
     /*! Sets the octree in which occlusions will be marked.
      */
     virtual void setOctree( boost::shared_ptr<TREE_TYPE> octree )=0;
@@ -32,6 +32,22 @@ namespace world_representation
 
 namespace octomap
 {  
+  /*! Non-owning view on the xyz coordinates of a raw, possibly organized point buffer (e.g. the data of a sensor_msgs::PointCloud2),
+   * allowing to read points with strided access without deserializing them into a pointcloud first. Coordinates must be 32 bit floats
+   * in host byte order.
+   */
+  struct RawPointCloud
+  {
+    const unsigned char* data; //! First byte of the buffer.
+    unsigned int width; //! Number of points per row.
+    unsigned int height; //! Number of rows.
+    unsigned int point_step; //! Size of a point [bytes].
+    unsigned int row_step; //! Size of a row [bytes].
+    unsigned int x_offset; //! Offset of the x coordinate within a point [bytes].
+    unsigned int y_offset; //! Offset of the y coordinate within a point [bytes].
+    unsigned int z_offset; //! Offset of the z coordinate within a point [bytes].
+  };
+  
   /*! Base class for pointcloud type input to octomap. Provides setOcclusionCalculator() functionality. Inherits setLink() property from LinkedObject class.
    */
   template<class TREE_TYPE, class POINTCLOUD_TYPE>
@@ -51,6 +67,15 @@ namespace octomap
      */
     virtual void push( const Eigen::Transform<double,3,Eigen::Affine>& sensor_to_world, POINTCLOUD_TYPE& pcl )=0;
     
+    /*! Inserts a new pointcloud directly from a raw point buffer. Inputs that can't avoid the conversion to POINTCLOUD_TYPE
+     * don't need to implement it, the default implementation returns false.
+     * 
+     * @param sensor_to_world Transform from sensor to world coordinates.
+     * @param pcl The points that are to be inserted, in sensor coordinates. Not altered.
+     * @return True if the points were inserted, false if raw input is not supported.
+     */
+    virtual bool pushRaw( const Eigen::Transform<double,3,Eigen::Affine>& sensor_to_world, const RawPointCloud& pcl );
+    
     /*! (for when cpp11 is enabled) Adds an occlusion calculator that will be called at the end of pointcloud insertions. 
      * It is expected to derive from OcclusionCalculator and to take two template arguments: TREE_TYPE and POINTCLOUD_TYPE.
      * 
@@ -0,0 +1,189 @@
+/* Copyright (c) 2016, Stefan Isler, islerstefan@bluewin.ch
+ * (ETH Zurich / Robotics and Perception Group, University of Zurich, Switzerland)
+ *
+ * This file is part of ig_active_reconstruction, software for information gain based, active reconstruction.
+ *
+ * ig_active_reconstruction is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * ig_active_reconstruction is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ * Please refer to the GNU Lesser General Public License for details on the license,
+ * on <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <vector>
+
+#include "ig_active_reconstruction_octomap/octomap_basic_ray_ig_calculator.hpp"
+
+namespace ig_active_reconstruction
+{
+  
+namespace world_representation
+{
+  
+namespace octomap
+{  
+  /*! Information gain calculator that projects the octree into the view instead of casting a ray per pixel: Rays of
+   * neighbouring pixels traverse mostly the same voxels close to the sensor, which are then searched for every ray again.
+   * 
+   * Here, the octree is traversed once, culling all subtrees that lie outside of the view frustum given by the ray caster
+   * configuration. Each remaining leaf is projected onto the image, into the buckets of all pixels it covers, and occupied leaves
+   * are additionally written into a depth buffer. Leaves behind the closest occupied leaf of a pixel are not visible through it
+   * and are dropped. Finally the visible leaves of every pixel are passed to the metrics ordered by distance, just like the voxels
+   * along a cast ray. Unknown space between the leaves is passed as unknown voxels (NULL), its extent estimated by the gap
+   * between the leaves.
+   * 
+   * The result approximates the one of the BasicRayIgCalculator: Leaves are projected with their bounding spheres (or, if these reach
+   * the sensor plane, with their boxes) and pruned
+   * leaves count as one voxel per resolution step along their size. It is faster if the view frustum contains few leaves
+   * compared to the number of voxels traversed by the rays, e.g. in sparse maps and for high image resolutions.
+   * Rays are evaluated per pixel, the ray resolution settings of the ray caster only determine how many rays each pixel counts.
+   */
+  template<class TREE_TYPE>
+  class ProjectionIgCalculator: public BasicRayIgCalculator<TREE_TYPE>
+  {
+  public:
+    typedef boost::shared_ptr< ProjectionIgCalculator<TREE_TYPE> > Ptr;
+    
+    typedef typename BasicRayIgCalculator<TREE_TYPE>::Config Config;
+    typedef typename BasicRayIgCalculator<TREE_TYPE>::ResultInformation ResultInformation;
+    typedef typename BasicRayIgCalculator<TREE_TYPE>::IgRetrievalCommand IgRetrievalCommand;
+    typedef typename BasicRayIgCalculator<TREE_TYPE>::IgRetrievalResult IgRetrievalResult;
+    typedef typename BasicRayIgCalculator<TREE_TYPE>::ViewIgRetrievalResult ViewIgRetrievalResult;
+    
+  public:
+    /*! Constructor.
+     */
+    ProjectionIgCalculator( Config config = Config() );
+    
+    virtual ~ProjectionIgCalculator(){};
+    
+  // Interface implementation
+  public:
+    /*! Calculates a set of information gains for a given view.
+     * @param command Specifies which information gains have to be calculated and for which pose along with further parameters that define how the ig('s) will be collected.
+     * @param output_ig (Output) Vector with the results of the information gain calculation. The indices correspond to the indices of the names in the metric_names array within the passed command.
+     */
+    virtual ResultInformation computeViewIg(IgRetrievalCommand& command, ViewIgRetrievalResult& output_ig);
+    
+  protected:
+    typedef typename BasicRayIgCalculator<TREE_TYPE>::IgSet IgSet;
+    typedef typename BasicRayIgCalculator<TREE_TYPE>::IgSetSink IgSetSink;
+    
+    /*! Pixel window [x_min,x_max]x[y_min,y_max] covered by a projected leaf. Empty if x_min>x_max.
+     */
+    struct Footprint
+    {
+      int x_min, x_max;
+      int y_min, y_max;
+    };
+    
+    /*! Leaf within the view frustum.
+     */
+    struct Leaf
+    {
+      typename TREE_TYPE::NodeType* node;
+      double distance; //! Distance of the leaf center to the sensor.
+      double size; //! Side length of the leaf.
+      bool is_occupied;
+      Footprint footprint; //! Pixels whose rays may pass through the leaf.
+      Footprint occluded; //! Pixels whose rays certainly pass through the leaf.
+    };
+    
+    /*! Leaf in the bucket of a pixel.
+     */
+    struct Projection
+    {
+      Projection(){};
+      Projection( const Leaf& leaf ):node(leaf.node),distance(leaf.distance),size(leaf.size),is_occupied(leaf.is_occupied){};
+      bool operator<( const Projection& other ) const{ return distance<other.distance; };
+      
+      typename TREE_TYPE::NodeType* node;
+      double distance;
+      double size;
+      bool is_occupied;
+    };
+    
+    /*! View frustum of the sensor at a given pose.
+     */
+    class Frustum
+    {
+    public:
+      /*! Constructor.
+       * @param config Camera model, image size and maximal ray depth.
+       * @param sensor_pose Pose of the sensor.
+       */
+      Frustum( const PinholeCamRayCaster::Config& config, const movements::Pose& sensor_pose );
+      
+      /*! Transforms a point from world to sensor coordinates.
+       */
+      Eigen::Vector3d toSensor( const Eigen::Vector3d& point ) const;
+      
+      /*! Returns false if a sphere given in sensor coordinates lies completely outside of the frustum.
+       */
+      bool intersects( const Eigen::Vector3d& center, double radius ) const;
+      
+      /*! Returns the pixels covered by a sphere given in sensor coordinates.
+       * @param center Center of the sphere.
+       * @param radius Radius of the sphere.
+       * @param inner If false, all pixels whose rays may pass through the sphere are returned (the whole image if the sphere reaches
+       *   the sensor plane). If true, only pixels whose rays certainly pass through it are returned (none if the sphere reaches the sensor plane).
+       */
+      Footprint project( const Eigen::Vector3d& center, double radius, bool inner=false ) const;
+      
+      /*! Returns the pixels whose rays may pass through an axis aligned box given in world coordinates, i.e. the bounding window of its
+       * part in front of the sensor plane. Used for leaves close to the sensor plane, for which the bounding sphere covers the whole image.
+       * @param center Center of the box.
+       * @param size Edge length of the box.
+       */
+      Footprint projectBox( const Eigen::Vector3d& center, double size ) const;
+      
+    public:
+      Eigen::Vector3d origin;
+      Eigen::Quaterniond to_sensor;
+      double fx, fy, cx, cy;
+      int width, height; //! Pixel coordinates range from 0 to width and 0 to height respectively (as for the ray caster).
+      double max_range;
+      
+    private:
+      double x_min_slope, x_max_slope; //! Slopes x/z of the left and right frustum planes.
+      double y_min_slope, y_max_slope; //! Slopes y/z of the top and bottom frustum planes.
+    };
+    
+  protected:
+    /*! Collects the leaves of a subtree that lie (partly) within the frustum.
+     * @param node Root of the subtree.
+     * @param center Center of the subtree's volume.
+     * @param size Side length of the subtree's volume.
+     * @param depth Depth of the subtree's root.
+     * @param frustum View frustum.
+     * @param octree Octree to which the subtree belongs.
+     * @param leaves (output) Collected leaves.
+     */
+    void collectLeaves( typename TREE_TYPE::NodeType* node, const Eigen::Vector3d& center, double size, unsigned int depth, const Frustum& frustum, const TREE_TYPE& octree, std::vector<Leaf>& leaves );
+    
+    /*! Passes the visible leaves of a consecutive range of pixels to a set of metrics, once per ray of each pixel. Executed as
+     * task by the worker pool.
+     * @param buckets Visible leaves of all pixels, sorted by distance.
+     * @param rays_per_pixel Number of rays of all pixels.
+     * @param first Index of the first pixel to evaluate.
+     * @param last Index of the last pixel + 1.
+     * @param frustum View frustum.
+     * @param resolution Octree resolution.
+     * @param ig_set (output) Metrics in which the information of the pixels is accumulated.
+     */
+    void calculateIgsOnPixels( std::vector< std::vector<Projection> >* buckets, std::vector<unsigned int>* rays_per_pixel, size_t first, size_t last, const Frustum* frustum, double resolution, IgSet* ig_set );
+  };
+}
+
+}
+
+}
+
+#include "../src/code_base/octomap_projection_ig_calculator.inl"
\ No newline at end of file
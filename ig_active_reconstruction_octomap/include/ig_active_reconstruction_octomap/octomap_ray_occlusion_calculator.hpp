@@ -28,6 +28,10 @@ namespace world_representation
 namespace octomap
 {
   /*! Calculates occlusion distances for a given distance along rays behind points.
+   * 
+   * The shadow rays of all points are computed first and deduplicated by voxel, keeping the smallest distance of each voxel, before
+   * the octree is updated. Computing them only depends on the geometry of the octree, such that it can be done concurrently to other
+   * updates with prepare() and commit().
    */
   template<class TREE_TYPE, class POINTCLOUD_TYPE>
   class RayOcclusionCalculator: public OcclusionCalculator<TREE_TYPE,POINTCLOUD_TYPE>
@@ -42,6 +46,9 @@ namespace octomap
       double occlusion_update_dist_m; //! Max distance behind points along ray for which an occlusion will be calculated [m].
     };
     
+  public:
+    typedef typename OcclusionCalculator<TREE_TYPE,POINTCLOUD_TYPE>::PreparedUpdate PreparedUpdate;
+    
   public:
     /*! Constructor
      * @param occlusion_update_dist_m 
@@ -55,10 +62,40 @@ namespace octomap
      */
     virtual void insert( const Eigen::Vector3d& origin, const POINTCLOUD_TYPE& pcl, std::vector<int>& valid_indices );
     
+    /*! Computes the deduplicated shadow cells of all points without accessing the nodes of the octree.
+     * @param origin Origin of the sensor, position from which pointcloud was obtained.
+     * @param valid_indices Vector with the indices of all points in the pointcloud that should be considered
+     * @return The shadow cells (ShadowCells).
+     */
+    virtual boost::shared_ptr<PreparedUpdate> prepare( const Eigen::Vector3d& origin, const POINTCLOUD_TYPE& pcl, std::vector<int>& valid_indices );
+    
+    /*! Sets the occlusion distances of shadow cells computed by prepare(): Existing nodes without measurement are updated first,
+     * then the missing nodes are created.
+     * @param update ShadowCells returned by prepare().
+     */
+    virtual void commit( const PreparedUpdate& update );
+    
     /*! Sets the octree in which occlusions will be marked.
      */
     virtual void setOctree( boost::shared_ptr<TREE_TYPE> octree );
     
+  protected:
+    /*! Voxel behind an occupied one.
+     */
+    struct ShadowCell
+    {
+      ::octomap::OcTreeKey key;
+      unsigned int dist; //! Smallest number of cells between the voxel and an occupied one along any of the rays.
+    };
+    
+    /*! Update computed by prepare().
+     */
+    class ShadowCells: public PreparedUpdate
+    {
+    public:
+      std::vector<ShadowCell> cells; //! Each voxel once, in the order of its first occurrence.
+    };
+    
   protected:
     double occlusion_update_dist_m_; //! Max distance behind points along ray for which an occlusion will be calculated [m].
   };
@@ -17,6 +17,13 @@
 
 #pragma once
 
+#include <deque>
+#include <map>
+
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+
 #include <ros/ros.h>
 #include <tf/transform_listener.h>
 
@@ -38,17 +45,58 @@ namespace octomap
    * 
    * Subscribes to "pcl_input" on the passed ros node.
    * Advertices "pcl_input" as service
+   * Publishes the sequence number of every integrated cloud on "pcl_input_integrated" (std_msgs/UInt64).
+   * Publishes the sequence number of every dropped cloud on "pcl_input_dropped" (std_msgs/UInt64).
+   * 
+   * Every received cloud gets a sequence number (returned by the service). In asynchronous mode, clouds are put into a bounded queue
+   * and integrated by a dedicated thread, such that neither service callers nor the subscriber are blocked while the map is updated.
+   * The sensor pose is looked up when a cloud is received and queued along with it. Every sequence number is eventually published
+   * on exactly one of "pcl_input_integrated" and "pcl_input_dropped", callers can wait for it there or with waitForIntegration().
    */
   template<class TREE_TYPE, class POINTCLOUD_TYPE>
   class RosPclInput
   {
+  public:
+    struct Config
+    {
+    public:
+      /*! Constructor sets default parameter values. */
+      Config();
+      
+    public:
+      bool async; //! If true, clouds are integrated by a dedicated thread and the service returns as soon as the cloud is queued. Default: false.
+      unsigned int queue_size; //! Maximal number of clouds waiting for integration in asynchronous mode. If a new cloud arrives while the queue is full, the oldest queued one is dropped. Default: 3.
+    };
+    
+    /*! State of a cloud with given sequence number.
+     */
+    enum CloudState
+    {
+      PENDING, //! Queued or being integrated.
+      INTEGRATED, //! The map contains the cloud.
+      DROPPED, //! The cloud was not integrated, either due to queue overflow or because it couldn't be transformed to the world frame.
+      UNKNOWN //! No cloud with this sequence number was received yet or its state isn't recorded anymore.
+    };
+    
   public:
     /*! Constructor.
      * @param nh ros node handle under which topic and service will be advertised.
      * @param pcl_input PclInput object pointer to which pointclouds are forwarded.
      * @param world_frame Name of the world coordinate frame to which the incoming pointclouds will be transformed.
+     * @param config Configuration.
      */
-    RosPclInput( ros::NodeHandle nh, boost::shared_ptr< PclInput<TREE_TYPE,POINTCLOUD_TYPE> > pcl_input, std::string world_frame );
+    RosPclInput( ros::NodeHandle nh, boost::shared_ptr< PclInput<TREE_TYPE,POINTCLOUD_TYPE> > pcl_input, std::string world_frame, Config config = Config() );
+    
+    /*! Destructor, integrates the clouds that are still queued and stops the integration thread.
+     */
+    virtual ~RosPclInput();
+    
+    /*! Blocks until the cloud with the given sequence number was integrated or dropped, or until the timeout is reached.
+     * @param sequence_nr Sequence number of the cloud.
+     * @param timeout Maximal time to wait.
+     * @return State of the cloud afterwards.
+     */
+    CloudState waitForIntegration( uint64_t sequence_nr, ros::Duration timeout = ros::Duration(60) );
     
     /*! Add a function that will be called after a new input was processed.
      * @param signal_call The function.
@@ -56,6 +104,42 @@ namespace octomap
     void addInputDoneSignalCall( boost::function<void()> signal_call );
     
   protected:
+    /*! Cloud waiting for integration.
+     */
+    struct QueuedCloud
+    {
+      EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+      
+      sensor_msgs::PointCloud2::ConstPtr cloud;
+      Eigen::Transform<double,3,Eigen::Affine> sensor_to_world; //! Sensor pose at the time the cloud was received.
+      uint64_t sequence_nr;
+    };
+    
+  protected:
+    /*! Assigns the next sequence number to a cloud and integrates it, either directly or by queueing it in asynchronous mode.
+     * @param cloud The cloud.
+     * @param queued (output) Whether the cloud was queued.
+     * @return The sequence number of the cloud.
+     */
+    uint64_t receiveCloud( const sensor_msgs::PointCloud2::ConstPtr& cloud, bool& queued );
+    
+    /*! Main loop of the integration thread.
+     */
+    void integrationLoop();
+    
+    /*! Integrates a cloud, records its state and publishes its sequence number.
+     * @param queued_cloud Cloud, pose and sequence number.
+     */
+    void integrate( QueuedCloud& queued_cloud );
+    
+    /*! Records the state of a cloud and wakes up waiting threads. Expects the queue mutex to be locked.
+     */
+    void setState( uint64_t sequence_nr, CloudState state );
+    
+    /*! Publishes the sequence numbers of dropped clouds on "pcl_input_dropped".
+     */
+    void publishDropped( const std::vector<uint64_t>& sequence_nrs );
+    
     /*! Pcl input topic listener.
      */
     void insertCloudCallback(const sensor_msgs::PointCloud2::ConstPtr& cloud);
@@ -68,13 +152,31 @@ namespace octomap
      */
     void issueInputDoneSignals();
     
-    /*! Inserts a cloud by reference and calls issueInputDoneSignals when done.
+    /*! Inserts a cloud message and calls issueInputDoneSignals when done. The points are read directly from the message buffer if the
+     * input supports it and the message has float32 xyz fields in host byte order, else it is converted to POINTCLOUD_TYPE first.
+     * @param cloud The cloud.
+     * @param sensor_to_world Sensor pose at which the cloud was taken.
+     */
+    void insertCloud( const sensor_msgs::PointCloud2& cloud, const Eigen::Transform<double,3,Eigen::Affine>& sensor_to_world );
+    
+    /*! Looks up the transform from the given frame to the world frame.
+     * @param frame_id Sensor frame.
+     * @param sensor_to_world (output) Transform.
+     * @return False if the lookup failed.
      */
-    void insertCloud( POINTCLOUD_TYPE& pointcloud );
+    bool lookupSensorToWorld( const std::string& frame_id, Eigen::Transform<double,3,Eigen::Affine>& sensor_to_world );
+    
+    /*! Fills a raw point buffer view with the fields of a cloud message.
+     * @param cloud Message.
+     * @param raw_cloud (output) View on the message data.
+     * @return False if the message has no float32 xyz fields in host byte order.
+     */
+    static bool getRawPointCloud( const sensor_msgs::PointCloud2& cloud, RawPointCloud& raw_cloud );
     
   private:
     ros::NodeHandle nh_;
     boost::shared_ptr< PclInput<TREE_TYPE,POINTCLOUD_TYPE> > pcl_input_;
+    Config config_;
     
     std::string world_frame_name_;
     
@@ -82,8 +184,19 @@ namespace octomap
     
     ros::Subscriber pcl_subscriber_;
     ros::ServiceServer pcl_input_service_;
+    ros::Publisher integrated_publisher_;
+    ros::Publisher dropped_publisher_;
     
     tf::TransformListener tf_listener_;
+    
+    boost::mutex queue_mutex_; //! Protects the queue, the sequence numbers and the states.
+    boost::condition_variable queue_changed_; //! Notified when clouds are queued or the integration thread shall stop.
+    boost::condition_variable state_changed_; //! Notified when clouds were integrated or dropped.
+    std::deque< QueuedCloud, Eigen::aligned_allocator<QueuedCloud> > queue_;
+    uint64_t next_sequence_nr_;
+    std::map<uint64_t,CloudState> states_; //! States of the most recent clouds.
+    bool shutdown_;
+    boost::thread integration_thread_;
   };
 }
 
@@ -0,0 +1,167 @@
+/* Copyright (c) 2016, Stefan Isler, islerstefan@bluewin.ch
+ * (ETH Zurich / Robotics and Perception Group, University of Zurich, Switzerland)
+ *
+ * This file is part of ig_active_reconstruction, software for information gain based, active reconstruction.
+ *
+ * ig_active_reconstruction is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * ig_active_reconstruction is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ * Please refer to the GNU Lesser General Public License for details on the license,
+ * on <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <boost/fusion/include/for_each.hpp>
+
+#include "ig_active_reconstruction_octomap/octomap_basic_ray_ig_calculator.hpp"
+
+namespace ig_active_reconstruction
+{
+  
+namespace world_representation
+{
+  
+namespace octomap
+{  
+  /*! Ray casting information gain calculator for a set of metrics that is fixed at compile time. The metric types are known,
+   * such that all metric updates are dispatched statically (and can be inlined) and the occupancy and entropy of each traversed
+   * voxel are calculated only once for all metrics. The metrics of the set are registered in the factory on construction,
+   * in the order of the set. Requests for metrics that were registered additionally are evaluated by the (dynamic)
+   * BasicRayIgCalculator.
+   * 
+   * Example:
+   * typedef boost::fusion::vector< OcclusionAwareIg<IgTree>, UnobservedVoxelIg<IgTree> > MetricSet;
+   * StaticRayIgCalculator<IgTree,MetricSet>::Ptr calculator = boost::make_shared< StaticRayIgCalculator<IgTree,MetricSet> >(config);
+   * 
+   * @tparam TREE_TYPE Octree type.
+   * @tparam METRIC_SET boost::fusion sequence of information gain types, each of which is constructible from InformationGain<TREE_TYPE>::Config.
+   */
+  template<class TREE_TYPE, class METRIC_SET>
+  class StaticRayIgCalculator: public BasicRayIgCalculator<TREE_TYPE>
+  {
+  public:
+    typedef boost::shared_ptr< StaticRayIgCalculator<TREE_TYPE,METRIC_SET> > Ptr;
+    typedef METRIC_SET MetricSet;
+    
+    typedef typename BasicRayIgCalculator<TREE_TYPE>::ResultInformation ResultInformation;
+    typedef typename BasicRayIgCalculator<TREE_TYPE>::IgRetrievalCommand IgRetrievalCommand;
+    typedef typename BasicRayIgCalculator<TREE_TYPE>::IgRetrievalResult IgRetrievalResult;
+    typedef typename BasicRayIgCalculator<TREE_TYPE>::ViewIgRetrievalResult ViewIgRetrievalResult;
+    typedef typename BasicRayIgCalculator<TREE_TYPE>::RayCastSettings RayCastSettings;
+    
+    typedef typename BasicRayIgCalculator<TREE_TYPE>::Config Config; //! Its ig_config configures all metrics of the set.
+    
+  public:
+    /*! Constructor, registers the metrics of the set.
+     */
+    StaticRayIgCalculator( Config config = Config() );
+    
+    virtual ~StaticRayIgCalculator(){};
+    
+  // Interface implementation
+  public:
+    /*! Calculates a set of information gains for a given view.
+     * @param command Specifies which information gains have to be calculated and for which pose along with further parameters that define how the ig('s) will be collected.
+     * @param output_ig (Output) Vector with the results of the information gain calculation. The indices correspond to the indices of the names in the metric_names array within the passed command.
+     */
+    virtual ResultInformation computeViewIg(IgRetrievalCommand& command, ViewIgRetrievalResult& output_ig);
+    
+  protected:
+    /*! Voxel sink that calculates the voxel data once and passes it to all metrics of a set.
+     */
+    class MetricSetSink
+    {
+    public:
+      MetricSetSink( METRIC_SET& metrics, typename InformationGain<TREE_TYPE>::Utils& utils ):metrics_(metrics), utils_(utils){};
+      
+      void startRay();
+      void includeRayMeasurement( typename TREE_TYPE::NodeType* node );
+      void includeEndPointMeasurement( typename TREE_TYPE::NodeType* node );
+      void informAboutVoidRay();
+      
+    private:
+      METRIC_SET& metrics_;
+      typename InformationGain<TREE_TYPE>::Utils& utils_;
+    };
+    
+    /*! Evaluates a consecutive range of rays on a metric set. Executed as task by the worker pool. Rays with a weight above one
+     * are evaluated on a scratch metric set, which is merged with the weight as factor.
+     * @param rays Set of rays.
+     * @param ray_weights Weights of the rays, empty if all are one.
+     * @param first Index of the first ray to evaluate.
+     * @param last Index of the last ray + 1.
+     * @param setting Additional ray casting settings.
+     * @param ig_config Information gain configuration, including the lookup table.
+     * @param metrics (output) Metrics in which the information of the rays is accumulated.
+     */
+    void calculateIgsOnRays( const RayCaster::RayBatch* rays, const std::vector<unsigned int>* ray_weights, size_t first, size_t last, RayCastSettings setting, const typename InformationGain<TREE_TYPE>::Config* ig_config, METRIC_SET* metrics );
+    
+    /*! Creates a metric for the factory.
+     */
+    template<class IG_METRIC_TYPE>
+    boost::shared_ptr< InformationGain<TREE_TYPE> > makeShared( typename InformationGain<TREE_TYPE>::Config utils );
+    
+  protected:
+    // Functors applied to all metrics of a set.
+    struct Register
+    {
+      Register( StaticRayIgCalculator<TREE_TYPE,METRIC_SET>* calculator ):calculator(calculator){};
+      template<class IG_METRIC_TYPE> void operator()( IG_METRIC_TYPE& metric ) const;
+      StaticRayIgCalculator<TREE_TYPE,METRIC_SET>* calculator;
+    };
+    struct Configure
+    {
+      Configure( typename InformationGain<TREE_TYPE>::Config& config ):config(config){};
+      template<class IG_METRIC_TYPE> void operator()( IG_METRIC_TYPE& metric ) const{ metric = IG_METRIC_TYPE(config); };
+      typename InformationGain<TREE_TYPE>::Config& config;
+    };
+    struct SetOctree
+    {
+      SetOctree( const TREE_TYPE* octree ):octree(octree){};
+      template<class IG_METRIC_TYPE> void operator()( IG_METRIC_TYPE& metric ) const{ metric.setOctree(octree); };
+      const TREE_TYPE* octree;
+    };
+    struct MakeReadyForNewRay
+    {
+      template<class IG_METRIC_TYPE> void operator()( IG_METRIC_TYPE& metric ) const{ metric.makeReadyForNewRay(); };
+    };
+    struct IncludeRayMeasurement
+    {
+      IncludeRayMeasurement( const typename InformationGain<TREE_TYPE>::Voxel& voxel ):voxel(voxel){};
+      template<class IG_METRIC_TYPE> void operator()( IG_METRIC_TYPE& metric ) const{ metric.includeRayMeasurement(voxel); };
+      const typename InformationGain<TREE_TYPE>::Voxel& voxel;
+    };
+    struct IncludeEndPointMeasurement
+    {
+      IncludeEndPointMeasurement( const typename InformationGain<TREE_TYPE>::Voxel& voxel ):voxel(voxel){};
+      template<class IG_METRIC_TYPE> void operator()( IG_METRIC_TYPE& metric ) const{ metric.includeEndPointMeasurement(voxel); };
+      const typename InformationGain<TREE_TYPE>::Voxel& voxel;
+    };
+    struct InformAboutVoidRay
+    {
+      template<class IG_METRIC_TYPE> void operator()( IG_METRIC_TYPE& metric ) const{ metric.informAboutVoidRay(); };
+    };
+    struct Collect
+    {
+      Collect( std::vector< InformationGain<TREE_TYPE>* >& metrics ):metrics(metrics){};
+      template<class IG_METRIC_TYPE> void operator()( IG_METRIC_TYPE& metric ) const{ metrics.push_back(&metric); };
+      std::vector< InformationGain<TREE_TYPE>* >& metrics;
+    };
+    
+  protected:
+    typename InformationGain<TREE_TYPE>::Config ig_config_; //! Configuration of the metrics.
+    unsigned int nr_of_static_metrics_; //! Number of metrics in the set, their factory ids are [0,nr_of_static_metrics_).
+  };
+}
+
+}
+
+}
+
+#include "../src/code_base/octomap_static_ray_ig_calculator.inl"
\ No newline at end of file
@@ -0,0 +1,59 @@
+/* Copyright (c) 2016, Stefan Isler, islerstefan@bluewin.ch
+ * (ETH Zurich / Robotics and Perception Group, University of Zurich, Switzerland)
+ *
+ * This file is part of ig_active_reconstruction, software for information gain based, active reconstruction.
+ *
+ * ig_active_reconstruction is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * ig_active_reconstruction is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ * Please refer to the GNU Lesser General Public License for details on the license,
+ * on <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <boost/fusion/include/vector.hpp>
+
+#include "ig_active_reconstruction_octomap/octomap_static_ray_ig_calculator.hpp"
+#include "ig_active_reconstruction_octomap/ig/occlusion_aware.hpp"
+#include "ig_active_reconstruction_octomap/ig/unobserved_voxel.hpp"
+#include "ig_active_reconstruction_octomap/ig/rear_side_voxel.hpp"
+#include "ig_active_reconstruction_octomap/ig/rear_side_entropy.hpp"
+#include "ig_active_reconstruction_octomap/ig/proximity_count.hpp"
+#include "ig_active_reconstruction_octomap/ig/vasquez_gomez_area_factor.hpp"
+#include "ig_active_reconstruction_octomap/ig/average_entropy.hpp"
+
+namespace ig_active_reconstruction
+{
+  
+namespace world_representation
+{
+
+namespace octomap
+{
+  // (cpp03 version...) StaticRayIgCalculator with all available metrics, registered in the same order as in the octomap_world_representation node.
+  template<class TREE_TYPE>
+  struct StaticRayIgCalculatorAllMetrics
+  {
+    typedef boost::fusion::vector7< OcclusionAwareIg<TREE_TYPE>,
+				    UnobservedVoxelIg<TREE_TYPE>,
+				    RearSideVoxelIg<TREE_TYPE>,
+				    RearSideEntropyIg<TREE_TYPE>,
+				    ProximityCountIg<TREE_TYPE>,
+				    VasquezGomezAreaFactorIg<TREE_TYPE>,
+				    AverageEntropyIg<TREE_TYPE> > MetricSet;
+    typedef TREE_TYPE TreeType;
+    typedef StaticRayIgCalculator< TreeType, MetricSet > Type;
+    typedef boost::shared_ptr< StaticRayIgCalculator< TreeType, MetricSet > > Ptr;
+  };
+  
+}
+
+}
+
+}
\ No newline at end of file
@@ -22,6 +22,7 @@
 #include <Eigen/Geometry>
 
 #include "ig_active_reconstruction_octomap/octomap_pcl_input.hpp"
+#include "ig_active_reconstruction/worker_pool.hpp"
 
 namespace ig_active_reconstruction
 {
@@ -54,6 +55,10 @@ namespace octomap
       ::octomap::point3d bounding_box_min_point_m; //! Defines bounding box minimum. Points with smaller coordinates are discarded, default: lowest double possible [m].
       ::octomap::point3d bounding_box_max_point_m; //! Defines bounding box maximum. Points with larger coordinates are discarded, default: largest double possible [m].
       double max_sensor_range_m; //! Maximal range for integrating sensor data [m]. Anything exceeding this distance will be dropped. For negative values, it is ignored. Default: -1.
+      unsigned int nr_of_threads; //! Number of threads that compute the key rays of a pointcloud, including the calling one. 0: One per hardware core, 1: Serial computation without worker pool. Default: 0.
+      unsigned int points_per_chunk; //! Number of points whose key rays are computed as one task by the worker pool. At most two chunks per thread are held in memory at once. Default: 10000.
+      bool bin_points_by_voxel; //! If true, the points are binned by the voxel they fall into and only one ray per voxel is cast. Trades insertion fidelity for a much smaller number of rays for dense clouds. Default: false.
+      bool cast_rays_to_centroids; //! Only used if bin_points_by_voxel is true. If true, the ray of a voxel is cast to the centroid of its points, else to its first point. Default: false.
     };
     
   public:
@@ -73,8 +78,71 @@ namespace octomap
      */
     virtual void push( const Eigen::Transform<double,3,Eigen::Affine>& sensor_to_world, POINTCLOUD_TYPE& pcl );
     
+    /*! Inserts a new pointcloud from a raw point buffer. Transformation, bounding box and NAN filtering are done in a single pass
+     * over the buffer which only copies the valid points, i.e. without the intermediate clouds of push(). If an occlusion calculator
+     * was set, it is called at the end.
+     * 
+     * @param sensor_to_world Transform from sensor to world coordinates.
+     * @param pcl The points that are to be inserted, in sensor coordinates. Not altered.
+     * @return True.
+     */
+    virtual bool pushRaw( const Eigen::Transform<double,3,Eigen::Affine>& sensor_to_world, const RawPointCloud& pcl );
+    
+  protected:
+    /*! Integrates filtered points into the octree and calls the occlusion calculator if one was set.
+     * @param sensor_position Sensor position in world coordinates.
+     * @param pc_cpy Pointcloud in world coordinates, may be replaced.
+     * @param valid_indices Indices of the points in pc_cpy that are to be integrated, may be altered.
+     */
+    void integrate( const Eigen::Vector3d& sensor_position, typename POINTCLOUD_TYPE::Ptr pc_cpy, std::vector<int>& valid_indices );
+    
+    /*! Lets the occlusion calculator prepare its update. Executed as task by the worker pool, concurrently to the key computation.
+     * @param sensor_position Sensor position in world coordinates.
+     * @param pc Pointcloud (world coordinates).
+     * @param indices Indices of the valid points within the pointcloud.
+     * @param update (output) Prepared update, NULL if the occlusion calculator doesn't support preparation.
+     */
+    void prepareOcclusions( const Eigen::Vector3d* sensor_position, const POINTCLOUD_TYPE* pc, std::vector<int>* indices, boost::shared_ptr<typename OcclusionCalculator<TREE_TYPE,POINTCLOUD_TYPE>::PreparedUpdate>* update );
+    
+    /*! Points falling into the same voxel.
+     */
+    struct VoxelBin
+    {
+      int first_index; //! Index of the first point within the bin.
+      double x, y, z; //! Sum of the point coordinates.
+      unsigned int nr_of_points;
+    };
+    
+    /*! Replaces the valid points of a pointcloud by one representative point per voxel (the first point of the voxel or the centroid
+     * of its points, see Config). Points outside the octree's key range are kept as they are.
+     * @param pc (input/output) Pointcloud (world coordinates). Replaced by the representative points.
+     * @param indices (input/output) Indices of the valid points within the pointcloud. Replaced by the indices of all representative points.
+     */
+    void binPointsByVoxel( typename POINTCLOUD_TYPE::Ptr& pc, std::vector<int>& indices );
+    
+    /*! Keys of the cells traversed by the rays of a consecutive range of points.
+     */
+    struct KeyChunk
+    {
+      std::vector< ::octomap::OcTreeKey > free_cells; //! Keys of the free cells of all rays, ray after ray.
+      std::vector<size_t> ray_ends; //! End index of each ray's keys in free_cells.
+      std::vector< ::octomap::OcTreeKey > occupied_cells; //! Keys of occupied cells, each once, in the order of their first occurrence.
+    };
+    
+    /*! Computes the keys of the free and occupied cells for a range of points. Executed as task by the worker pool, only depends
+     * on the geometry of the octree.
+     * @param sensor_origin Sensor position.
+     * @param pc Pointcloud (world coordinates).
+     * @param indices Indices of the valid points within the pointcloud.
+     * @param first Index of the first index to process.
+     * @param last Index of the last index to process + 1.
+     * @param chunk (output) Keys of the range.
+     */
+    void computeKeys( const ::octomap::point3d* sensor_origin, const POINTCLOUD_TYPE* pc, const std::vector<int>* indices, size_t first, size_t last, KeyChunk* chunk );
+    
   protected:
     Config config_;
+    boost::shared_ptr<WorkerPool> worker_pool_; //! Threads that compute key rays, NULL if they are computed serially.
   };
   
 }
@@ -0,0 +1,266 @@
+/* Copyright (c) 2016, Stefan Isler, islerstefan@bluewin.ch
+ * (ETH Zurich / Robotics and Perception Group, University of Zurich, Switzerland)
+ *
+ * This file is part of ig_active_reconstruction, software for information gain based, active reconstruction.
+ *
+ * ig_active_reconstruction is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * ig_active_reconstruction is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ * Please refer to the GNU Lesser General Public License for details on the license,
+ * on <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <boost/unordered_map.hpp>
+#include <boost/cstdint.hpp>
+
+#include <octomap/octomap_types.h>
+#include <octomap/OcTreeKey.h>
+
+#include "ig_active_reconstruction_octomap/octomap_ig_tree.hpp"
+#include "ig_active_reconstruction_octomap/octomap_voxel_block_map_node.hpp"
+#include "ig_active_reconstruction_octomap/octomap_node_lookup.hpp"
+
+namespace ig_active_reconstruction
+{
+  
+namespace world_representation
+{
+
+namespace octomap
+{
+  
+  /*! Occupancy map storing the leaf voxels densely in blocks of 8x8x8 voxels, which are kept in a hash map indexed by the block
+   * coordinates. A voxel is found with a single hash lookup and neighbouring voxels lie next to each other in memory, whereas an
+   * octree descends through all of its levels. Keys, coordinates and the occupancy update rules are the same as for the IgTree,
+   * such that the map can be used in place of it as TREE_TYPE for the WorldRepresentation, the inputs and the ray casting based
+   * information gain calculators.
+   *
+   * There is no hierarchy and voxels are never pruned: The map uses more memory than the IgTree for large homogeneous regions,
+   * searches above the leaf level (e.g. for the hierarchical information gain calculation) find nothing and the ProjectionIgCalculator,
+   * which walks the octree, is not supported.
+   */
+  class VoxelBlockMap
+  {
+  public:
+    typedef VoxelBlockMapNode NodeType;
+    typedef IgTree::Config Config; //! Same configuration as the IgTree.
+    
+    enum
+    {
+      BLOCK_BITS = 3, //! Number of key bits addressing the voxels within a block, along each axis.
+      BLOCK_WIDTH = 1<<BLOCK_BITS, //! Number of voxels of a block along each axis.
+      BLOCK_VOLUME = BLOCK_WIDTH*BLOCK_WIDTH*BLOCK_WIDTH //! Number of voxels of a block.
+    };
+    
+    /*! Dense block of voxels.
+     */
+    struct Block
+    {
+      Block( const ::octomap::OcTreeKey& origin_key ):origin(origin_key),nr_of_known_voxels(0){};
+      
+      ::octomap::OcTreeKey origin; //! Key of the first voxel of the block.
+      unsigned int nr_of_known_voxels; //! Number of voxels in the block that were updated so far.
+      NodeType voxels[BLOCK_VOLUME]; //! Voxels, x varies fastest.
+    };
+    
+    typedef boost::unordered_map<uint64_t,Block*> BlockMap;
+    
+    /*! Iterates over all known voxels, similar to the octree leaf iterators.
+     */
+    class iterator
+    {
+    public:
+      iterator():map_(NULL),voxel_(0){};
+      
+      iterator& operator++();
+      bool operator==( const iterator& rhs ) const;
+      bool operator!=( const iterator& rhs ) const;
+      NodeType& operator*() const;
+      NodeType* operator->() const;
+      
+      ::octomap::OcTreeKey getKey() const;
+      ::octomap::point3d getCoordinate() const;
+      double getX() const;
+      double getY() const;
+      double getZ() const;
+      double getSize() const;
+      unsigned int getDepth() const;
+      
+    protected:
+      friend class VoxelBlockMap;
+      
+      iterator( const VoxelBlockMap* map, BlockMap::const_iterator block );
+      
+      /*! Advances to the next known voxel, starting at the current position.
+       */
+      void skipUnknown();
+      
+    protected:
+      const VoxelBlockMap* map_;
+      BlockMap::const_iterator block_;
+      unsigned int voxel_; //! Index of the current voxel within the current block.
+    };
+    
+  public:
+    //! Default constructor, sets resolution of leafs
+    VoxelBlockMap(double resolution_m);
+    
+    /*! Constructor with complete configuration
+     */
+    VoxelBlockMap(Config config);
+    
+    /*! Deep copy constructor, copies all blocks and the configuration.
+     */
+    VoxelBlockMap(const VoxelBlockMap& rhs);
+    
+    ~VoxelBlockMap();
+    
+    /*! Returns the current configuration.
+     */
+    const Config& config() const;
+    
+    /*! Deletes all voxels.
+     */
+    void clear();
+    
+    /*! Returns the number of known voxels.
+     */
+    size_t size() const;
+    
+    /*! Returns the number of allocated blocks.
+     */
+    size_t getNumberOfBlocks() const;
+    
+    // -- key geometry, same as for the IgTree  ----------------------------
+    
+    double getResolution() const;
+    unsigned int getTreeDepth() const;
+    double getNodeSize( unsigned int depth ) const;
+    
+    ::octomap::OcTreeKey coordToKey( const ::octomap::point3d& coord ) const;
+    bool coordToKeyChecked( const ::octomap::point3d& coord, ::octomap::OcTreeKey& key ) const;
+    double keyToCoord( ::octomap::key_type key ) const;
+    ::octomap::point3d keyToCoord( const ::octomap::OcTreeKey& key ) const;
+    bool computeRayKeys( const ::octomap::point3d& origin, const ::octomap::point3d& end, ::octomap::KeyRay& ray ) const;
+    
+    // -- voxels  ----------------------------
+    
+    /*! Returns the voxel with the given key, NULL if it is unknown.
+     * @param key Key of the voxel.
+     * @param depth Search depth. Only leaf voxels exist: NULL is returned for depths above the leaf level (0 means leaf level).
+     */
+    NodeType* search( const ::octomap::OcTreeKey& key, unsigned int depth = 0 ) const;
+    NodeType* search( const ::octomap::point3d& coord, unsigned int depth = 0 ) const;
+    
+    /*! Integrates an occupancy measurement, as for octomap::OccupancyOcTreeBase. Unknown voxels are created.
+     * @return The updated voxel, NULL if the coordinate is outside of the map.
+     */
+    NodeType* updateNode( const ::octomap::OcTreeKey& key, bool occupied );
+    NodeType* updateNode( const ::octomap::point3d& coord, bool occupied );
+    
+    /*! Adds a log odds update to a voxel, clamped to the clamping thresholds. Unknown voxels are created.
+     */
+    NodeType* updateNode( const ::octomap::OcTreeKey& key, float log_odds_update );
+    
+    bool isNodeOccupied( const NodeType* node ) const;
+    bool isNodeOccupied( const NodeType& node ) const;
+    
+    /*! Returns the maximal occlusion update distance that was used when the occlusion distance of a node was registered.
+     */
+    double maxDist( NodeType* node ) const{ return node->maxDist(); };
+    
+    /*! Sets the maximal occlusion update distance used when registering the occlusion distance of a node.
+     */
+    void setMaxDist( NodeType* node, double max_dist ){ node->setMaxDist(max_dist); };
+    
+    iterator begin() const;
+    iterator end() const;
+    
+    // -- blocks  ----------------------------
+    
+    /*! Returns the hash map key of the block containing the voxel with the given key.
+     */
+    static inline uint64_t blockKey( const ::octomap::OcTreeKey& key )
+    {
+      return uint64_t(key[0]>>BLOCK_BITS) | (uint64_t(key[1]>>BLOCK_BITS)<<16) | (uint64_t(key[2]>>BLOCK_BITS)<<32);
+    }
+    
+    /*! Returns the index of the voxel with the given key within its block.
+     */
+    static inline unsigned int voxelIndex( const ::octomap::OcTreeKey& key )
+    {
+      const unsigned int mask = BLOCK_WIDTH-1;
+      return (key[0]&mask) | ((key[1]&mask)<<BLOCK_BITS) | ((key[2]&mask)<<(2*BLOCK_BITS));
+    }
+    
+    /*! Returns the block with the given block key, NULL if it doesn't exist.
+     */
+    Block* searchBlock( uint64_t block_key ) const;
+    
+  protected:
+    /*! Returns the voxel with the given key, creating it and its block if needed.
+     */
+    NodeType* createVoxel( const ::octomap::OcTreeKey& key );
+    
+    /*! Computes the log odds thresholds based on the current configuration.
+     */
+    void updateMapConfig();
+    
+  private:
+    VoxelBlockMap& operator=( const VoxelBlockMap& rhs ); //! Not implemented.
+    
+  protected:
+    Config config_;
+    IgTree geometry_; //! Empty tree with the same resolution, used for the conversions between keys and coordinates.
+    
+    float occupancy_threshold_log_;
+    float hit_log_;
+    float miss_log_;
+    float clamping_threshold_min_log_;
+    float clamping_threshold_max_log_;
+    
+    BlockMap blocks_;
+    size_t nr_of_known_voxels_;
+  };
+  
+  
+  /*! Lookup of neighbouring keys in the VoxelBlockMap: The block of the previous search is kept, such that consecutive keys within
+   * the same block (most of the voxels along a ray) are found without a hash lookup.
+   */
+  template<>
+  class NodeLookup<VoxelBlockMap>
+  {
+  public:
+    typedef VoxelBlockMap::NodeType NodeType;
+    
+  public:
+    /*! Constructor.
+     * @param map Map in which is searched.
+     */
+    NodeLookup( const VoxelBlockMap& map );
+    
+    /*! Returns the voxel with the given key, NULL if it is unknown or if the depth is above the leaf level.
+     * @param key Key to search.
+     * @param depth Depth at which the search stops, 0 for the leaf level.
+     */
+    NodeType* search( const ::octomap::OcTreeKey& key, unsigned int depth = 0 );
+    
+  private:
+    const VoxelBlockMap& map_;
+    VoxelBlockMap::Block* block_; //! Block of the previous search, NULL if it doesn't exist.
+    uint64_t block_key_; //! Block key of the previous search.
+    bool has_previous_; //! Whether there was a previous search.
+  };
+  
+}
+
+}
+
+}
\ No newline at end of file
@@ -17,6 +17,16 @@
 
 #pragma once
 
+#include <boost/shared_ptr.hpp>
+#include <boost/make_shared.hpp>
+#include <boost/thread/shared_mutex.hpp>
+#include <boost/thread/locks.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread_time.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <stdint.h>
+
 namespace ig_active_reconstruction
 {
   
@@ -36,11 +46,98 @@ namespace octomap
     //! Make tree type available
     typedef TREE_TYPE TreeType;
     
+    //! Lock for read-only access to the octree, multiple readers may hold it at the same time.
+    typedef boost::shared_lock<boost::shared_mutex> ReadLock;
+    //! Lock for modifications of the octree, excludes all readers and other writers.
+    typedef boost::unique_lock<boost::shared_mutex> WriteLock;
+    
+    /*! Read-only copies of the octree that are published by inputs after completed insertions. Consumers that only read
+     * pin the current snapshot and don't need to lock the octree at all, such that they are never blocked by ongoing insertions.
+     * Every snapshot is a deep copy of the whole octree, which takes time linear in the map size. While a new snapshot is taken
+     * and readers still hold older ones, up to four octrees can be in memory at once. Snapshots can thus be rate-limited or disabled.
+     * Copies are only ever taken on the publishing side (by the inserting thread or, for rate-limited snapshots, by a publisher
+     * thread), never by readers.
+     */
+    class Snapshots
+    {
+    public:
+      struct Config
+      {
+      public:
+	/*! Constructor sets default values.
+	 */
+	Config();
+	
+      public:
+	bool enabled; //! If false, no snapshots are taken and readers lock the octree instead. Default: true.
+	double min_interval_s; //! Minimal time between two snapshots taken after insertions [s]. Insertions within the interval are published by the publisher thread once the interval elapsed, readers see them with at most this delay. 0: A snapshot is taken after every insertion. Default: 0.
+      };
+      
+    public:
+      /*! Constructor. If the octree and its mutex are given, snapshots are enabled and rate-limited, a publisher thread takes the
+       * snapshots of insertions that were held back by the rate limit.
+       * @param config Configuration.
+       * @param octree Octree of which snapshots are taken.
+       * @param octree_mutex Mutex guarding the octree.
+       */
+      Snapshots( Config config = Config(), boost::shared_ptr<const TREE_TYPE> octree = boost::shared_ptr<const TREE_TYPE>(), boost::shared_ptr<boost::shared_mutex> octree_mutex = boost::shared_ptr<boost::shared_mutex>() );
+      
+      /*! Stops the publisher thread.
+       */
+      ~Snapshots();
+      
+      /*! Returns the most recently published snapshot or NULL if none was published so far or snapshots are disabled. It stays
+       * valid as long as the returned pointer is held, even if newer snapshots are published in the meantime.
+       */
+      boost::shared_ptr<const TREE_TYPE> current();
+      
+      /*! Returns the version of the current snapshot, 0 if none was published so far.
+       */
+      uint64_t version();
+      
+      /*! Publishes a deep copy of the given octree as new snapshot, unless snapshots are disabled or the last one is more recent
+       * than the minimal interval, in which case the publisher thread publishes the modification once the interval elapsed.
+       * Called after modifications, the caller must hold at least a ReadLock on the octree.
+       * @param octree Octree of which a snapshot is taken.
+       */
+      void publish( const TREE_TYPE& octree );
+      
+    private:
+      /*! Takes a deep copy of the octree and makes it the current snapshot if there are unpublished modifications. Concurrent
+       * calls are serialized, such that a modification is copied only once. The caller must hold at least a ReadLock on the octree.
+       */
+      void take( const TREE_TYPE& octree );
+      
+      /*! Publisher thread: Takes the snapshots that were held back by the rate limit, as soon as the interval elapsed.
+       */
+      void publishHeldBack();
+      
+    private:
+      Config config_; //! Configuration.
+      boost::shared_ptr<const TREE_TYPE> octree_; //! Octree of which the publisher thread takes snapshots, NULL if there is none.
+      boost::shared_ptr<boost::shared_mutex> octree_mutex_; //! Mutex guarding the octree.
+      boost::mutex take_mutex_; //! Serializes taking snapshots.
+      boost::mutex mutex_; //! Guards the current snapshot and the publishing state, never held while copying.
+      boost::condition_variable pending_condition_; //! Wakes the publisher thread if modifications are held back or it shall stop.
+      boost::shared_ptr<const TREE_TYPE> current_; //! Current snapshot.
+      uint64_t version_; //! Incremented with each published snapshot.
+      boost::system_time last_publish_time_; //! Time at which the current snapshot was taken.
+      bool pending_; //! True if the octree was modified since the current snapshot was taken.
+      bool stop_; //! Tells the publisher thread to stop.
+      boost::thread publisher_; //! Publisher thread, only running for rate-limited snapshots.
+    };
+    
     /*! The link structure is used to link objects with the octomap world representation.
+     * Linked objects must hold a ReadLock on the octree_mutex while accessing the octree and a WriteLock while modifying it.
+     * Objects that modify the octree should publish a new snapshot once they're done.
      */
     struct Link
     {
+      Link():octree_mutex( boost::make_shared<boost::shared_mutex>() ), snapshots( boost::make_shared<Snapshots>() ){};
+      
       boost::shared_ptr<TREE_TYPE> octree;
+      boost::shared_ptr<boost::shared_mutex> octree_mutex; //! Synchronizes octree accesses among all objects linked to the same world representation.
+      boost::shared_ptr<Snapshots> snapshots; //! Read-only snapshots of the octree.
     };
     
     /*! Base class providing "link-functionality"
@@ -57,7 +154,11 @@ namespace octomap
     };
     
   public:
-    WorldRepresentation( typename TREE_TYPE::Config config = typename TREE_TYPE::Config() );
+    /*! Constructor.
+     * @param config Configuration of the octree.
+     * @param snapshot_config Configuration of the snapshots taken of the octree.
+     */
+    WorldRepresentation( typename TREE_TYPE::Config config = typename TREE_TYPE::Config(), typename Snapshots::Config snapshot_config = typename Snapshots::Config() );
     
     virtual ~WorldRepresentation();
     
@@ -111,6 +212,8 @@ namespace octomap
     
   protected:
     boost::shared_ptr<TREE_TYPE> octree_; //! Octomap tree instance.
+    boost::shared_ptr<boost::shared_mutex> octree_mutex_; //! Guards the octree, handed out through the links.
+    boost::shared_ptr<Snapshots> snapshots_; //! Snapshots of the octree, handed out through the links.
   };
   
 }
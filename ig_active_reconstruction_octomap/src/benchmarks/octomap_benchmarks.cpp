@@ -0,0 +1,671 @@
+/* Copyright (c) 2016, Stefan Isler, islerstefan@bluewin.ch
+ * (ETH Zurich / Robotics and Perception Group, University of Zurich, Switzerland)
+ *
+ * This file is part of ig_active_reconstruction, software for information gain based, active reconstruction.
+ *
+ * ig_active_reconstruction is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * ig_active_reconstruction is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ * Please refer to the GNU Lesser General Public License for details on the license,
+ * on <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <string>
+#include <vector>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <fstream>
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include <benchmark/benchmark.h>
+#include <octomap/AbstractOcTree.h>
+
+#include "ig_active_reconstruction/view_space.hpp"
+
+#include "ig_active_reconstruction_octomap/octomap_ig_tree_world_representation.hpp"
+#include "ig_active_reconstruction_octomap/octomap_basic_ray_ig_calculator.hpp"
+#include "ig_active_reconstruction_octomap/octomap_std_pcl_input_point_xyz.hpp"
+#include "ig_active_reconstruction_octomap/octomap_ray_occlusion_calculator.hpp"
+#include "ig_active_reconstruction_octomap/ig/occlusion_aware.hpp"
+#include "ig_active_reconstruction_octomap/ig/unobserved_voxel.hpp"
+#include "ig_active_reconstruction_octomap/ig/rear_side_voxel.hpp"
+#include "ig_active_reconstruction_octomap/ig/rear_side_entropy.hpp"
+#include "ig_active_reconstruction_octomap/ig/proximity_count.hpp"
+#include "ig_active_reconstruction_octomap/ig/vasquez_gomez_area_factor.hpp"
+#include "ig_active_reconstruction_octomap/ig/average_entropy.hpp"
+
+/*! Benchmarks of the information gain calculation, the point cloud insertion and the view space. They run without ROS master.
+ * 
+ * Usage:
+ * octomap_benchmarks [--map=<recorded IgTree map, .ot or .bt>] [google benchmark options]
+ * 
+ * Machine-readable results are written with e.g. --benchmark_out=results.json --benchmark_out_format=json. Besides the timings,
+ * each benchmark reports throughput counters (rays/s, voxels/s, points/s or views/s) and the peak resident set size of the
+ * process so far [kB].
+ */
+
+namespace iar = ig_active_reconstruction;
+using namespace iar::world_representation::octomap;
+
+typedef IgTreeWorldRepresentation World;
+typedef World::TreeType TreeType;
+typedef StdPclInputPointXYZ<TreeType>::PclType PclType;
+
+namespace
+{
+  std::string recorded_map_path; //! Set through --map=<path>.
+  
+  /*! Peak resident set size of the process [kB].
+   */
+  double peakRssKb()
+  {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF,&usage);
+    return usage.ru_maxrss;
+  }
+  
+  /*! Current resident set size of the process [kB].
+   */
+  double currentRssKb()
+  {
+    std::ifstream statm("/proc/self/statm");
+    double size_pages = 0, resident_pages = 0;
+    statm>>size_pages>>resident_pages;
+    return resident_pages*sysconf(_SC_PAGESIZE)/1024.0;
+  }
+  
+  /*! Gives access to the octree of a world representation.
+   */
+  template<class TREE_TYPE>
+  class OctreeAccess: public WorldRepresentation<TREE_TYPE>::LinkedObject
+  {
+  public:
+    struct Config{};
+    
+    OctreeAccess( Config config = Config() ){};
+    
+    boost::shared_ptr<TREE_TYPE> octree(){ return this->link_.octree; };
+    
+    /*! Publishes the current octree as snapshot, needed after modifying it directly.
+     */
+    void publishSnapshot(){ this->link_.snapshots->publish(*this->link_.octree); };
+  };
+  
+  /*! Counts the rays cast for a view, such that throughput can be reported.
+   */
+  template<class TREE_TYPE>
+  class RayCountIg: public InformationGain<TREE_TYPE>
+  {
+  public:
+    typedef typename InformationGain<TREE_TYPE>::Utils Utils;
+    typedef typename InformationGain<TREE_TYPE>::Utils::Config Config;
+    typedef typename InformationGain<TREE_TYPE>::GainType GainType;
+    
+  public:
+    RayCountIg( Config config = Config() ):rays_(0),voxels_(0){};
+    
+    virtual std::string type(){ return "BenchmarkRayCount"; };
+    virtual GainType getInformation(){ return rays_; };
+    virtual void makeReadyForNewRay(){ ++rays_; };
+    virtual void reset(){ rays_=0; voxels_=0; };
+    virtual void includeRayMeasurement( typename TREE_TYPE::NodeType* node ){ ++voxels_; };
+    virtual void includeEndPointMeasurement( typename TREE_TYPE::NodeType* node ){ ++voxels_; };
+    virtual void informAboutVoidRay(){};
+    virtual uint64_t voxelCount(){ return voxels_; };
+    virtual void merge( const InformationGain<TREE_TYPE>& other, unsigned int weight=1 )
+    {
+      const RayCountIg<TREE_TYPE>& rhs = dynamic_cast<const RayCountIg<TREE_TYPE>&>(other);
+      rays_ += weight*rhs.rays_;
+      voxels_ += weight*rhs.voxels_;
+    };
+    
+  protected:
+    uint64_t rays_;
+    uint64_t voxels_;
+  };
+  
+  /*! Counts the voxels traversed for a view, such that throughput can be reported.
+   */
+  template<class TREE_TYPE>
+  class VoxelCountIg: public RayCountIg<TREE_TYPE>
+  {
+  public:
+    typedef typename RayCountIg<TREE_TYPE>::Utils Utils;
+    typedef typename RayCountIg<TREE_TYPE>::Config Config;
+    typedef typename RayCountIg<TREE_TYPE>::GainType GainType;
+    
+  public:
+    VoxelCountIg( Config config = Config() ):RayCountIg<TREE_TYPE>(config){};
+    
+    virtual std::string type(){ return "BenchmarkVoxelCount"; };
+    virtual GainType getInformation(){ return this->voxels_; };
+  };
+  
+  /*! Sensor looking from a position at the center of the synthetic scene.
+   */
+  Eigen::Transform<double,3,Eigen::Affine> sensorToWorld( double azimuth, double elevation, double distance )
+  {
+    Eigen::Vector3d target(0,0,0.15);
+    Eigen::Vector3d position = target + distance*Eigen::Vector3d( std::cos(elevation)*std::cos(azimuth), std::cos(elevation)*std::sin(azimuth), std::sin(elevation) );
+    
+    // camera frame: z forward, x right, y down
+    Eigen::Vector3d z = (target-position).normalized();
+    Eigen::Vector3d x = z.cross( Eigen::Vector3d::UnitZ() ).normalized();
+    Eigen::Vector3d y = z.cross(x);
+    
+    Eigen::Matrix3d rotation;
+    rotation.col(0) = x;
+    rotation.col(1) = y;
+    rotation.col(2) = z;
+    
+    Eigen::Transform<double,3,Eigen::Affine> sensor_to_world = Eigen::Transform<double,3,Eigen::Affine>::Identity();
+    sensor_to_world.linear() = rotation;
+    sensor_to_world.translation() = position;
+    return sensor_to_world;
+  }
+  
+  /*! Renders a depth image of the synthetic scene (a sphere and a box on a ground plane) as point cloud in the sensor frame.
+   * @param sensor_to_world Sensor pose.
+   * @param width Image width [px], the field of view is 60 deg horizontally.
+   * @param height Image height [px].
+   */
+  PclType syntheticCloud( const Eigen::Transform<double,3,Eigen::Affine>& sensor_to_world, unsigned int width, unsigned int height )
+  {
+    const Eigen::Vector3d sphere_center(0.1,0,0.2);
+    const double sphere_radius = 0.2;
+    const Eigen::Vector3d box_min(-0.45,-0.3,0);
+    const Eigen::Vector3d box_max(-0.15,0.1,0.3);
+    
+    double focal_length = 0.5*width/std::tan(M_PI/6);
+    Eigen::Vector3d origin = sensor_to_world.translation();
+    
+    PclType cloud;
+    cloud.reserve(width*height);
+    for( unsigned int v=0; v<height; ++v )
+    {
+      for( unsigned int u=0; u<width; ++u )
+      {
+	Eigen::Vector3d ray_sensor( (u-0.5*width)/focal_length, (v-0.5*height)/focal_length, 1 );
+	Eigen::Vector3d ray = sensor_to_world.linear()*ray_sensor;
+	double t = std::numeric_limits<double>::max();
+	
+	// ground plane
+	if( ray(2)<0 )
+	  t = -origin(2)/ray(2);
+	
+	// sphere
+	Eigen::Vector3d oc = origin-sphere_center;
+	double a = ray.dot(ray);
+	double b = 2*oc.dot(ray);
+	double c = oc.dot(oc)-sphere_radius*sphere_radius;
+	double discriminant = b*b-4*a*c;
+	if( discriminant>=0 )
+	{
+	  double t_sphere = (-b-std::sqrt(discriminant))/(2*a);
+	  if( t_sphere>0 && t_sphere<t )
+	    t = t_sphere;
+	}
+	
+	// box (slab method)
+	double t_near = 0, t_far = std::numeric_limits<double>::max();
+	for( unsigned int i=0; i<3; ++i )
+	{
+	  double t0 = (box_min(i)-origin(i))/ray(i);
+	  double t1 = (box_max(i)-origin(i))/ray(i);
+	  t_near = std::max( t_near, std::min(t0,t1) );
+	  t_far = std::min( t_far, std::max(t0,t1) );
+	}
+	if( t_near<=t_far && t_near>0 && t_near<t )
+	  t = t_near;
+	
+	if( t==std::numeric_limits<double>::max() )
+	  continue;
+	
+	Eigen::Vector3d point = t*ray_sensor;
+	cloud.push_back( pcl::PointXYZ(point(0),point(1),point(2)) );
+      }
+    }
+    return cloud;
+  }
+  
+  /*! Octree configuration used for all benchmarks, as in the launch file.
+   */
+  TreeType::Config octreeConfig()
+  {
+    TreeType::Config config;
+    config.resolution_m = 0.01;
+    return config;
+  }
+  
+  /*! Input configuration used for all benchmarks, as in the launch file.
+   */
+  StdPclInputPointXYZ<TreeType>::Type::Config inputConfig()
+  {
+    StdPclInputPointXYZ<TreeType>::Type::Config config;
+    config.use_bounding_box = true;
+    config.bounding_box_min_point_m = ::octomap::point3d(-0.6,-0.6,-0.01);
+    config.bounding_box_max_point_m = ::octomap::point3d(0.6,0.6,0.6);
+    config.max_sensor_range_m = 1.5;
+    config.nr_of_threads = 1;
+    return config;
+  }
+  
+  /*! Returns the synthetic map, built from 8 views around the scene on first use.
+   */
+  boost::shared_ptr<World> syntheticMap()
+  {
+    static boost::shared_ptr<World> world;
+    if( world!=NULL )
+      return world;
+    
+    world = boost::make_shared<World>( octreeConfig() );
+    StdPclInputPointXYZ<TreeType>::Ptr input = world->getLinkedObj<StdPclInputPointXYZ>( inputConfig() );
+    input->setOcclusionCalculator<RayOcclusionCalculator>( RayOcclusionCalculator<TreeType,PclType>::Options(0.3) );
+    
+    for( unsigned int i=0; i<8; ++i )
+    {
+      Eigen::Transform<double,3,Eigen::Affine> sensor_to_world = sensorToWorld( i*M_PI/4, 0.5, 1.0 );
+      PclType cloud = syntheticCloud( sensor_to_world, 160, 120 );
+      input->push( sensor_to_world, cloud );
+    }
+    return world;
+  }
+  
+  /*! Returns the map passed with --map, loaded on first use. NULL if none was passed or if it couldn't be read as IgTree.
+   */
+  boost::shared_ptr<World> recordedMap()
+  {
+    static boost::shared_ptr<World> world;
+    if( world!=NULL || recorded_map_path.empty() )
+      return world;
+    
+    boost::shared_ptr<World> loaded = boost::make_shared<World>( octreeConfig() );
+    boost::shared_ptr< OctreeAccess<TreeType> > access = loaded->getLinkedObj<OctreeAccess>();
+    boost::shared_ptr<TreeType> octree = access->octree();
+    
+    if( recorded_map_path.size()>3 && recorded_map_path.compare(recorded_map_path.size()-3,3,".bt")==0 )
+    {
+      if( !octree->readBinary(recorded_map_path) )
+	return world;
+    }
+    else
+    {
+      ::octomap::AbstractOcTree* tree = ::octomap::AbstractOcTree::read(recorded_map_path);
+      TreeType* ig_tree = dynamic_cast<TreeType*>(tree);
+      if( ig_tree==NULL )
+      {
+	delete tree;
+	return world;
+      }
+      octree->swapContent(*ig_tree);
+      delete tree;
+    }
+    // the calculators read the snapshot, not the live octree
+    access->publishSnapshot();
+    world = loaded;
+    return world;
+  }
+}
+
+
+/*! Information gain of a single view, per metric (first argument, in the order of the launch file) and ray resolution
+ * (second argument, [% of rays per pixel]).
+ */
+static void BM_ComputeViewIg( benchmark::State& state, bool use_recorded_map )
+{
+  boost::shared_ptr<World> world = use_recorded_map? recordedMap() : syntheticMap();
+  if( world==NULL )
+  {
+    state.SkipWithError("Could not read the recorded map as IgTree.");
+    return;
+  }
+  
+  BasicRayIgCalculator<TreeType>::Config config;
+  config.ray_caster_config.img_width_px = 480;
+  config.ray_caster_config.img_height_px = 752;
+  config.ray_caster_config.camera_matrix(0,0) = 448.1008985853343;
+  config.ray_caster_config.camera_matrix(1,1) = 448.1008985853343;
+  config.ray_caster_config.camera_matrix(0,2) = 376.5;
+  config.ray_caster_config.camera_matrix(1,2) = 240.5;
+  config.ray_caster_config.max_ray_depth_m = 1.5;
+  config.ray_caster_config.resolution.ray_resolution_x = state.range(1)/100.0;
+  config.ray_caster_config.resolution.ray_resolution_y = state.range(1)/100.0;
+  config.nr_of_threads = 1;
+  
+  BasicRayIgCalculator<TreeType>::Ptr calculator = world->getLinkedObj<BasicRayIgCalculator>(config);
+  InformationGain<TreeType>::Config ig_config;
+  calculator->registerInformationGain<OcclusionAwareIg>(ig_config);
+  calculator->registerInformationGain<UnobservedVoxelIg>(ig_config);
+  calculator->registerInformationGain<RearSideVoxelIg>(ig_config);
+  calculator->registerInformationGain<RearSideEntropyIg>(ig_config);
+  calculator->registerInformationGain<ProximityCountIg>(ig_config);
+  calculator->registerInformationGain<VasquezGomezAreaFactorIg>(ig_config);
+  calculator->registerInformationGain<AverageEntropyIg>(ig_config);
+  unsigned int ray_count_id = calculator->registerInformationGain<RayCountIg>(ig_config);
+  unsigned int voxel_count_id = calculator->registerInformationGain<VoxelCountIg>(ig_config);
+  
+  Eigen::Transform<double,3,Eigen::Affine> sensor_to_world = sensorToWorld( M_PI/8, 0.6, 0.9 );
+  iar::world_representation::CommunicationInterface::IgRetrievalCommand command;
+  command.path.push_back( movements::Pose( sensor_to_world.translation(), Eigen::Quaterniond(sensor_to_world.linear()) ) );
+  iar::world_representation::CommunicationInterface::ViewIgResult result;
+  
+  // rays and voxels per view, for the throughput
+  command.metric_ids.push_back(ray_count_id);
+  command.metric_ids.push_back(voxel_count_id);
+  calculator->computeViewIg(command,result);
+  double rays_per_view = result[0].predicted_gain;
+  double voxels_per_view = result[1].predicted_gain;
+  
+  command.metric_ids.assign( 1, static_cast<unsigned int>(state.range(0)) );
+  for( auto _ : state )
+  {
+    result.clear();
+    calculator->computeViewIg(command,result);
+    benchmark::DoNotOptimize( result[0].predicted_gain );
+  }
+  
+  state.counters["rays/s"] = benchmark::Counter( rays_per_view, benchmark::Counter::kIsIterationInvariantRate );
+  state.counters["voxels/s"] = benchmark::Counter( voxels_per_view, benchmark::Counter::kIsIterationInvariantRate );
+  state.counters["peak_rss_kb"] = peakRssKb();
+}
+BENCHMARK_CAPTURE(BM_ComputeViewIg, synthetic_map, false)
+  ->ArgsProduct({ {0,1,2,3,4,5,6}, {10,25,50} })->ArgNames({"metric","ray_res_pct"})->Unit(benchmark::kMillisecond);
+// the recorded map variant is registered in main() if a map was passed
+
+
+/*! Insertion of a point cloud into an empty map, per cloud size (first argument, [points]) and with or without occlusion
+ * calculation (second argument).
+ */
+static void BM_StdPclInputPush( benchmark::State& state )
+{
+  unsigned int width = static_cast<unsigned int>( std::sqrt(state.range(0)*4.0/3.0) );
+  unsigned int height = state.range(0)/width;
+  Eigen::Transform<double,3,Eigen::Affine> sensor_to_world = sensorToWorld( 0.3, 0.5, 1.0 );
+  PclType cloud = syntheticCloud( sensor_to_world, width, height );
+  
+  double map_nodes = 0;
+  for( auto _ : state )
+  {
+    state.PauseTiming();
+    boost::shared_ptr<World> world = boost::make_shared<World>( octreeConfig() );
+    StdPclInputPointXYZ<TreeType>::Ptr input = world->getLinkedObj<StdPclInputPointXYZ>( inputConfig() );
+    if( state.range(1)!=0 )
+      input->setOcclusionCalculator<RayOcclusionCalculator>( RayOcclusionCalculator<TreeType,PclType>::Options(0.3) );
+    PclType cloud_copy = cloud; // push() may modify the cloud
+    state.ResumeTiming();
+    
+    input->push( sensor_to_world, cloud_copy );
+    
+    state.PauseTiming();
+    map_nodes = world->getLinkedObj<OctreeAccess>()->octree()->size();
+    // tearing down the map isn't part of the insertion
+    input.reset();
+    world.reset();
+    state.ResumeTiming();
+  }
+  
+  state.counters["points/s"] = benchmark::Counter( cloud.size(), benchmark::Counter::kIsIterationInvariantRate );
+  state.counters["map_nodes"] = map_nodes;
+  state.counters["peak_rss_kb"] = peakRssKb();
+}
+BENCHMARK(BM_StdPclInputPush)
+  ->ArgsProduct({ {10000,50000,200000}, {0,1} })->ArgNames({"points","occlusions"})->Unit(benchmark::kMillisecond);
+
+
+/*! Building the synthetic map from 8 views with occlusion calculation, with nodes allocated from the block pools (argument 1)
+ * or from the heap (argument 0). Besides the insertion time, reports how much the resident set size grew while building the map
+ * and how much of that is still resident after the map was destroyed.
+ */
+static void BM_IgTreeNodeAllocation( benchmark::State& state )
+{
+  std::vector< Eigen::Transform<double,3,Eigen::Affine> > sensor_to_world;
+  std::vector<PclType> clouds;
+  for( unsigned int i=0; i<8; ++i )
+  {
+    sensor_to_world.push_back( sensorToWorld( i*M_PI/4, 0.5, 1.0 ) );
+    clouds.push_back( syntheticCloud( sensor_to_world.back(), 160, 120 ) );
+  }
+  
+  if( !IgTreeNode::setPooledAllocation( state.range(0)!=0 ) )
+  {
+    state.SkipWithError("Nodes are alive, pooling can't be switched.");
+    return;
+  }
+  double map_rss_kb = 0;
+  double rss_after_destruction_kb = 0;
+  for( auto _ : state )
+  {
+    state.PauseTiming();
+    double rss_before_kb = currentRssKb();
+    boost::shared_ptr<World> world = boost::make_shared<World>( octreeConfig() );
+    StdPclInputPointXYZ<TreeType>::Ptr input = world->getLinkedObj<StdPclInputPointXYZ>( inputConfig() );
+    input->setOcclusionCalculator<RayOcclusionCalculator>( RayOcclusionCalculator<TreeType,PclType>::Options(0.3) );
+    std::vector<PclType> cloud_copies = clouds; // push() may modify the clouds
+    state.ResumeTiming();
+    
+    for( size_t i=0; i<cloud_copies.size(); ++i )
+    {
+      input->push( sensor_to_world[i], cloud_copies[i] );
+    }
+    
+    state.PauseTiming();
+    map_rss_kb = currentRssKb()-rss_before_kb;
+    input.reset();
+    world.reset();
+    rss_after_destruction_kb = currentRssKb()-rss_before_kb;
+    state.ResumeTiming();
+  }
+  IgTreeNode::setPooledAllocation(true);
+  
+  state.counters["map_rss_kb"] = map_rss_kb;
+  state.counters["rss_after_destruction_kb"] = rss_after_destruction_kb;
+  state.counters["peak_rss_kb"] = peakRssKb();
+}
+BENCHMARK(BM_IgTreeNodeAllocation)->Arg(0)->Arg(1)->ArgNames({"pooled"})->Unit(benchmark::kMillisecond);
+
+
+namespace
+{
+  /*! View space with views on spherical shells around the scene.
+   */
+  iar::views::ViewSpace syntheticViewSpace( unsigned int nr_of_views )
+  {
+    iar::views::ViewSpace view_space;
+    for( unsigned int i=0; i<nr_of_views; ++i )
+    {
+      // golden angle spiral on shells of radius 0.8 to 1.2m
+      double z = 1.0 - (i+0.5)/nr_of_views;
+      double azimuth = i*2.399963229728653;
+      double radius = 0.8+0.4*(i%5)/4.0;
+      Eigen::Vector3d position = radius*Eigen::Vector3d( std::sqrt(1-z*z)*std::cos(azimuth), std::sqrt(1-z*z)*std::sin(azimuth), z );
+      
+      iar::views::View view("world");
+      view.pose() = movements::Pose( position, Eigen::Quaterniond::Identity() );
+      view_space.push_back(view);
+    }
+    return view_space;
+  }
+}
+
+static void BM_ViewSpacePushBack( benchmark::State& state )
+{
+  for( auto _ : state )
+  {
+    iar::views::ViewSpace view_space = syntheticViewSpace( state.range(0) );
+    benchmark::DoNotOptimize( view_space.size() );
+  }
+  state.counters["views/s"] = benchmark::Counter( state.range(0), benchmark::Counter::kIsIterationInvariantRate );
+  state.counters["peak_rss_kb"] = peakRssKb();
+}
+BENCHMARK(BM_ViewSpacePushBack)->Arg(1000)->Arg(10000)->Unit(benchmark::kMillisecond);
+
+static void BM_ViewSpaceGetView( benchmark::State& state )
+{
+  iar::views::ViewSpace view_space = syntheticViewSpace( state.range(0) );
+  iar::views::ViewSpace::IdSet ids;
+  view_space.getGoodViewSpace(ids,false);
+  
+  size_t i = 0;
+  for( auto _ : state )
+  {
+    iar::views::View view = view_space.getView( ids[(i*7919)%ids.size()] );
+    benchmark::DoNotOptimize( view.index() );
+    ++i;
+  }
+  state.counters["views/s"] = benchmark::Counter( 1, benchmark::Counter::kIsIterationInvariantRate );
+  state.counters["peak_rss_kb"] = peakRssKb();
+}
+BENCHMARK(BM_ViewSpaceGetView)->Arg(1000)->Arg(10000);
+
+static void BM_ViewSpaceGetViewsInRange( benchmark::State& state )
+{
+  iar::views::ViewSpace view_space = syntheticViewSpace( state.range(0) );
+  iar::views::View reference = *view_space.begin();
+  
+  std::vector<iar::views::View, Eigen::aligned_allocator<iar::views::View> > sub_space;
+  for( auto _ : state )
+  {
+    sub_space.clear();
+    view_space.getViewsInRange( reference, 0.3, sub_space );
+    benchmark::DoNotOptimize( sub_space.size() );
+  }
+  state.counters["views/s"] = benchmark::Counter( state.range(0), benchmark::Counter::kIsIterationInvariantRate );
+  state.counters["peak_rss_kb"] = peakRssKb();
+}
+BENCHMARK(BM_ViewSpaceGetViewsInRange)->Arg(1000)->Arg(10000)->Unit(benchmark::kMicrosecond);
+
+static void BM_ViewSpaceGetIdsInRange( benchmark::State& state )
+{
+  iar::views::ViewSpace view_space = syntheticViewSpace( state.range(0) );
+  Eigen::Vector3d reference = view_space.begin()->pose().position;
+  
+  iar::views::ViewSpace::IdSet ids;
+  for( auto _ : state )
+  {
+    ids.clear();
+    view_space.getIdsInRange( reference, 0.3, ids );
+    benchmark::DoNotOptimize( ids.size() );
+  }
+  state.counters["views/s"] = benchmark::Counter( state.range(0), benchmark::Counter::kIsIterationInvariantRate );
+  state.counters["peak_rss_kb"] = peakRssKb();
+}
+BENCHMARK(BM_ViewSpaceGetIdsInRange)->Arg(1000)->Arg(10000)->Arg(100000)->Unit(benchmark::kMicrosecond);
+
+static void BM_ViewSpaceGetKNearest( benchmark::State& state )
+{
+  iar::views::ViewSpace view_space = syntheticViewSpace( state.range(0) );
+  Eigen::Vector3d probe(0.5,0.2,0.6);
+  
+  iar::views::ViewSpace::IdSet ids;
+  for( auto _ : state )
+  {
+    ids.clear();
+    view_space.getKNearest( probe, state.range(1), ids );
+    benchmark::DoNotOptimize( ids.size() );
+  }
+  state.counters["views/s"] = benchmark::Counter( state.range(0), benchmark::Counter::kIsIterationInvariantRate );
+  state.counters["peak_rss_kb"] = peakRssKb();
+}
+BENCHMARK(BM_ViewSpaceGetKNearest)->ArgsProduct({ {1000,10000,100000}, {1,16} })->Unit(benchmark::kMicrosecond);
+
+static void BM_ViewSpaceGetIdsInFrustum( benchmark::State& state )
+{
+  iar::views::ViewSpace view_space = syntheticViewSpace( state.range(0) );
+  iar::views::Frustum frustum;
+  frustum.pose = movements::Pose( Eigen::Vector3d(0,0,-1.5), Eigen::Quaterniond::Identity() );
+  frustum.far_m = 2.0;
+  
+  iar::views::ViewSpace::IdSet ids;
+  for( auto _ : state )
+  {
+    ids.clear();
+    view_space.getIdsInFrustum( frustum, ids );
+    benchmark::DoNotOptimize( ids.size() );
+  }
+  state.counters["views/s"] = benchmark::Counter( state.range(0), benchmark::Counter::kIsIterationInvariantRate );
+  state.counters["peak_rss_kb"] = peakRssKb();
+}
+BENCHMARK(BM_ViewSpaceGetIdsInFrustum)->Arg(1000)->Arg(10000)->Arg(100000)->Unit(benchmark::kMicrosecond);
+
+static void BM_ViewSpaceGetGoodViewSpace( benchmark::State& state )
+{
+  iar::views::ViewSpace view_space = syntheticViewSpace( state.range(0) );
+  iar::views::ViewSpace::IdSet ids;
+  view_space.getGoodViewSpace(ids,false);
+  for( size_t i=0; i<ids.size(); i+=10 )
+  {
+    view_space.setVisited(ids[i]);
+  }
+  
+  for( auto _ : state )
+  {
+    iar::views::ViewSpace::IdSet good_views;
+    view_space.getGoodViewSpace(good_views);
+    benchmark::DoNotOptimize( good_views.size() );
+  }
+  state.counters["views/s"] = benchmark::Counter( state.range(0), benchmark::Counter::kIsIterationInvariantRate );
+  state.counters["peak_rss_kb"] = peakRssKb();
+}
+BENCHMARK(BM_ViewSpaceGetGoodViewSpace)->Arg(1000)->Arg(10000)->Unit(benchmark::kMicrosecond);
+
+/*! Deletes 1% of the views, one by one.
+ */
+static void BM_ViewSpaceDeleteView( benchmark::State& state )
+{
+  iar::views::ViewSpace prototype = syntheticViewSpace( state.range(0) );
+  iar::views::ViewSpace::IdSet ids;
+  prototype.getGoodViewSpace(ids,false);
+  size_t nr_of_deletions = ids.size()/100;
+  
+  for( auto _ : state )
+  {
+    state.PauseTiming();
+    iar::views::ViewSpace view_space = prototype;
+    state.ResumeTiming();
+    
+    for( size_t i=0; i<nr_of_deletions; ++i )
+    {
+      view_space.deleteView( ids[i*100] );
+    }
+  }
+  state.counters["views/s"] = benchmark::Counter( nr_of_deletions, benchmark::Counter::kIsIterationInvariantRate );
+  state.counters["peak_rss_kb"] = peakRssKb();
+}
+BENCHMARK(BM_ViewSpaceDeleteView)->Arg(1000)->Arg(10000)->Unit(benchmark::kMillisecond);
+
+
+int main(int argc, char** argv)
+{
+  // extract the own arguments before passing the rest on
+  int nr_of_args = 1;
+  for( int i=1; i<argc; ++i )
+  {
+    if( std::strncmp(argv[i],"--map=",6)==0 )
+      recorded_map_path = argv[i]+6;
+    else
+      argv[nr_of_args++] = argv[i];
+  }
+  argc = nr_of_args;
+  
+  if( !recorded_map_path.empty() )
+  {
+    benchmark::RegisterBenchmark("BM_ComputeViewIg/recorded_map", BM_ComputeViewIg, true)
+      ->ArgsProduct({ {0,1,2,3,4,5,6}, {10,25,50} })->ArgNames({"metric","ray_res_pct"})->Unit(benchmark::kMillisecond);
+  }
+  
+  benchmark::Initialize(&argc, argv);
+  if( benchmark::ReportUnrecognizedArguments(argc, argv) )
+    return 1;
+  
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::Shutdown();
+  return 0;
+}
\ No newline at end of file
@@ -73,14 +73,26 @@ namespace octomap
   TEMPT
   void CSCOPE::includeRayMeasurement( typename TREE_TYPE::NodeType* node )
   {
-    includeMeasurement(node);
+    includeRayMeasurement( Voxel(node,utils_) );
   }
   
   TEMPT
   void CSCOPE::includeEndPointMeasurement( typename TREE_TYPE::NodeType* node )
   {
-    double occ = utils_.pOccupancy(node);
-    double ent = utils_.entropy(occ);
+    includeEndPointMeasurement( Voxel(node,utils_) );
+  }
+  
+  TEMPT
+  void CSCOPE::includeRayMeasurement( const Voxel& voxel )
+  {
+    includeMeasurement(voxel);
+  }
+  
+  TEMPT
+  void CSCOPE::includeEndPointMeasurement( const Voxel& voxel )
+  {
+    double occ = voxel.pOccupancy();
+    double ent = voxel.entropy();
     
     ++current_ray_voxels_;
     current_ray_entropy_ += ent;
@@ -106,10 +118,19 @@ namespace octomap
   }
   
   TEMPT
-  void CSCOPE::includeMeasurement( typename TREE_TYPE::NodeType* node )
+  void CSCOPE::merge( const InformationGain<TREE_TYPE>& other, unsigned int weight )
+  {
+    const CSCOPE& partial = dynamic_cast<const CSCOPE&>(other);
+    
+    voxel_count_ += weight*partial.voxel_count_;
+    total_ig_ += weight*partial.total_ig_;
+  }
+  
+  TEMPT
+  void CSCOPE::includeMeasurement( const Voxel& voxel )
   {
-    double occ = utils_.pOccupancy(node);
-    double ent = utils_.entropy(occ);
+    double occ = voxel.pOccupancy();
+    double ent = voxel.entropy();
     
     ++current_ray_voxels_;
     current_ray_entropy_ += ent;
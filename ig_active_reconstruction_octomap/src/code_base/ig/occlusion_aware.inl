@@ -66,13 +66,25 @@ namespace octomap
   TEMPT
   void CSCOPE::includeRayMeasurement( typename TREE_TYPE::NodeType* node )
   {
-    includeMeasurement(node);
+    includeRayMeasurement( Voxel(node,utils_) );
   }
   
   TEMPT
   void CSCOPE::includeEndPointMeasurement( typename TREE_TYPE::NodeType* node )
   {
-    includeMeasurement(node);
+    includeEndPointMeasurement( Voxel(node,utils_) );
+  }
+  
+  TEMPT
+  void CSCOPE::includeRayMeasurement( const Voxel& voxel )
+  {
+    includeMeasurement(voxel);
+  }
+  
+  TEMPT
+  void CSCOPE::includeEndPointMeasurement( const Voxel& voxel )
+  {
+    includeMeasurement(voxel);
   }
   
   TEMPT
@@ -90,11 +102,20 @@ namespace octomap
   }
   
   TEMPT
-  void CSCOPE::includeMeasurement( typename TREE_TYPE::NodeType* node )
+  void CSCOPE::merge( const InformationGain<TREE_TYPE>& other, unsigned int weight )
+  {
+    const CSCOPE& partial = dynamic_cast<const CSCOPE&>(other);
+    
+    ig_ += weight*partial.ig_;
+    voxel_count_ += weight*partial.voxel_count_;
+  }
+  
+  TEMPT
+  void CSCOPE::includeMeasurement( const Voxel& voxel )
   {
     ++voxel_count_;
-    double p_occ = utils_.pOccupancy(node);
-    double vox_ent = utils_.entropy(p_occ);
+    double p_occ = voxel.pOccupancy();
+    double vox_ent = voxel.entropy();
     ig_ += p_vis_*vox_ent;
     p_vis_ *= p_occ;
   }
@@ -63,13 +63,25 @@ namespace octomap
   TEMPT
   void CSCOPE::includeRayMeasurement( typename TREE_TYPE::NodeType* node )
   {
-    includeMeasurement(node);
+    includeRayMeasurement( Voxel(node,utils_) );
   }
   
   TEMPT
   void CSCOPE::includeEndPointMeasurement( typename TREE_TYPE::NodeType* node )
   {
-    includeMeasurement(node);
+    includeEndPointMeasurement( Voxel(node,utils_) );
+  }
+  
+  TEMPT
+  void CSCOPE::includeRayMeasurement( const Voxel& voxel )
+  {
+    includeMeasurement(voxel);
+  }
+  
+  TEMPT
+  void CSCOPE::includeEndPointMeasurement( const Voxel& voxel )
+  {
+    includeMeasurement(voxel);
   }
   
   TEMPT
@@ -85,14 +97,23 @@ namespace octomap
   }
   
   TEMPT
-  void CSCOPE::includeMeasurement( typename TREE_TYPE::NodeType* node )
+  void CSCOPE::merge( const InformationGain<TREE_TYPE>& other, unsigned int weight )
+  {
+    const CSCOPE& partial = dynamic_cast<const CSCOPE&>(other);
+    
+    ig_ += weight*partial.ig_;
+    voxel_count_ += weight*partial.voxel_count_;
+  }
+  
+  TEMPT
+  void CSCOPE::includeMeasurement( const Voxel& voxel )
   {
-    if( node!=NULL )
+    if( voxel.node!=NULL )
     {
-      double dist = node->occDist();
-      if( !node->hasMeasurement() && dist>0 )
+      double dist = voxel.node->occDist();
+      if( !voxel.node->hasMeasurement() && dist>0 )
       {
-	ig_ += node->maxDist()-dist;
+	ig_ += this->octree_->maxDist(voxel.node)-dist;
 	++voxel_count_;
       }	
     }
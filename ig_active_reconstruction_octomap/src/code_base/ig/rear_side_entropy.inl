@@ -75,23 +75,35 @@ namespace octomap
   TEMPT
   void CSCOPE::includeRayMeasurement( typename TREE_TYPE::NodeType* node )
   {
-    includeMeasurement(node);
+    includeRayMeasurement( Voxel(node,utils_) );
   }
   
   TEMPT
   void CSCOPE::includeEndPointMeasurement( typename TREE_TYPE::NodeType* node )
+  {
+    includeEndPointMeasurement( Voxel(node,utils_) );
+  }
+  
+  TEMPT
+  void CSCOPE::includeRayMeasurement( const Voxel& voxel )
+  {
+    includeMeasurement(voxel);
+  }
+  
+  TEMPT
+  void CSCOPE::includeEndPointMeasurement( const Voxel& voxel )
   {
     if( previous_voxel_unknown_ )
     {
-      if( node==NULL || !node->hasMeasurement() ) // end point in free area...
+      if( voxel.node==NULL || !voxel.node->hasMeasurement() ) // end point in free area...
 	return;
     }
-    double p_occ = utils_.pOccupancy(node);
+    double p_occ = voxel.pOccupancy();
     
     if( !utils_.isOccupied(p_occ) )
       return;
     
-    double vox_ent = utils_.entropy(p_occ);
+    double vox_ent = voxel.entropy();
     current_ray_ig_ += p_vis_*vox_ent;
     current_ray_voxel_count_+=1;
     
@@ -113,14 +125,23 @@ namespace octomap
   }
   
   TEMPT
-  void CSCOPE::includeMeasurement( typename TREE_TYPE::NodeType* node )
+  void CSCOPE::merge( const InformationGain<TREE_TYPE>& other, unsigned int weight )
+  {
+    const CSCOPE& partial = dynamic_cast<const CSCOPE&>(other);
+    
+    ig_ += weight*partial.ig_;
+    voxel_count_ += weight*partial.voxel_count_;
+  }
+  
+  TEMPT
+  void CSCOPE::includeMeasurement( const Voxel& voxel )
   {
-    double p_occ = utils_.pOccupancy(node);
+    double p_occ = voxel.pOccupancy();
     
     if( utils_.isUnknown(p_occ) )
     {
       previous_voxel_unknown_ = true;
-      double vox_ent = utils_.entropy(p_occ);
+      double vox_ent = voxel.entropy();
       current_ray_ig_ += p_vis_*vox_ent;
       current_ray_voxel_count_ += 1;
     }
@@ -64,13 +64,25 @@ namespace octomap
   TEMPT
   void CSCOPE::includeRayMeasurement( typename TREE_TYPE::NodeType* node )
   {
-    includeMeasurement(node);
+    includeRayMeasurement( Voxel(node,utils_) );
   }
   
   TEMPT
   void CSCOPE::includeEndPointMeasurement( typename TREE_TYPE::NodeType* node )
   {
-    includeMeasurement(node);
+    includeEndPointMeasurement( Voxel(node,utils_) );
+  }
+  
+  TEMPT
+  void CSCOPE::includeRayMeasurement( const Voxel& voxel )
+  {
+    includeMeasurement(voxel);
+  }
+  
+  TEMPT
+  void CSCOPE::includeEndPointMeasurement( const Voxel& voxel )
+  {
+    includeMeasurement(voxel);
   }
   
   TEMPT
@@ -87,15 +99,23 @@ namespace octomap
   }
   
   TEMPT
-  void CSCOPE::includeMeasurement( typename TREE_TYPE::NodeType* node )
+  void CSCOPE::merge( const InformationGain<TREE_TYPE>& other, unsigned int weight )
+  {
+    const CSCOPE& partial = dynamic_cast<const CSCOPE&>(other);
+    
+    rear_side_voxel_count_ += weight*partial.rear_side_voxel_count_;
+  }
+  
+  TEMPT
+  void CSCOPE::includeMeasurement( const Voxel& voxel )
   {
-    if( node==NULL || !node->hasMeasurement() )
+    if( voxel.node==NULL || !voxel.node->hasMeasurement() )
     {
       previous_voxel_unknown_=true;
       return;
     }
     
-    double p_occ = utils_.pOccupancy(node);
+    double p_occ = voxel.pOccupancy();
     
     if( utils_.isUnknown(p_occ) )
     {
@@ -66,13 +66,25 @@ namespace octomap
   TEMPT
   void CSCOPE::includeRayMeasurement( typename TREE_TYPE::NodeType* node )
   {
-    includeMeasurement(node);
+    includeRayMeasurement( Voxel(node,utils_) );
   }
   
   TEMPT
   void CSCOPE::includeEndPointMeasurement( typename TREE_TYPE::NodeType* node )
   {
-    includeMeasurement(node);
+    includeEndPointMeasurement( Voxel(node,utils_) );
+  }
+  
+  TEMPT
+  void CSCOPE::includeRayMeasurement( const Voxel& voxel )
+  {
+    includeMeasurement(voxel);
+  }
+  
+  TEMPT
+  void CSCOPE::includeEndPointMeasurement( const Voxel& voxel )
+  {
+    includeMeasurement(voxel);
   }
   
   TEMPT
@@ -90,14 +102,23 @@ namespace octomap
   }
   
   TEMPT
-  void CSCOPE::includeMeasurement( typename TREE_TYPE::NodeType* node )
+  void CSCOPE::merge( const InformationGain<TREE_TYPE>& other, unsigned int weight )
+  {
+    const CSCOPE& partial = dynamic_cast<const CSCOPE&>(other);
+    
+    ig_ += weight*partial.ig_;
+    voxel_count_ += weight*partial.voxel_count_;
+  }
+  
+  TEMPT
+  void CSCOPE::includeMeasurement( const Voxel& voxel )
   {
-    double p_occ = utils_.pOccupancy(node);
+    double p_occ = voxel.pOccupancy();
     
     if( utils_.isUnknown(p_occ) )
     {
       ++voxel_count_;
-      double vox_ent = utils_.entropy(p_occ);
+      double vox_ent = voxel.entropy();
       ig_ += p_vis_*vox_ent;
     }
     
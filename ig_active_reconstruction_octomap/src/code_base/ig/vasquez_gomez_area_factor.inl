@@ -86,6 +86,7 @@ namespace octomap
   TEMPT
   void CSCOPE::makeReadyForNewRay()
   {
+    no_known_voxel_so_far_ = true;
     previous_voxel_free_ = true;
     ray_is_already_registered_ = false;
   }
@@ -93,6 +94,9 @@ namespace octomap
   TEMPT
   void CSCOPE::reset()
   {
+    occupied_count_ = 0;
+    occplane_count_ = 0;
+    unobserved_count_ = 0;
     voxel_count_ = 0;
     no_known_voxel_so_far_ = true;
     previous_voxel_free_ = true;
@@ -101,13 +105,25 @@ namespace octomap
   TEMPT
   void CSCOPE::includeRayMeasurement( typename TREE_TYPE::NodeType* node )
   {
-    includeMeasurement(node);
+    includeRayMeasurement( Voxel(node,utils_) );
   }
   
   TEMPT
   void CSCOPE::includeEndPointMeasurement( typename TREE_TYPE::NodeType* node )
   {
-    if( !includeMeasurement(node) ) // if ray wasn't registered to the last voxel on it, it's an unmarked one
+    includeEndPointMeasurement( Voxel(node,utils_) );
+  }
+  
+  TEMPT
+  void CSCOPE::includeRayMeasurement( const Voxel& voxel )
+  {
+    includeMeasurement(voxel);
+  }
+  
+  TEMPT
+  void CSCOPE::includeEndPointMeasurement( const Voxel& voxel )
+  {
+    if( !includeMeasurement(voxel) ) // if ray wasn't registered to the last voxel on it, it's an unmarked one
     {
       unobserved_count_+=1;
     }
@@ -127,7 +143,18 @@ namespace octomap
   }
   
   TEMPT
-  bool CSCOPE::includeMeasurement( typename TREE_TYPE::NodeType* node )
+  void CSCOPE::merge( const InformationGain<TREE_TYPE>& other, unsigned int weight )
+  {
+    const CSCOPE& partial = dynamic_cast<const CSCOPE&>(other);
+    
+    occupied_count_ += weight*partial.occupied_count_;
+    occplane_count_ += weight*partial.occplane_count_;
+    unobserved_count_ += weight*partial.unobserved_count_;
+    voxel_count_ += weight*partial.voxel_count_;
+  }
+  
+  TEMPT
+  bool CSCOPE::includeMeasurement( const Voxel& voxel )
   {
     if(ray_is_already_registered_) // register each ray only once
     {
@@ -135,7 +162,7 @@ namespace octomap
     }
     
     double occ;
-    if( node==NULL )
+    if( voxel.node==NULL )
     {
         occ=utils_.config.p_unknown_prior; // default for unknown
         if( no_known_voxel_so_far_ )
@@ -151,10 +178,10 @@ namespace octomap
     }
     else
     {
-        occ = utils_.pOccupancy(node);
+        occ = voxel.pOccupancy();
     }
     
-    if( !node->hasMeasurement() && node->occDist()!=-1 )
+    if( !voxel.node->hasMeasurement() && voxel.node->occDist()!=-1 )
     {
         ++occplane_count_;
         ray_is_already_registered_ = true;
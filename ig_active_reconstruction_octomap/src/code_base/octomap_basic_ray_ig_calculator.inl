@@ -19,7 +19,13 @@
 #define CSCOPE BasicRayIgCalculator<TREE_TYPE>
 
 #include <octomap/octomap_types.h>
+#include <limits>
+#include <cmath>
+#include <algorithm>
+#include <functional>
 #include <boost/foreach.hpp>
+#include <boost/bind.hpp>
+#include <boost/make_shared.hpp>
 
 namespace ig_active_reconstruction
 {
@@ -32,6 +38,13 @@ namespace octomap
   TEMPT
   CSCOPE::Config::Config()
   : ray_caster_config()
+  , nr_of_threads(0)
+  , rays_per_chunk(1000)
+  , hierarchical_ig(false)
+  , tile_size_rays(4)
+  , coarse_depth_offset(2)
+  , refined_tile_fraction(0.25)
+  , ig_config()
   {
     
   }
@@ -41,11 +54,21 @@ namespace octomap
   : config_(config)
   , ray_caster_(config.ray_caster_config)
   {
+    unsigned int nr_of_threads = (config_.nr_of_threads!=0)?config_.nr_of_threads:boost::thread::hardware_concurrency();
+    if( config_.rays_per_chunk==0 )
+      config_.rays_per_chunk = 1;
+    if( config_.tile_size_rays==0 )
+      config_.tile_size_rays = 1;
+    
+    // the thread calling computeViewIg takes part in the evaluation
+    if( nr_of_threads>1 )
+      worker_pool_ = boost::make_shared<WorkerPool>(nr_of_threads-1);
   }
   
   TEMPT
   void CSCOPE::setNewRayCastingConfig( PinholeCamRayCaster::Config& config )
   {
+    config_.ray_caster_config = config;
     ray_caster_.setConfig(config);
   }
   
@@ -78,10 +101,65 @@ namespace octomap
     ray_caster_config.max_y_perc = command.config.ray_window.max_y_perc;
     
     //ray_caster_.setResolution(ray_caster_config);
-    boost::shared_ptr<RayCaster::RaySet> ray_set = ray_caster_.getRaySet(command.path[0]);
+    
+    typename WorldRepresentation<TREE_TYPE>::ReadLock map_lock(*this->link_.octree_mutex, boost::defer_lock);
+    boost::shared_ptr<const TREE_TYPE> octree = pinOctree(map_lock);
     
     // build ig metric set
-    std::vector< boost::shared_ptr< InformationGain<TREE_TYPE> > > ig_set;
+    IgSet ig_set;
+    std::vector<unsigned int> ig_ids; // factory ids of the metrics in ig_set
+    buildIgSet( command, octree.get(), ig_set, ig_ids, output_ig );
+    
+    // cast rays
+    
+    RayCastSettings ray_cast_settings;
+    ray_cast_settings.max_ray_depth = config_.ray_caster_config.max_ray_depth_m;//command.config.max_ray_depth;
+    ray_cast_settings.octree = octree.get();
+    
+    RayCaster::RayBatch& rays = rayBuffer();
+    std::vector<unsigned int> ray_weights;
+    getViewRays(command.path[0],command.config,this->withLookupTable(config_.ig_config),ray_cast_settings,rays,ray_weights);
+    
+    if( worker_pool_==NULL || rays.size()<=config_.rays_per_chunk )
+    {
+      calculateIgsOnRays( &rays, &ray_weights, 0, rays.size(), ray_cast_settings, &ig_ids, &ig_set );
+    }
+    else
+    {
+      // Every chunk of rays is evaluated on its own instances of the metrics, which are merged in chunk order afterwards.
+      size_t nr_of_rays = rays.size();
+      size_t nr_of_chunks = (nr_of_rays+config_.rays_per_chunk-1)/config_.rays_per_chunk;
+      
+      std::vector<IgSet> chunk_ig_sets(nr_of_chunks);
+      std::vector<WorkerPool::Task> tasks;
+      for( size_t i=0; i<nr_of_chunks; ++i )
+      {
+	createIgSet( ig_ids, octree.get(), chunk_ig_sets[i] );
+	size_t first = i*config_.rays_per_chunk;
+	size_t last = std::min( first+config_.rays_per_chunk, nr_of_rays );
+	
+	tasks.push_back( boost::bind(&CSCOPE::calculateIgsOnRays, this, &rays, &ray_weights, first, last, ray_cast_settings, &ig_ids, &chunk_ig_sets[i]) );
+      }
+      worker_pool_->run(tasks);
+      
+      BOOST_FOREACH( IgSet& chunk_ig_set, chunk_ig_sets )
+      {
+	for( size_t i=0; i<ig_set.size(); ++i )
+	{
+	  ig_set[i]->merge( *chunk_ig_set[i] );
+	}
+      }
+    }
+    
+    // retrieve information gains and build output
+    collectIgs( ig_set, output_ig );
+    
+    return ResultInformation::SUCCEEDED;
+  }
+  
+  TEMPT
+  void CSCOPE::buildIgSet( IgRetrievalCommand& command, const TREE_TYPE* octree, IgSet& ig_set, std::vector<unsigned int>& ig_ids, ViewIgRetrievalResult& output_ig )
+  {
     if( !command.metric_ids.empty() )
     {
       IgRetrievalResult res;
@@ -97,7 +175,9 @@ namespace octomap
 	else
 	{
 	  res.status = ResultInformation::SUCCEEDED;
+	  ig_metric->setOctree(octree);
 	  ig_set.push_back(ig_metric);
+	  ig_ids.push_back(id);
 	}
 	output_ig.push_back(res);
       }
@@ -117,30 +197,28 @@ namespace octomap
 	else
 	{
 	  res.status = ResultInformation::SUCCEEDED;
+	  ig_metric->setOctree(octree);
 	  ig_set.push_back(ig_metric);
+	  ig_ids.push_back( this->ig_factory_.idOf(name) );
 	}
 	output_ig.push_back(res);
       }
     }
-    
-    // cast rays
-    RayCastSettings ray_cast_settings;
-    ray_cast_settings.max_ray_depth = config_.ray_caster_config.max_ray_depth_m;//command.config.max_ray_depth;
-    
-    for(unsigned int i=0;i<ray_set->size();++i)
+  }
+  
+  TEMPT
+  void CSCOPE::createIgSet( const std::vector<unsigned int>& ig_ids, const TREE_TYPE* octree, IgSet& ig_set )
+  {
+    BOOST_FOREACH( const unsigned int& id, ig_ids )
     {
-      RayCaster::Ray& ray = (*ray_set)[i];
-      //std::cout<<"\norigin:\n"<<ray.origin<<"\ndirection:\n"<<ray.direction<<"\n";
-      BOOST_FOREACH( typename InformationGain<TREE_TYPE>::Ptr& ig, ig_set )
-      {
-	ig->makeReadyForNewRay();
-      }
-      /*if(i%100==0)
-	std::cout<<"\nCalculating ray "<<i<<"/"<<ray_set->size();*/
-      calculateIgsOnRay(ray,ig_set, ray_cast_settings);
+      ig_set.push_back( this->ig_factory_.get(id) );
+      ig_set.back()->setOctree(octree);
     }
-    
-    // retrieve information gains and build output
+  }
+  
+  TEMPT
+  void CSCOPE::collectIgs( IgSet& ig_set, ViewIgRetrievalResult& output_ig )
+  {
     typename std::vector< boost::shared_ptr< InformationGain<TREE_TYPE> > >::iterator ig_it = ig_set.begin();
     BOOST_FOREACH( IgRetrievalResult& res, output_ig )
     {
@@ -151,8 +229,6 @@ namespace octomap
 	++ig_it;
       }
     }
-    
-    return ResultInformation::SUCCEEDED;
   }
   
   TEMPT
@@ -194,61 +270,285 @@ namespace octomap
     }
   }
   
+  TEMPT
+  boost::shared_ptr<const TREE_TYPE> CSCOPE::pinOctree( typename WorldRepresentation<TREE_TYPE>::ReadLock& map_lock )
+  {
+    // evaluating on the current snapshot doesn't block ongoing insertions, otherwise the octree must not change while the rays are evaluated
+    boost::shared_ptr<const TREE_TYPE> snapshot = this->link_.snapshots->current();
+    if( snapshot!=NULL )
+      return snapshot;
+    
+    map_lock.lock();
+    return this->link_.octree;
+  }
+  
   TEMPT
   void CSCOPE::calculateIgsOnRay( RayCaster::Ray& ray, std::vector< boost::shared_ptr< InformationGain<TREE_TYPE> > >& ig_set, RayCastSettings& setting )
+  {
+    IgSetSink sink(ig_set);
+    traverseRay(ray.origin,ray.direction,setting,sink);
+  }
+  
+  TEMPT
+  RayCaster::RayBatch& CSCOPE::rayBuffer()
+  {
+    if( ray_buffer_.get()==NULL )
+      ray_buffer_.reset( new RayCaster::RayBatch() );
+    return *ray_buffer_;
+  }
+  
+  TEMPT
+  void CSCOPE::getViewRays( movements::Pose& sensor_pose, const IgRetrievalConfig& ig_config, const typename InformationGain<TREE_TYPE>::Config& utils_config, RayCastSettings setting, RayCaster::RayBatch& rays, std::vector<unsigned int>& ray_weights )
+  {
+    ray_weights.clear();
+    ray_caster_.getRayBatch(sensor_pose,rays);
+    if( !config_.hierarchical_ig || rays.size()==0 )
+      return;
+    
+    // assign the rays to image tiles, using their pixel coordinates - the tiles span tile_size_rays rays of the ray casting resolution along each axis
+    boost::shared_ptr<const RayCaster::RayDirectionSet> rel_directions = ray_caster_.getRelRayDirectionSet();
+    const PinholeCamRayCaster::Config& camera = config_.ray_caster_config;
+    double tile_width = config_.tile_size_rays/camera.resolution.ray_resolution_x; // [px]
+    double tile_height = config_.tile_size_rays/camera.resolution.ray_resolution_y; // [px]
+    size_t nr_of_tiles_x = static_cast<size_t>( camera.img_width_px/tile_width ) + 1;
+    size_t nr_of_tiles_y = static_cast<size_t>( camera.img_height_px/tile_height ) + 1;
+    
+    std::vector<size_t> ray_tile( rays.size() );
+    std::vector<unsigned int> tile_ray_count( nr_of_tiles_x*nr_of_tiles_y, 0 );
+    std::vector<size_t> center_ray( nr_of_tiles_x*nr_of_tiles_y, rays.size() ); // ray closest to the center of each tile
+    std::vector<double> center_dist( nr_of_tiles_x*nr_of_tiles_y, std::numeric_limits<double>::max() );
+    for( size_t i=0; i<rays.size(); ++i )
+    {
+      const RayCaster::RayDirection& dir = (*rel_directions)[i];
+      double x_px = camera.camera_matrix(0,0)*dir(0)/dir(2) + camera.camera_matrix(0,2);
+      double y_px = camera.camera_matrix(1,1)*dir(1)/dir(2) + camera.camera_matrix(1,2);
+      
+      size_t tile_x = std::min( static_cast<size_t>( std::max(x_px,0.0)/tile_width ), nr_of_tiles_x-1 );
+      size_t tile_y = std::min( static_cast<size_t>( std::max(y_px,0.0)/tile_height ), nr_of_tiles_y-1 );
+      size_t tile = tile_y*nr_of_tiles_x + tile_x;
+      ray_tile[i] = tile;
+      ++tile_ray_count[tile];
+      
+      double dx = x_px - (tile_x+0.5)*tile_width;
+      double dy = y_px - (tile_y+0.5)*tile_height;
+      if( dx*dx+dy*dy < center_dist[tile] )
+      {
+	center_dist[tile] = dx*dx+dy*dy;
+	center_ray[tile] = i;
+      }
+    }
+    
+    // score the tiles that overlap the ray window of the call by the entropy along their center ray, traversed at a coarse octree depth
+    unsigned int tree_depth = setting.octree->getTreeDepth();
+    setting.depth = (config_.coarse_depth_offset<tree_depth)? tree_depth-config_.coarse_depth_offset : 1;
+    
+    double window_min_x = ig_config.ray_window.min_x_perc*camera.img_width_px;
+    double window_max_x = ig_config.ray_window.max_x_perc*camera.img_width_px;
+    double window_min_y = ig_config.ray_window.min_y_perc*camera.img_height_px;
+    double window_max_y = ig_config.ray_window.max_y_perc*camera.img_height_px;
+    
+    EntropySink sink(utils_config);
+    std::vector< std::pair<double,size_t> > tile_scores;
+    for( size_t tile=0; tile<center_ray.size(); ++tile )
+    {
+      double tile_min_x = (tile%nr_of_tiles_x)*tile_width;
+      double tile_min_y = (tile/nr_of_tiles_x)*tile_height;
+      if( center_ray[tile]==rays.size() || tile_min_x>window_max_x || tile_min_x+tile_width<window_min_x || tile_min_y>window_max_y || tile_min_y+tile_height<window_min_y )
+	continue;
+      
+      traverseRay( rays.origin, rays.direction(center_ray[tile]), setting, sink );
+      tile_scores.push_back( std::make_pair(sink.entropy,tile) );
+    }
+    
+    // refine the tiles with the highest scores, the budget scales with the ray resolution requested by the call
+    std::sort( tile_scores.begin(), tile_scores.end(), std::greater< std::pair<double,size_t> >() );
+    double refined_fraction = std::min( 1.0, config_.refined_tile_fraction*ig_config.ray_resolution_x*ig_config.ray_resolution_y );
+    size_t nr_of_refined_tiles = static_cast<size_t>( std::ceil( refined_fraction*tile_scores.size() ) );
+    
+    std::vector<bool> is_refined( center_ray.size(), false );
+    for( size_t i=0; i<nr_of_refined_tiles && i<tile_scores.size(); ++i )
+    {
+      is_refined[ tile_scores[i].second ] = true;
+    }
+    
+    // compact the batch in place, the center rays of unrefined tiles stand in for all rays of their tile
+    size_t nr_of_rays = 0;
+    for( size_t i=0; i<rays.size(); ++i )
+    {
+      size_t tile = ray_tile[i];
+      if( is_refined[tile] || center_ray[tile]==i )
+      {
+	rays.x[nr_of_rays] = rays.x[i];
+	rays.y[nr_of_rays] = rays.y[i];
+	rays.z[nr_of_rays] = rays.z[i];
+	ray_weights.push_back( is_refined[tile]? 1 : tile_ray_count[tile] );
+	++nr_of_rays;
+      }
+    }
+    rays.resize(nr_of_rays);
+  }
+  
+  TEMPT
+  template<class VOXEL_SINK>
+  void CSCOPE::traverseRay( const RayCaster::RayOrigin& ray_origin, const RayCaster::RayDirection& ray_direction, RayCastSettings& setting, VOXEL_SINK& sink )
   {
     using ::octomap::point3d;
-    using ::octomap::KeyRay;
     using ::octomap::OcTreeKey;
-    //std::cout<<"\norigin:\n"<<ray.origin<<"\ndirection:\n"<<ray.direction<<"\n";
-    point3d origin( ray.origin(0),ray.origin(1),ray.origin(2) );
-    point3d direction( ray.direction(0), ray.direction(1), ray.direction(2) );
-    point3d end_point; // calculate endpoint (if any)
     
-    double max_range = (setting.max_ray_depth>0)?setting.max_ray_depth:0.0;
+    const TREE_TYPE& octree = *setting.octree;
+    point3d origin( ray_origin(0),ray_origin(1),ray_origin(2) );
+    point3d direction( ray_direction(0), ray_direction(1), ray_direction(2) );
+    direction.normalize();
+    
+    double max_range = (setting.max_ray_depth>0)?setting.max_ray_depth:std::numeric_limits<double>::max();
     
-    bool found_endpoint = this->link_.octree->castRay( origin, direction, end_point, true, max_range ); // ignore unknown cells
+    sink.startRay();
     
-    if( !found_endpoint ) // this is necessary for occlusion based metrics but not for the others. Excluding it leads to a great speed up.
+    OcTreeKey key;
+    if( !octree.coordToKeyChecked(origin,key) )
+      return;
+    
+    // Single 3D-DDA pass over the voxels along the ray (as in octomap's castRay): Instead of casting the ray to find its end point,
+    // computing the keys up to it and searching each of them from the root, the voxels are looked up while stepping and passed on
+    // directly. The ray ends in the first occupied voxel, in the voxel in which the maximal range is reached (continuing through
+    // unknown space) or at the border of the map.
+    // Above the leaf level, the voxels are the inner nodes at the given depth.
+    unsigned int tree_depth = octree.getTreeDepth();
+    unsigned int depth = (setting.depth!=0 && setting.depth<tree_depth)? setting.depth : tree_depth;
+    int voxel_keys = 1<<(tree_depth-depth); // number of keys covered by a voxel along each axis
+    double resolution = octree.getResolution();
+    double voxel_size = voxel_keys*resolution;
+    
+    int step[3];
+    double t_max[3];
+    double t_delta[3];
+    for( unsigned int i=0; i<3; ++i )
     {
-      end_point = origin + direction*max_range; // use max range instead of stopping at the unknown
-      found_endpoint = true;
+      key[i] -= key[i]%voxel_keys; // first key of the voxel containing the origin
+      
+      if( direction(i)>0.0 )
+	step[i] = 1;
+      else if( direction(i)<0.0 )
+	step[i] = -1;
+      else
+	step[i] = 0;
+      
+      if( step[i]!=0 )
+      {
+	double voxel_min = octree.keyToCoord(key[i]) - 0.5*resolution;
+	double border = (step[i]>0)? voxel_min+voxel_size : voxel_min;
+	t_max[i] = (border - origin(i)) / direction(i);
+	t_delta[i] = voxel_size / std::fabs( direction(i) );
+      }
+      else
+      {
+	t_max[i] = std::numeric_limits<double>::max();
+	t_delta[i] = std::numeric_limits<double>::max();
+      }
     }
     
-    if( found_endpoint )
+    unsigned int last_voxel_key = (1u<<tree_depth) - voxel_keys;
+    NodeLookup<TREE_TYPE> lookup(octree);
+    
+    while( true )
     {
-      KeyRay ray;
-      this->link_.octree->computeRayKeys( origin, end_point, ray );
-      for( KeyRay::iterator it = ray.begin() ; it!=ray.end(); ++it )
+      typename TREE_TYPE::NodeType* voxel = lookup.search(key,depth);
+      
+      // dimension in which the ray leaves the current voxel
+      unsigned int dim;
+      if( t_max[0]<t_max[1] )
+	dim = (t_max[0]<t_max[2])? 0:2;
+      else
+	dim = (t_max[1]<t_max[2])? 1:2;
+      
+      bool is_occupied = voxel!=NULL && octree.isNodeOccupied(voxel);
+      bool max_range_reached = t_max[dim]>=max_range;
+      bool at_map_border = (step[dim]<0 && key[dim]==0) || (step[dim]>0 && key[dim]==last_voxel_key);
+      
+      if( is_occupied || max_range_reached || at_map_border )
       {
-	point3d coord = this->link_.octree->keyToCoord(*it);
-	typename TREE_TYPE::NodeType* traversedVoxel = this->link_.octree->search(*it);
-	BOOST_FOREACH( typename InformationGain<TREE_TYPE>::Ptr& ig, ig_set )
-	{
-	  ig->includeRayMeasurement( traversedVoxel );
-	}
+	sink.includeEndPointMeasurement( voxel );
+	return;
+      }
+      
+      sink.includeRayMeasurement( voxel );
+      key[dim] += step[dim]*voxel_keys;
+      t_max[dim] += t_delta[dim];
+    }
+  }
+  
+  TEMPT
+  void CSCOPE::calculateIgsOnRays( const RayCaster::RayBatch* rays, const std::vector<unsigned int>* ray_weights, size_t first, size_t last, RayCastSettings setting, const std::vector<unsigned int>* ig_ids, IgSet* ig_set )
+  {
+    IgSetSink sink(*ig_set);
+    IgSet ray_ig_set; // scratch metrics for weighted rays, created for the first one
+    IgSetSink ray_sink(ray_ig_set);
+    for( size_t i=first; i<last; ++i )
+    {
+      unsigned int weight = ray_weights->empty()? 1 : (*ray_weights)[i];
+      if( weight==1 )
+      {
+	traverseRay( rays->origin, rays->direction(i), setting, sink );
+	continue;
       }
       
-      OcTreeKey end_key;
-      if( this->link_.octree->coordToKeyChecked(end_point, end_key) )
+      if( ray_ig_set.empty() )
       {
-	typename TREE_TYPE::NodeType* traversedVoxel = this->link_.octree->search(end_key);
-	
-	BOOST_FOREACH( typename InformationGain<TREE_TYPE>::Ptr& ig, ig_set )
+	createIgSet( *ig_ids, setting.octree, ray_ig_set );
+      }
+      else
+      {
+	BOOST_FOREACH( typename InformationGain<TREE_TYPE>::Ptr& ig, ray_ig_set )
 	{
-	  ig->includeEndPointMeasurement( traversedVoxel );
+	  ig->reset();
 	}
       }
-    }
-    else
-    {
-      BOOST_FOREACH( typename InformationGain<TREE_TYPE>::Ptr& ig, ig_set )
+      
+      // merging with the weight is equivalent to evaluating the ray weight times
+      traverseRay( rays->origin, rays->direction(i), setting, ray_sink );
+      for( size_t j=0; j<ig_set->size(); ++j )
       {
-	ig->informAboutVoidRay();
+	(*ig_set)[j]->merge( *ray_ig_set[j], weight );
       }
     }
   }
   
+  TEMPT
+  void CSCOPE::IgSetSink::startRay()
+  {
+    BOOST_FOREACH( typename InformationGain<TREE_TYPE>::Ptr& ig, ig_set_ )
+    {
+      ig->makeReadyForNewRay();
+    }
+  }
+  
+  TEMPT
+  void CSCOPE::IgSetSink::includeRayMeasurement( typename TREE_TYPE::NodeType* node )
+  {
+    BOOST_FOREACH( typename InformationGain<TREE_TYPE>::Ptr& ig, ig_set_ )
+    {
+      ig->includeRayMeasurement( node );
+    }
+  }
+  
+  TEMPT
+  void CSCOPE::IgSetSink::includeEndPointMeasurement( typename TREE_TYPE::NodeType* node )
+  {
+    BOOST_FOREACH( typename InformationGain<TREE_TYPE>::Ptr& ig, ig_set_ )
+    {
+      ig->includeEndPointMeasurement( node );
+    }
+  }
+  
+  TEMPT
+  void CSCOPE::IgSetSink::informAboutVoidRay()
+  {
+    BOOST_FOREACH( typename InformationGain<TREE_TYPE>::Ptr& ig, ig_set_ )
+    {
+      ig->informAboutVoidRay();
+    }
+  }
+  
 }
 
 }
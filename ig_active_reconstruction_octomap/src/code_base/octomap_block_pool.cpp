@@ -0,0 +1,284 @@
+/* Copyright (c) 2016, Stefan Isler, islerstefan@bluewin.ch
+ * (ETH Zurich / Robotics and Perception Group, University of Zurich, Switzerland)
+ *
+ * This file is part of ig_active_reconstruction, software for information gain based, active reconstruction.
+ *
+ * ig_active_reconstruction is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * ig_active_reconstruction is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ * Please refer to the GNU Lesser General Public License for details on the license,
+ * on <http://www.gnu.org/licenses/>.
+*/
+
+#include "ig_active_reconstruction_octomap/octomap_block_pool.hpp"
+
+#include <new>
+#include <boost/align/aligned_alloc.hpp>
+
+namespace ig_active_reconstruction
+{
+  
+namespace world_representation
+{
+
+namespace octomap
+{
+  
+  const size_t BlockPool::BATCH_SIZE;
+  
+  BlockPool::BlockPool( size_t block_size, size_t slab_size )
+  : block_size_( ((block_size+sizeof(FreeBlock)-1)/sizeof(FreeBlock))*sizeof(FreeBlock) )
+  , slab_size_(1)
+  , blocks_offset_( ((sizeof(Slab)+2*sizeof(FreeBlock)-1)/(2*sizeof(FreeBlock)))*2*sizeof(FreeBlock) )
+  , pooling_(true)
+  , available_(NULL)
+  , current_(NULL)
+  , nr_of_slabs_(0)
+  , blocks_in_use_(0)
+  , caches_(&BlockPool::returnThreadCache)
+  {
+    if( block_size_==0 )
+      block_size_ = sizeof(FreeBlock);
+    
+    // slabs are aligned to their size, which thus must be a power of two
+    while( slab_size_<slab_size || slab_size_<blocks_offset_+BATCH_SIZE*block_size_ )
+      slab_size_ *= 2;
+    blocks_per_slab_ = (slab_size_-blocks_offset_)/block_size_;
+  }
+  
+  BlockPool::~BlockPool()
+  {
+    caches_.reset();
+    releaseMemory();
+  }
+  
+  void* BlockPool::allocate()
+  {
+    if( !pooling_ )
+      return ::operator new(block_size_);
+    
+    ThreadCache& cache = threadCache();
+    if( cache.free_list==NULL )
+      refill(cache);
+    
+    FreeBlock* block = cache.free_list;
+    cache.free_list = block->next;
+    --cache.size;
+    return block;
+  }
+  
+  void BlockPool::deallocate( void* block )
+  {
+    if( block==NULL )
+      return;
+    
+    if( !pooling_ )
+    {
+      ::operator delete(block);
+      return;
+    }
+    
+    ThreadCache& cache = threadCache();
+    FreeBlock* free_block = static_cast<FreeBlock*>(block);
+    free_block->next = cache.free_list;
+    cache.free_list = free_block;
+    ++cache.size;
+    
+    if( cache.size>=2*BATCH_SIZE )
+      flush(cache,BATCH_SIZE);
+  }
+  
+  bool BlockPool::releaseMemory()
+  {
+    ThreadCache* cache = caches_.get();
+    if( cache!=NULL )
+      flush(*cache,cache->size);
+    
+    boost::mutex::scoped_lock lock(mutex_);
+    
+    if( blocks_in_use_!=0 )
+      return false;
+    
+    // all slabs are empty and thus available
+    while( available_!=NULL )
+    {
+      Slab* slab = available_;
+      removeAvailable(slab);
+      boost::alignment::aligned_free(slab);
+    }
+    nr_of_slabs_ = 0;
+    current_ = NULL;
+    return true;
+  }
+  
+  size_t BlockPool::blocksInUse()
+  {
+    boost::mutex::scoped_lock lock(mutex_);
+    return blocks_in_use_;
+  }
+  
+  size_t BlockPool::reservedBytes()
+  {
+    boost::mutex::scoped_lock lock(mutex_);
+    return nr_of_slabs_*slab_size_;
+  }
+  
+  bool BlockPool::setPooling( bool pooling )
+  {
+    ThreadCache* cache = caches_.get();
+    if( cache!=NULL )
+      flush(*cache,cache->size);
+    
+    boost::mutex::scoped_lock lock(mutex_);
+    if( blocks_in_use_!=0 )
+      return pooling==pooling_;
+    
+    pooling_ = pooling;
+    return true;
+  }
+  
+  BlockPool::Slab* BlockPool::slabOf( void* block )
+  {
+    return reinterpret_cast<Slab*>( reinterpret_cast<boost::uintptr_t>(block) & ~static_cast<boost::uintptr_t>(slab_size_-1) );
+  }
+  
+  BlockPool::ThreadCache& BlockPool::threadCache()
+  {
+    ThreadCache* cache = caches_.get();
+    if( cache==NULL )
+    {
+      cache = new ThreadCache();
+      cache->pool = this;
+      cache->free_list = NULL;
+      cache->size = 0;
+      caches_.reset(cache);
+    }
+    return *cache;
+  }
+  
+  void BlockPool::refill( ThreadCache& cache )
+  {
+    boost::mutex::scoped_lock lock(mutex_);
+    
+    for( size_t i=0; i<BATCH_SIZE; ++i )
+    {
+      if( current_==NULL || (current_->free_list==NULL && current_->unused==0) )
+      {
+	if( available_==NULL )
+	{
+	  void* memory = boost::alignment::aligned_alloc(slab_size_,slab_size_);
+	  if( memory==NULL )
+	  {
+	    if( cache.free_list!=NULL )
+	      return;
+	    throw std::bad_alloc();
+	  }
+	  Slab* slab = new(memory) Slab();
+	  slab->unused = blocks_per_slab_;
+	  slab->free_list = NULL;
+	  slab->blocks_in_use = 0;
+	  slab->prev_available = NULL;
+	  slab->next_available = NULL;
+	  slab->is_available = false;
+	  addAvailable(slab);
+	  ++nr_of_slabs_;
+	}
+	current_ = available_;
+      }
+      
+      FreeBlock* block;
+      if( current_->free_list!=NULL )
+      {
+	block = current_->free_list;
+	current_->free_list = block->next;
+      }
+      else
+      {
+	--current_->unused;
+	block = reinterpret_cast<FreeBlock*>( reinterpret_cast<char*>(current_) + blocks_offset_ + current_->unused*block_size_ );
+      }
+      ++current_->blocks_in_use;
+      ++blocks_in_use_;
+      
+      if( current_->free_list==NULL && current_->unused==0 )
+	removeAvailable(current_);
+      
+      block->next = cache.free_list;
+      cache.free_list = block;
+      ++cache.size;
+    }
+  }
+  
+  void BlockPool::flush( ThreadCache& cache, size_t nr_of_blocks )
+  {
+    if( nr_of_blocks==0 )
+      return;
+    
+    boost::mutex::scoped_lock lock(mutex_);
+    
+    for( size_t i=0; i<nr_of_blocks && cache.free_list!=NULL; ++i )
+    {
+      FreeBlock* block = cache.free_list;
+      cache.free_list = block->next;
+      --cache.size;
+      
+      Slab* slab = slabOf(block);
+      block->next = slab->free_list;
+      slab->free_list = block;
+      --slab->blocks_in_use;
+      --blocks_in_use_;
+      
+      // return empty slabs right away, except for the current one, which would likely be allocated again soon
+      if( slab->blocks_in_use==0 && slab!=current_ )
+      {
+	if( slab->is_available )
+	  removeAvailable(slab);
+	boost::alignment::aligned_free(slab);
+	--nr_of_slabs_;
+      }
+      else if( !slab->is_available )
+      {
+	addAvailable(slab);
+      }
+    }
+  }
+  
+  void BlockPool::returnThreadCache( ThreadCache* cache )
+  {
+    cache->pool->flush(*cache,cache->size);
+    delete cache;
+  }
+  
+  void BlockPool::addAvailable( Slab* slab )
+  {
+    slab->prev_available = NULL;
+    slab->next_available = available_;
+    if( available_!=NULL )
+      available_->prev_available = slab;
+    available_ = slab;
+    slab->is_available = true;
+  }
+  
+  void BlockPool::removeAvailable( Slab* slab )
+  {
+    if( slab->prev_available!=NULL )
+      slab->prev_available->next_available = slab->next_available;
+    else
+      available_ = slab->next_available;
+    if( slab->next_available!=NULL )
+      slab->next_available->prev_available = slab->prev_available;
+    slab->prev_available = NULL;
+    slab->next_available = NULL;
+    slab->is_available = false;
+  }
+  
+}
+
+}
+
+}
\ No newline at end of file
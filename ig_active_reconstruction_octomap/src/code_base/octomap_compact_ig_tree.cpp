@@ -0,0 +1,93 @@
+/* Copyright (c) 2016, Stefan Isler, islerstefan@bluewin.ch
+ * (ETH Zurich / Robotics and Perception Group, University of Zurich, Switzerland)
+ *
+ * This file is part of ig_active_reconstruction, software for information gain based, active reconstruction.
+ *
+ * ig_active_reconstruction is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * ig_active_reconstruction is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ * Please refer to the GNU Lesser General Public License for details on the license,
+ * on <http://www.gnu.org/licenses/>.
+*/
+
+#include "ig_active_reconstruction_octomap/octomap_compact_ig_tree.hpp"
+
+#include <limits>
+
+
+namespace ig_active_reconstruction
+{
+  
+namespace world_representation
+{
+
+namespace octomap
+{
+  CompactIgTree::CompactIgTree(double resolution_m)
+  : ::octomap::OccupancyOcTreeBase<CompactIgTreeNode>(resolution_m)
+  , max_dist_(std::numeric_limits<double>::max())
+  {
+    config_.resolution_m = resolution_m;
+    updateOctreeConfig();
+  }
+  
+  CompactIgTree::CompactIgTree(Config config)
+  : ::octomap::OccupancyOcTreeBase<CompactIgTreeNode>(config.resolution_m)
+  , config_(config)
+  , max_dist_(std::numeric_limits<double>::max())
+  {
+    updateOctreeConfig();
+  }
+  
+  CompactIgTree::CompactIgTree(const CompactIgTree& rhs)
+  : ::octomap::OccupancyOcTreeBase<CompactIgTreeNode>(rhs)
+  , config_(rhs.config_)
+  , max_dist_(rhs.max_dist_)
+  {
+    
+  }
+  
+  CompactIgTree* CompactIgTree::create() const
+  {
+    return new CompactIgTree(config_);
+  }
+  
+  const CompactIgTree::Config& CompactIgTree::config() const
+  {
+    return config_;
+  }
+  
+  double CompactIgTree::maxDist( NodeType* node ) const
+  {
+    return max_dist_;
+  }
+  
+  void CompactIgTree::setMaxDist( NodeType* node, double max_dist )
+  {
+    max_dist_ = max_dist;
+  }
+  
+  void CompactIgTree::updateOctreeConfig()
+  {
+    setOccupancyThres(config_.occupancy_threshold);
+    setProbHit(config_.hit_probability);
+    setProbMiss(config_.miss_probability);
+    setClampingThresMin(config_.clamping_threshold_min);
+    setClampingThresMax(config_.clamping_threshold_max);
+  }
+  
+  std::string CompactIgTree::getTreeType() const
+  {
+    return "CompactIgTree";
+  }
+  
+}
+
+}
+
+}
\ No newline at end of file
@@ -60,7 +60,25 @@ namespace octomap
   template<template<typename> class IG_METRIC_TYPE>
   boost::shared_ptr< InformationGain<TREE_TYPE> > CSCOPE::makeShared(typename IG_METRIC_TYPE<TREE_TYPE>::Utils::Config utils)
   {
-    return boost::shared_ptr< InformationGain<TREE_TYPE> >( new IG_METRIC_TYPE<TREE_TYPE>(utils) );
+    return boost::shared_ptr< InformationGain<TREE_TYPE> >( new IG_METRIC_TYPE<TREE_TYPE>( withLookupTable(utils) ) );
+  }
+  
+  TEMPT
+  typename InformationGain<TREE_TYPE>::Config CSCOPE::withLookupTable( typename InformationGain<TREE_TYPE>::Config utils )
+  {
+    if( !utils.use_lookup_table || utils.lookup_table!=NULL || this->link_.octree==NULL )
+      return utils;
+    
+    double min_log_odds = ::octomap::logodds( this->link_.octree->config().clamping_threshold_min );
+    double max_log_odds = ::octomap::logodds( this->link_.octree->config().clamping_threshold_max );
+    
+    boost::mutex::scoped_lock lock(lookup_table_mutex_);
+    if( lookup_table_==NULL || !lookup_table_->matches(min_log_odds,max_log_odds,utils.lookup_table_resolution,utils.p_unknown_prior) )
+    {
+      lookup_table_.reset( new LogOddsTable(min_log_odds,max_log_odds,utils.lookup_table_resolution,utils.p_unknown_prior) );
+    }
+    utils.lookup_table = lookup_table_;
+    return utils;
   }
   
 }
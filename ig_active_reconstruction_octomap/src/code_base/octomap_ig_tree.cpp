@@ -52,6 +52,19 @@ namespace octomap
     updateOctreeConfig();
   }
   
+  IgTree::IgTree(const IgTree& rhs)
+  : ::octomap::OccupancyOcTreeBase<IgTreeNode>(rhs)
+  , config_(rhs.config_)
+  {
+    
+  }
+  
+  IgTree::~IgTree()
+  {
+    clear();
+    IgTreeNode::releasePooledMemory();
+  }
+  
   IgTree* IgTree::create() const
   {
     return new IgTree(config_);
@@ -28,6 +28,9 @@ namespace world_representation
 namespace octomap
 {
   
+  BlockPool IgTreeNode::node_pool_( sizeof(IgTreeNode) );
+  BlockPool IgTreeNode::children_pool_( 8*sizeof(::octomap::OcTreeDataNode<float>*) );
+  
   IgTreeNode::IgTreeNode()
   : ::octomap::OcTreeNode()
   , occ_dist_(-1)
@@ -36,8 +39,62 @@ namespace octomap
   {
   }
 
+  IgTreeNode::IgTreeNode( const IgTreeNode& rhs )
+  : ::octomap::OcTreeNode()
+  , occ_dist_(rhs.occ_dist_)
+  , max_dist_(rhs.max_dist_)
+  , has_no_measurement_(rhs.has_no_measurement_)
+  {
+    value = rhs.value;
+    
+    if( rhs.hasChildren() )
+    {
+      allocPooledChildren();
+      for( unsigned int i=0; i<8; ++i )
+      {
+	if( rhs.childExists(i) )
+	  children[i] = new IgTreeNode( *rhs.getChild(i) );
+      }
+    }
+  }
+
   IgTreeNode::~IgTreeNode()
   {
+    // the base class destructor would use delete[] on the pooled array
+    deletePooledChildren();
+  }
+  
+  void* IgTreeNode::operator new( size_t size )
+  {
+    if( size!=sizeof(IgTreeNode) ) // derived class
+      return ::operator new(size);
+    return node_pool_.allocate();
+  }
+  
+  void IgTreeNode::operator delete( void* node, size_t size )
+  {
+    if( size!=sizeof(IgTreeNode) )
+      ::operator delete(node);
+    else
+      node_pool_.deallocate(node);
+  }
+  
+  void IgTreeNode::releasePooledMemory()
+  {
+    node_pool_.releaseMemory();
+    children_pool_.releaseMemory();
+  }
+  
+  bool IgTreeNode::setPooledAllocation( bool pooling )
+  {
+    if( !node_pool_.setPooling(pooling) )
+      return false;
+    if( !children_pool_.setPooling(pooling) )
+    {
+      node_pool_.setPooling(!pooling);
+      return false;
+    }
+    return true;
   }
   
   void IgTreeNode::expandNode()
@@ -60,11 +117,7 @@ namespace octomap
     setValue(getChild(0)->getValue());
 
     // delete children
-    for (unsigned int i=0;i<8;i++) {
-      delete children[i];
-    }
-    delete[] children;
-    children = NULL;
+    deletePooledChildren();
 
     return true;
   }
@@ -103,13 +156,33 @@ namespace octomap
   bool IgTreeNode::createChild(unsigned int i)
   {
     if (children == NULL) {
-      allocChildren();
+      allocPooledChildren();
     }
     assert (children[i] == NULL);
     children[i] = new IgTreeNode();
     return true;
   }
 
+  void IgTreeNode::allocPooledChildren()
+  {
+    children = static_cast< ::octomap::OcTreeDataNode<float>** >( children_pool_.allocate() );
+    for (unsigned int i=0; i<8; i++) {
+      children[i] = NULL;
+    }
+  }
+  
+  void IgTreeNode::deletePooledChildren()
+  {
+    if( children==NULL )
+      return;
+    
+    for (unsigned int i=0; i<8; i++) {
+      delete getChild(i);
+    }
+    children_pool_.deallocate(children);
+    children = NULL;
+  }
+
   // ============================================================
   // =  occupancy probability  ==================================
   // ============================================================
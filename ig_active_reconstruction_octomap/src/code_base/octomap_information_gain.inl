@@ -32,6 +32,8 @@ namespace octomap
   , p_unknown_upper_bound(0.8)
   , p_unknown_lower_bound(0.2)
   , voxels_in_void_ray(100)
+  , use_lookup_table(true)
+  , lookup_table_resolution(0.001)
   {
     
   }
@@ -39,20 +41,18 @@ namespace octomap
   TEMPT
   double CSCOPE::Utils::entropy( typename TREE_TYPE::NodeType* voxel )
   {
-    double occupancy = pOccupancy(voxel);
+    double occupancy, vox_ent;
+    if( lookUp(voxel,occupancy,vox_ent) )
+      return vox_ent;
+    
+    occupancy = pOccupancy(voxel);
     return entropy(occupancy);
   }
   
   TEMPT
   double CSCOPE::Utils::entropy( double likelihood )
   {
-    double p_free = 1-likelihood;
-    if(likelihood==0 || p_free==0)
-    {
-	return 0;
-    }
-    double vox_ig = -likelihood*log(likelihood)-p_free*log(p_free);
-    return vox_ig;
+    return LogOddsTable::entropy(likelihood);
   }
   
   TEMPT
@@ -106,10 +106,57 @@ namespace octomap
     }
     else
     {
-      p_occ = voxel->getOccupancy();
+      double vox_ent;
+      if( !lookUp(voxel,p_occ,vox_ent) )
+	p_occ = voxel->getOccupancy();
     }
     return p_occ;
   }
+  
+  TEMPT
+  inline bool CSCOPE::Utils::lookUp( typename TREE_TYPE::NodeType* voxel, double& p_occ, double& entropy )
+  {
+    const LogOddsTable* table = config.lookup_table.get();
+    if( table==NULL )
+      return false;
+    
+    if( voxel==NULL || !voxel->hasMeasurement() )
+    {
+      if( table->priorOccupancy()!=config.p_unknown_prior )
+	return false;
+      
+      p_occ = config.p_unknown_prior;
+      entropy = table->priorEntropy();
+      return true;
+    }
+    return table->lookUp( voxel->getLogOdds(), p_occ, entropy );
+  }
+  
+  TEMPT
+  CSCOPE::Voxel::Voxel( typename TREE_TYPE::NodeType* a_node, Utils& utils )
+  : node(a_node)
+  , utils_(&utils)
+  , p_occ_(-1)
+  , entropy_(-1)
+  {
+    
+  }
+  
+  TEMPT
+  inline double CSCOPE::Voxel::pOccupancy() const
+  {
+    if( p_occ_<0 && !utils_->lookUp(node,p_occ_,entropy_) )
+      p_occ_ = utils_->pOccupancy(node);
+    return p_occ_;
+  }
+  
+  TEMPT
+  inline double CSCOPE::Voxel::entropy() const
+  {
+    if( entropy_<0 && !utils_->lookUp(node,p_occ_,entropy_) )
+      entropy_ = utils_->entropy( pOccupancy() );
+    return entropy_;
+  }
 }
 
 }
@@ -0,0 +1,82 @@
+/* Copyright (c) 2016, Stefan Isler, islerstefan@bluewin.ch
+ * (ETH Zurich / Robotics and Perception Group, University of Zurich, Switzerland)
+ *
+ * This file is part of ig_active_reconstruction, software for information gain based, active reconstruction.
+ *
+ * ig_active_reconstruction is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * ig_active_reconstruction is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ * Please refer to the GNU Lesser General Public License for details on the license,
+ * on <http://www.gnu.org/licenses/>.
+*/
+
+#include "ig_active_reconstruction_octomap/octomap_log_odds_table.hpp"
+
+#include <cmath>
+#include <octomap/octomap_utils.h>
+
+namespace ig_active_reconstruction
+{
+  
+namespace world_representation
+{
+
+namespace octomap
+{
+  
+  LogOddsTable::LogOddsTable( double min_log_odds, double max_log_odds, double resolution, double p_unknown_prior )
+  : min_log_odds_(min_log_odds)
+  , max_log_odds_(max_log_odds)
+  , resolution_(resolution)
+  , p_unknown_prior_(p_unknown_prior)
+  , prior_entropy_( entropy(p_unknown_prior) )
+  , inv_resolution_(1.0/resolution)
+  {
+    // one additional entry on each side, such that values clamped in float precision are covered as well
+    first_log_odds_ = min_log_odds-resolution;
+    size_t nr_of_entries = static_cast<size_t>( std::ceil((max_log_odds-min_log_odds)/resolution) ) + 3;
+    last_pos_ = nr_of_entries-1;
+    
+    entries_.resize(nr_of_entries);
+    for( size_t i=0; i<nr_of_entries; ++i )
+    {
+      entries_[i].p_occ = ::octomap::probability( first_log_odds_ + i*resolution );
+      entries_[i].entropy = entropy( entries_[i].p_occ );
+    }
+  }
+  
+  double LogOddsTable::priorOccupancy() const
+  {
+    return p_unknown_prior_;
+  }
+  
+  double LogOddsTable::priorEntropy() const
+  {
+    return prior_entropy_;
+  }
+  
+  bool LogOddsTable::matches( double min_log_odds, double max_log_odds, double resolution, double p_unknown_prior ) const
+  {
+    return min_log_odds==min_log_odds_ && max_log_odds==max_log_odds_ && resolution==resolution_ && p_unknown_prior==p_unknown_prior_;
+  }
+  
+  double LogOddsTable::entropy( double likelihood )
+  {
+    double p_free = 1-likelihood;
+    if(likelihood==0 || p_free==0)
+    {
+	return 0;
+    }
+    return -likelihood*std::log(likelihood)-p_free*std::log(p_free);
+  }
+  
+}
+
+}
+
+}
\ No newline at end of file
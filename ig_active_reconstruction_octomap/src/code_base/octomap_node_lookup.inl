@@ -0,0 +1,87 @@
+/* Copyright (c) 2016, Stefan Isler, islerstefan@bluewin.ch
+ * (ETH Zurich / Robotics and Perception Group, University of Zurich, Switzerland)
+ *
+ * This file is part of ig_active_reconstruction, software for information gain based, active reconstruction.
+ *
+ * ig_active_reconstruction is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * ig_active_reconstruction is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ * Please refer to the GNU Lesser General Public License for details on the license,
+ * on <http://www.gnu.org/licenses/>.
+*/
+
+#define TEMPT template<class TREE_TYPE>
+#define CSCOPE NodeLookup<TREE_TYPE>
+
+namespace ig_active_reconstruction
+{
+  
+namespace world_representation
+{
+
+namespace octomap
+{
+  TEMPT
+  CSCOPE::NodeLookup( const TREE_TYPE& octree )
+  : tree_depth_( octree.getTreeDepth() )
+  , path_( octree.getTreeDepth()+1, NULL )
+  , path_length_(0)
+  , has_previous_(false)
+  {
+    path_[0] = octree.getRoot();
+  }
+  
+  TEMPT
+  typename CSCOPE::NodeType* CSCOPE::search( const ::octomap::OcTreeKey& key, unsigned int max_depth )
+  {
+    if( path_[0]==NULL )
+      return NULL;
+    if( max_depth==0 || max_depth>tree_depth_ )
+      max_depth = tree_depth_;
+    
+    unsigned int depth = 0;
+    if( has_previous_ )
+    {
+      // the levels down to the first differing bit are shared with the previous key
+      unsigned int differing_bits = (key[0]^previous_key_[0]) | (key[1]^previous_key_[1]) | (key[2]^previous_key_[2]);
+      unsigned int common_depth = tree_depth_;
+      while( differing_bits!=0 )
+      {
+	--common_depth;
+	differing_bits >>= 1;
+      }
+      depth = std::min( std::min(common_depth,path_length_), max_depth );
+    }
+    previous_key_ = key;
+    has_previous_ = true;
+    
+    NodeType* node = path_[depth];
+    for( ; depth<max_depth; ++depth )
+    {
+      unsigned int pos = ::octomap::computeChildIdx( key, tree_depth_-1-depth );
+      if( !node->childExists(pos) )
+      {
+	path_length_ = depth;
+	// a node without children is a (pruned) leaf, containing the key
+	return node->hasChildren()? NULL : node;
+      }
+      node = static_cast<NodeType*>( node->getChild(pos) );
+      path_[depth+1] = node;
+    }
+    path_length_ = max_depth;
+    return node;
+  }
+  
+}
+
+}
+
+}
+
+#undef CSCOPE
+#undef TEMPT
\ No newline at end of file
@@ -37,6 +37,12 @@ namespace octomap
     this->link_.octree = octree;
   }
   
+  TEMPT
+  bool CSCOPE::pushRaw( const Eigen::Transform<double,3,Eigen::Affine>& sensor_to_world, const RawPointCloud& pcl )
+  {
+    return false;
+  }
+  
   /*TEMPT // cpp11 version
   template< template<typename,typename> class OCCLUSION_CALC_TYPE, class ... Types >
   void CSCOPE::setOcclusionCalculator( Types ... args )
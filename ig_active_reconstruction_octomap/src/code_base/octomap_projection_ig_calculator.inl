@@ -0,0 +1,387 @@
+/* Copyright (c) 2016, Stefan Isler, islerstefan@bluewin.ch
+ * (ETH Zurich / Robotics and Perception Group, University of Zurich, Switzerland)
+ *
+ * This file is part of ig_active_reconstruction, software for information gain based, active reconstruction.
+ *
+ * ig_active_reconstruction is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * ig_active_reconstruction is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ * Please refer to the GNU Lesser General Public License for details on the license,
+ * on <http://www.gnu.org/licenses/>.
+*/
+
+#define TEMPT template<class TREE_TYPE>
+#define CSCOPE ProjectionIgCalculator<TREE_TYPE>
+
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include <boost/bind.hpp>
+#include <boost/foreach.hpp>
+
+namespace ig_active_reconstruction
+{
+  
+namespace world_representation
+{
+
+namespace octomap
+{
+  TEMPT
+  CSCOPE::ProjectionIgCalculator( Config config )
+  : BasicRayIgCalculator<TREE_TYPE>(config)
+  {
+    
+  }
+  
+  TEMPT
+  typename CSCOPE::ResultInformation CSCOPE::computeViewIg(IgRetrievalCommand& command, ViewIgRetrievalResult& output_ig)
+  {
+    if( command.path.empty() )
+      return BasicRayIgCalculator<TREE_TYPE>::computeViewIg(command,output_ig);
+    
+    output_ig.clear();
+    
+    typename WorldRepresentation<TREE_TYPE>::ReadLock map_lock(*this->link_.octree_mutex, boost::defer_lock);
+    boost::shared_ptr<const TREE_TYPE> octree = this->pinOctree(map_lock);
+    
+    IgSet ig_set;
+    std::vector<unsigned int> ig_ids;
+    this->buildIgSet( command, octree.get(), ig_set, ig_ids, output_ig );
+    
+    Frustum frustum( this->config_.ray_caster_config, command.path[0] );
+    size_t nr_of_pixels = (frustum.width+1)*(frustum.height+1);
+    
+    // count the rays the ray caster would cast through each pixel
+    std::vector<unsigned int> rays_per_pixel( nr_of_pixels, 0 );
+    boost::shared_ptr<const RayCaster::RayDirectionSet> rel_directions = this->ray_caster_.getRelRayDirectionSet();
+    BOOST_FOREACH( const RayCaster::RayDirection& dir, *rel_directions )
+    {
+      int x_px = static_cast<int>( std::floor( frustum.fx*dir(0)/dir(2) + frustum.cx + 0.5 ) );
+      int y_px = static_cast<int>( std::floor( frustum.fy*dir(1)/dir(2) + frustum.cy + 0.5 ) );
+      if( x_px>=0 && x_px<=frustum.width && y_px>=0 && y_px<=frustum.height )
+	++rays_per_pixel[ y_px*(frustum.width+1) + x_px ];
+    }
+    
+    // collect the leaves in the frustum - the root volume is centered at the origin
+    std::vector<Leaf> leaves;
+    typename TREE_TYPE::NodeType* root = octree->getRoot();
+    if( root!=NULL )
+    {
+      double root_size = octree->getResolution()*(1<<octree->getTreeDepth());
+      collectLeaves( root, Eigen::Vector3d::Zero(), root_size, 0, frustum, *octree, leaves );
+    }
+    
+    // depth buffer: distance to the closest occupied leaf per pixel
+    std::vector<double> depth_buffer( nr_of_pixels, std::numeric_limits<double>::max() );
+    BOOST_FOREACH( Leaf& leaf, leaves )
+    {
+      if( !leaf.is_occupied )
+	continue;
+      
+      for( int y=leaf.occluded.y_min; y<=leaf.occluded.y_max; ++y )
+      {
+	for( int x=leaf.occluded.x_min; x<=leaf.occluded.x_max; ++x )
+	{
+	  double& depth = depth_buffer[ y*(frustum.width+1) + x ];
+	  depth = std::min( depth, leaf.distance );
+	}
+      }
+    }
+    
+    // sort the visible leaves into the pixel buckets
+    std::vector< std::vector<Projection> > buckets( nr_of_pixels );
+    BOOST_FOREACH( Leaf& leaf, leaves )
+    {
+      for( int y=leaf.footprint.y_min; y<=leaf.footprint.y_max; ++y )
+      {
+	for( int x=leaf.footprint.x_min; x<=leaf.footprint.x_max; ++x )
+	{
+	  size_t pixel = y*(frustum.width+1) + x;
+	  if( rays_per_pixel[pixel]!=0 && leaf.distance<=depth_buffer[pixel] )
+	    buckets[pixel].push_back( Projection(leaf) );
+	}
+      }
+    }
+    
+    // evaluate the metrics on the pixels
+    double resolution = octree->getResolution();
+    size_t pixels_per_chunk = this->config_.rays_per_chunk;
+    if( this->worker_pool_==NULL || nr_of_pixels<=pixels_per_chunk )
+    {
+      calculateIgsOnPixels( &buckets, &rays_per_pixel, 0, nr_of_pixels, &frustum, resolution, &ig_set );
+    }
+    else
+    {
+      size_t nr_of_chunks = (nr_of_pixels+pixels_per_chunk-1)/pixels_per_chunk;
+      
+      std::vector<IgSet> chunk_ig_sets(nr_of_chunks);
+      std::vector<WorkerPool::Task> tasks;
+      for( size_t i=0; i<nr_of_chunks; ++i )
+      {
+	this->createIgSet( ig_ids, octree.get(), chunk_ig_sets[i] );
+	size_t first = i*pixels_per_chunk;
+	size_t last = std::min( first+pixels_per_chunk, nr_of_pixels );
+	
+	tasks.push_back( boost::bind(&CSCOPE::calculateIgsOnPixels, this, &buckets, &rays_per_pixel, first, last, &frustum, resolution, &chunk_ig_sets[i]) );
+      }
+      this->worker_pool_->run(tasks);
+      
+      BOOST_FOREACH( IgSet& chunk_ig_set, chunk_ig_sets )
+      {
+	for( size_t i=0; i<ig_set.size(); ++i )
+	{
+	  ig_set[i]->merge( *chunk_ig_set[i] );
+	}
+      }
+    }
+    
+    this->collectIgs( ig_set, output_ig );
+    
+    return ResultInformation::SUCCEEDED;
+  }
+  
+  TEMPT
+  void CSCOPE::collectLeaves( typename TREE_TYPE::NodeType* node, const Eigen::Vector3d& center, double size, unsigned int depth, const Frustum& frustum, const TREE_TYPE& octree, std::vector<Leaf>& leaves )
+  {
+    Eigen::Vector3d sensor_center = frustum.toSensor(center);
+    double radius = 0.5*std::sqrt(3.0)*size; // bounding sphere
+    
+    if( !frustum.intersects(sensor_center,radius) )
+      return;
+    
+    if( depth<octree.getTreeDepth() && node->hasChildren() )
+    {
+      double child_offset = 0.25*size;
+      for( unsigned int i=0; i<8; ++i )
+      {
+	if( !node->childExists(i) )
+	  continue;
+	
+	// the child index bits select the upper half of the x, y and z range respectively
+	Eigen::Vector3d child_center = center;
+	child_center(0) += (i&1)? child_offset:-child_offset;
+	child_center(1) += (i&2)? child_offset:-child_offset;
+	child_center(2) += (i&4)? child_offset:-child_offset;
+	
+	collectLeaves( static_cast<typename TREE_TYPE::NodeType*>(node->getChild(i)), child_center, 0.5*size, depth+1, frustum, octree, leaves );
+      }
+      return;
+    }
+    
+    Leaf leaf;
+    leaf.node = node;
+    leaf.distance = sensor_center.norm();
+    leaf.size = size;
+    leaf.is_occupied = octree.isNodeOccupied(node);
+    // the bounding sphere of leaves close to the sensor plane would cover the whole image
+    leaf.footprint = ( sensor_center(2)-radius<=0 )? frustum.projectBox(center,size) : frustum.project(sensor_center,radius);
+    leaf.occluded = frustum.project(sensor_center,0.5*size,true); // inscribed sphere
+    leaves.push_back(leaf);
+  }
+  
+  TEMPT
+  void CSCOPE::calculateIgsOnPixels( std::vector< std::vector<Projection> >* buckets, std::vector<unsigned int>* rays_per_pixel, size_t first, size_t last, const Frustum* frustum, double resolution, IgSet* ig_set )
+  {
+    IgSetSink sink(*ig_set);
+    
+    for( size_t pixel=first; pixel<last; ++pixel )
+    {
+      std::vector<Projection>& bucket = (*buckets)[pixel];
+      std::sort( bucket.begin(), bucket.end() );
+      
+      for( unsigned int ray=0; ray<(*rays_per_pixel)[pixel]; ++ray )
+      {
+	sink.startRay();
+	
+	double covered = 0; // distance up to which the ray was passed to the metrics
+	bool found_endpoint = false;
+	BOOST_FOREACH( Projection& voxel, bucket )
+	{
+	  if( voxel.distance>frustum->max_range )
+	    break;
+	  
+	  // unknown space in front of the leaf
+	  double gap = voxel.distance - 0.5*voxel.size - covered;
+	  for( int i=static_cast<int>( std::floor(gap/resolution+0.5) ); i>0; --i )
+	  {
+	    sink.includeRayMeasurement(NULL);
+	  }
+	  
+	  if( voxel.is_occupied )
+	  {
+	    sink.includeEndPointMeasurement(voxel.node);
+	    found_endpoint = true;
+	    break;
+	  }
+	  
+	  for( int i=std::max( 1, static_cast<int>( std::floor(voxel.size/resolution+0.5) ) ); i>0; --i )
+	  {
+	    sink.includeRayMeasurement(voxel.node);
+	  }
+	  covered = std::max( covered, voxel.distance + 0.5*voxel.size );
+	}
+	
+	if( !found_endpoint ) // continue through unknown space up to the maximal range
+	{
+	  int nr_of_unknown = static_cast<int>( std::floor( (frustum->max_range-covered)/resolution + 0.5 ) );
+	  for( int i=1; i<nr_of_unknown; ++i )
+	  {
+	    sink.includeRayMeasurement(NULL);
+	  }
+	  sink.includeEndPointMeasurement(NULL);
+	}
+      }
+    }
+  }
+  
+  TEMPT
+  CSCOPE::Frustum::Frustum( const PinholeCamRayCaster::Config& config, const movements::Pose& sensor_pose )
+  : origin(sensor_pose.position)
+  , to_sensor(sensor_pose.orientation.inverse())
+  , fx( config.camera_matrix(0,0) )
+  , fy( config.camera_matrix(1,1) )
+  , cx( config.camera_matrix(0,2) )
+  , cy( config.camera_matrix(1,2) )
+  , width(config.img_width_px)
+  , height(config.img_height_px)
+  , max_range(config.max_ray_depth_m)
+  {
+    x_min_slope = -cx/fx;
+    x_max_slope = (width-cx)/fx;
+    y_min_slope = -cy/fy;
+    y_max_slope = (height-cy)/fy;
+  }
+  
+  TEMPT
+  Eigen::Vector3d CSCOPE::Frustum::toSensor( const Eigen::Vector3d& point ) const
+  {
+    return to_sensor*(point-origin);
+  }
+  
+  TEMPT
+  bool CSCOPE::Frustum::intersects( const Eigen::Vector3d& center, double radius ) const
+  {
+    if( center(2) < -radius || center.norm() > max_range+radius )
+      return false;
+    
+    // signed distances to the side planes, which pass through the origin
+    if( (center(0)-x_min_slope*center(2)) < -radius*std::sqrt(1+x_min_slope*x_min_slope) )
+      return false;
+    if( (x_max_slope*center(2)-center(0)) < -radius*std::sqrt(1+x_max_slope*x_max_slope) )
+      return false;
+    if( (center(1)-y_min_slope*center(2)) < -radius*std::sqrt(1+y_min_slope*y_min_slope) )
+      return false;
+    if( (y_max_slope*center(2)-center(1)) < -radius*std::sqrt(1+y_max_slope*y_max_slope) )
+      return false;
+    
+    return true;
+  }
+  
+  TEMPT
+  typename CSCOPE::Footprint CSCOPE::Frustum::project( const Eigen::Vector3d& center, double radius, bool inner ) const
+  {
+    Footprint footprint;
+    
+    if( center(2)-radius <= 0 ) // sensor lies within the sphere's depth range: may cover any pixel, but none for certain
+    {
+      footprint.x_min = 0;
+      footprint.x_max = inner? -1 : width;
+      footprint.y_min = 0;
+      footprint.y_max = inner? -1 : height;
+      return footprint;
+    }
+    
+    // the sphere's image contains the disk with its angular radius asin(radius/distance), which is at least radius/distance, and is
+    // contained in the disk spanned by its radius at the depth of its closest point
+    double x_px = fx*center(0)/center(2) + cx;
+    double y_px = fy*center(1)/center(2) + cy;
+    double distance = inner? center.norm() : center(2)-radius;
+    double x_radius_px = fx*radius/distance;
+    double y_radius_px = fy*radius/distance;
+    
+    footprint.x_min = std::max( 0, static_cast<int>( std::ceil(x_px-x_radius_px) ) );
+    footprint.x_max = std::min( width, static_cast<int>( std::floor(x_px+x_radius_px) ) );
+    footprint.y_min = std::max( 0, static_cast<int>( std::ceil(y_px-y_radius_px) ) );
+    footprint.y_max = std::min( height, static_cast<int>( std::floor(y_px+y_radius_px) ) );
+    return footprint;
+  }
+  
+  TEMPT
+  typename CSCOPE::Footprint CSCOPE::Frustum::projectBox( const Eigen::Vector3d& center, double size ) const
+  {
+    // corners in sensor coordinates, the index bits select the upper half of the x, y and z range respectively
+    Eigen::Vector3d corners[8];
+    for( unsigned int i=0; i<8; ++i )
+    {
+      Eigen::Vector3d corner = center;
+      corner(0) += (i&1)? 0.5*size:-0.5*size;
+      corner(1) += (i&2)? 0.5*size:-0.5*size;
+      corner(2) += (i&4)? 0.5*size:-0.5*size;
+      corners[i] = toSensor(corner);
+    }
+    
+    // the box clipped to the half space in front of the sensor is convex: its image is bounded by the images of the corners in
+    // front of the sensor and of the points where the edges cross the clipping plane
+    double min_depth = 1e-6*size;
+    Eigen::Vector3d points[20];
+    unsigned int nr_of_points = 0;
+    
+    for( unsigned int i=0; i<8; ++i )
+    {
+      if( corners[i](2)>=min_depth )
+	points[nr_of_points++] = corners[i];
+      
+      for( unsigned int bit=1; bit<8; bit<<=1 )
+      {
+	if( i&bit )
+	  continue;
+	
+	const Eigen::Vector3d& a = corners[i];
+	const Eigen::Vector3d& b = corners[i|bit];
+	if( (a(2)<min_depth)!=(b(2)<min_depth) )
+	  points[nr_of_points++] = a + (min_depth-a(2))/(b(2)-a(2))*(b-a);
+      }
+    }
+    
+    double x_min = std::numeric_limits<double>::max(), x_max = -std::numeric_limits<double>::max();
+    double y_min = std::numeric_limits<double>::max(), y_max = -std::numeric_limits<double>::max();
+    for( unsigned int i=0; i<nr_of_points; ++i )
+    {
+      x_min = std::min( x_min, points[i](0)/points[i](2) );
+      x_max = std::max( x_max, points[i](0)/points[i](2) );
+      y_min = std::min( y_min, points[i](1)/points[i](2) );
+      y_max = std::max( y_max, points[i](1)/points[i](2) );
+    }
+    
+    Footprint footprint;
+    if( nr_of_points==0 ) // completely behind the sensor
+    {
+      footprint.x_min = 0;
+      footprint.x_max = -1;
+      footprint.y_min = 0;
+      footprint.y_max = -1;
+      return footprint;
+    }
+    
+    // clamped in floating point first, the slopes may be huge close to the clipping plane
+    footprint.x_min = static_cast<int>( std::ceil( std::max( 0.0, fx*x_min+cx ) ) );
+    footprint.x_max = static_cast<int>( std::floor( std::min( double(width), fx*x_max+cx ) ) );
+    footprint.y_min = static_cast<int>( std::ceil( std::max( 0.0, fy*y_min+cy ) ) );
+    footprint.y_max = static_cast<int>( std::floor( std::min( double(height), fy*y_max+cy ) ) );
+    return footprint;
+  }
+  
+}
+
+}
+
+}
+
+#undef CSCOPE
+#undef TEMPT
\ No newline at end of file
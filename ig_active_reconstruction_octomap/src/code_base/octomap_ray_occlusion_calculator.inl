@@ -18,7 +18,11 @@
 #define TEMPT template<class TREE_TYPE, class POINTCLOUD_TYPE>
 #define CSCOPE RayOcclusionCalculator<TREE_TYPE,POINTCLOUD_TYPE>
 
+#include <algorithm>
 #include <octomap/octomap.h>
+#include <boost/foreach.hpp>
+#include <boost/unordered_map.hpp>
+#include <boost/make_shared.hpp>
 
 namespace ig_active_reconstruction
 {
@@ -41,56 +45,105 @@ namespace octomap
     if( this->link_.octree==NULL )
       return;
     
+    commit( *prepare(origin,pcl,valid_indices) );
+  }
+  
+  TEMPT
+  boost::shared_ptr<typename CSCOPE::PreparedUpdate> CSCOPE::prepare( const Eigen::Vector3d& origin, const POINTCLOUD_TYPE& pcl, std::vector<int>& valid_indices )
+  {
+    boost::shared_ptr<ShadowCells> update = boost::make_shared<ShadowCells>();
+    if( this->link_.octree==NULL )
+      return update;
+    
+    std::vector<ShadowCell>& shadow_cells = update->cells;
+    
     using ::octomap::point3d;
     using ::octomap::KeyRay;
+    using ::octomap::OcTreeKey;
     
     point3d sensor_origin(origin(0),origin(1),origin(2));
     KeyRay ray;
     
-    double max_nr_of_cells_in_occlusion = 2*occlusion_update_dist_m_/this->link_.octree->getResolution();
+    typedef boost::unordered_map<OcTreeKey, size_t, OcTreeKey::KeyHash> CellMap;
+    CellMap cell_map; // index of each key in shadow_cells
     
     for( size_t i = 0; i<valid_indices.size(); ++i )
     {
-      if( i%1000==0)
-	std::cout<<"\ncalculating occlusion for point "<<i<<"/"<<valid_indices.size();
-      
-      //point3d point(it->x, it->y, it->z);
       point3d point(pcl.points[valid_indices[i]].x, pcl.points[valid_indices[i]].y, pcl.points[valid_indices[i]].z);
       point3d curr_ray = point - sensor_origin;
       
       point3d new_end = point + curr_ray.normalized() * occlusion_update_dist_m_;
       if (this->link_.octree->computeRayKeys(point, new_end, ray))
       {
-	  KeyRay::iterator occ = ray.begin(); // first point is the occupied one - skip it!
-	  KeyRay::iterator end = ray.end();
-	  
-	  if(occ!=end)
+	KeyRay::iterator occ = ray.begin(); // first point is the occupied one - skip it!
+	KeyRay::iterator end = ray.end();
+	
+	if(occ!=end)
+	{
+	  ++occ;
+	  for( unsigned int dist=1; occ!=end; ++dist, ++occ )
 	  {
-	    ++occ;
-	    for( unsigned int dist=1; occ!=end; ++dist, ++occ )
+	    std::pair<CellMap::iterator,bool> inserted = cell_map.insert( std::make_pair(*occ,shadow_cells.size()) );
+	    if( inserted.second )
+	    {
+	      ShadowCell cell;
+	      cell.key = *occ;
+	      cell.dist = dist;
+	      shadow_cells.push_back(cell);
+	    }
+	    else
 	    {
-	      typename TREE_TYPE::NodeType* voxel = this->link_.octree->search(*occ);
-			      
-	      if( voxel!=NULL )
-	      {
-		  if( !voxel->hasMeasurement() )
-		  {
-		      voxel->updateOccDist( dist );
-		      voxel->setMaxDist(max_nr_of_cells_in_occlusion);
-		  }
-	      }
-	      else
-	      {
-		  voxel = this->link_.octree->updateNode(*occ, false);
-		  // the occupancy probability will be ignored during an actual update with the following call:
-		  voxel->updateHasMeasurement(false);
-		  voxel->updateOccDist( dist );
-		  voxel->setMaxDist(max_nr_of_cells_in_occlusion);
-	      }
+	      ShadowCell& cell = shadow_cells[inserted.first->second];
+	      cell.dist = std::min(cell.dist,dist);
 	    }
 	  }
+	}
+      }
+    }
+    return update;
+  }
+  
+  TEMPT
+  void CSCOPE::commit( const PreparedUpdate& update )
+  {
+    if( this->link_.octree==NULL )
+      return;
+    
+    const std::vector<ShadowCell>& shadow_cells = static_cast<const ShadowCells&>(update).cells;
+    
+    double max_nr_of_cells_in_occlusion = 2*occlusion_update_dist_m_/this->link_.octree->getResolution();
+    
+    std::cout<<"\ncalculating occlusion for "<<shadow_cells.size()<<" voxels";
+    
+    // update existing nodes first, such that the searches aren't slowed down by the nodes created afterwards
+    std::vector<const ShadowCell*> new_cells;
+    BOOST_FOREACH( const ShadowCell& cell, shadow_cells )
+    {
+      typename TREE_TYPE::NodeType* voxel = this->link_.octree->search(cell.key);
+      
+      if( voxel==NULL )
+      {
+	new_cells.push_back(&cell);
+      }
+      else if( !voxel->hasMeasurement() )
+      {
+	// nothing to do if it was already registered at least as close to an occupied voxel
+	if( voxel->occDist()!=-1 && voxel->occDist()<=cell.dist && this->link_.octree->maxDist(voxel)==max_nr_of_cells_in_occlusion )
+	  continue;
+	
+	voxel->updateOccDist( cell.dist );
+	this->link_.octree->setMaxDist(voxel,max_nr_of_cells_in_occlusion);
       }
     }
+    
+    BOOST_FOREACH( const ShadowCell* cell, new_cells )
+    {
+      typename TREE_TYPE::NodeType* voxel = this->link_.octree->updateNode(cell->key, false);
+      // the occupancy probability will be ignored during an actual update with the following call:
+      voxel->updateHasMeasurement(false);
+      voxel->updateOccDist( cell->dist );
+      this->link_.octree->setMaxDist(voxel,max_nr_of_cells_in_occlusion);
+    }
   }
   
   TEMPT
@@ -44,9 +44,18 @@ namespace octomap
     if( voxel_map_publisher_.getNumSubscribers()==0 )
       return;
     
+    // use the current snapshot if available, such that ongoing insertions are not blocked
+    boost::shared_ptr<const TREE_TYPE> octree = this->link_.snapshots->current();
+    typename WorldRepresentation<TREE_TYPE>::ReadLock map_lock(*this->link_.octree_mutex, boost::defer_lock);
+    if( octree==NULL )
+    {
+      map_lock.lock();
+      octree = this->link_.octree;
+    }
+    
     visualization_msgs::MarkerArray occupiedNodesVis;
     // each array stores all cubes of a different size, one for each depth level:
-    occupiedNodesVis.markers.resize(this->link_.octree->getTreeDepth()+1);
+    occupiedNodesVis.markers.resize(octree->getTreeDepth()+1);
         
     std_msgs::ColorRGBA color;
     color.r = 0;
@@ -54,7 +63,7 @@ namespace octomap
     color.b = 1;
     color.a = 1;
     
-    for( typename TREE_TYPE::iterator it = this->link_.octree->begin(), end = this->link_.octree->end(); it!=end; ++it )
+    for( typename TREE_TYPE::iterator it = octree->begin(), end = octree->end(); it!=end; ++it )
     {
       double size = it.getSize();
       double x = it.getX();
@@ -67,7 +76,7 @@ namespace octomap
       cubeCenter.z = z;
       unsigned idx = it.getDepth();
       
-      if( this->link_.octree->isNodeOccupied(*it) )
+      if( octree->isNodeOccupied(*it) )
       {
 	double size = it.getSize();
 	assert(idx < occupiedNodesVis.markers.size());
@@ -78,7 +87,7 @@ namespace octomap
     
     for (unsigned i= 0; i < occupiedNodesVis.markers.size(); ++i)
     {
-      double size = this->link_.octree->getNodeSize(i);
+      double size = octree->getNodeSize(i);
       
       occupiedNodesVis.markers[i].header.frame_id = world_frame_name_;
       occupiedNodesVis.markers[i].header.stamp = ros::Time::now();
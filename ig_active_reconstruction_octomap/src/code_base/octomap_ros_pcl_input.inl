@@ -22,6 +22,10 @@
 #include <pcl/conversions.h>
 #include <pcl_conversions/pcl_conversions.h>
 #include <pcl_ros/transforms.h>
+#include <boost/foreach.hpp>
+#include <boost/bind.hpp>
+#include <boost/make_shared.hpp>
+#include <std_msgs/UInt64.h>
 
 namespace ig_active_reconstruction
 {
@@ -32,16 +36,67 @@ namespace world_representation
 namespace octomap
 {
   TEMPT
-  CSCOPE::RosPclInput( ros::NodeHandle nh, boost::shared_ptr< PclInput<TREE_TYPE,POINTCLOUD_TYPE> > pcl_input, std::string world_frame )
+  CSCOPE::Config::Config()
+  : async(false)
+  , queue_size(3)
+  {
+    
+  }
+  
+  TEMPT
+  CSCOPE::RosPclInput( ros::NodeHandle nh, boost::shared_ptr< PclInput<TREE_TYPE,POINTCLOUD_TYPE> > pcl_input, std::string world_frame, Config config )
   : nh_(nh)
   , pcl_input_(pcl_input)
+  , config_(config)
   , world_frame_name_(world_frame)
   , tf_listener_(ros::Duration(180))
+  , next_sequence_nr_(1)
+  , shutdown_(false)
   {
+    if( config_.queue_size==0 )
+      config_.queue_size = 1;
+    
+    if( config_.async )
+      integration_thread_ = boost::thread( boost::bind(&CSCOPE::integrationLoop,this) );
+    
+    integrated_publisher_ = nh_.advertise<std_msgs::UInt64>("pcl_input_integrated",10);
+    dropped_publisher_ = nh_.advertise<std_msgs::UInt64>("pcl_input_dropped",10);
     pcl_subscriber_ = nh_.subscribe("pcl_input",10,&CSCOPE::insertCloudCallback,this);
     pcl_input_service_ = nh_.advertiseService("pcl_input", &CSCOPE::insertCloudService,this);
   }
   
+  TEMPT
+  CSCOPE::~RosPclInput()
+  {
+    pcl_subscriber_.shutdown();
+    pcl_input_service_.shutdown();
+    {
+      boost::mutex::scoped_lock lock(queue_mutex_);
+      shutdown_ = true;
+    }
+    queue_changed_.notify_all();
+    if( integration_thread_.joinable() )
+      integration_thread_.join();
+  }
+  
+  TEMPT
+  typename CSCOPE::CloudState CSCOPE::waitForIntegration( uint64_t sequence_nr, ros::Duration timeout )
+  {
+    boost::system_time deadline = boost::get_system_time() + boost::posix_time::microseconds( timeout.toNSec()/1000 );
+    
+    boost::mutex::scoped_lock lock(queue_mutex_);
+    while( true )
+    {
+      typename std::map<uint64_t,CloudState>::iterator state = states_.find(sequence_nr);
+      if( state==states_.end() )
+	return UNKNOWN;
+      if( state->second!=PENDING )
+	return state->second;
+      if( !state_changed_.timed_wait(lock,deadline) )
+	return PENDING;
+    }
+  }
+  
   TEMPT
   void CSCOPE::addInputDoneSignalCall( boost::function<void()> signal_call )
   {
@@ -52,27 +107,154 @@ namespace octomap
   void CSCOPE::insertCloudCallback(const sensor_msgs::PointCloud2::ConstPtr& cloud)
   {
     ROS_INFO("Received new pointcloud. Inserting...");
-    POINTCLOUD_TYPE pc;
-    pcl::fromROSMsg(*cloud, pc);
-    
-    insertCloud(pc);
-    ROS_INFO("Inserted new pointcloud");
+    bool queued;
+    receiveCloud(cloud,queued);
+    if( !queued )
+      ROS_INFO("Inserted new pointcloud");
   }
   
   TEMPT
   bool CSCOPE::insertCloudService( ig_active_reconstruction_msgs::PclInput::Request& req, ig_active_reconstruction_msgs::PclInput::Response& res)
   {
     ROS_INFO("Received new pointcloud. Inserting...");
-    POINTCLOUD_TYPE pc;
-    pcl::fromROSMsg(req.pointcloud, pc);
     
-    insertCloud(pc);
+    // take over the point data instead of copying it
+    sensor_msgs::PointCloud2::Ptr cloud = boost::make_shared<sensor_msgs::PointCloud2>();
+    cloud->data.swap(req.pointcloud.data);
+    cloud->header = req.pointcloud.header;
+    cloud->height = req.pointcloud.height;
+    cloud->width = req.pointcloud.width;
+    cloud->fields = req.pointcloud.fields;
+    cloud->is_bigendian = req.pointcloud.is_bigendian;
+    cloud->point_step = req.pointcloud.point_step;
+    cloud->row_step = req.pointcloud.row_step;
+    cloud->is_dense = req.pointcloud.is_dense;
     
-    ROS_INFO("Inserted new pointcloud");
-    res.success = true;
+    bool queued;
+    res.sequence_nr = receiveCloud(cloud,queued);
+    res.queued = queued;
+    
+    if( queued )
+    {
+      res.success = true;
+    }
+    else
+    {
+      boost::mutex::scoped_lock lock(queue_mutex_);
+      res.success = states_[res.sequence_nr]==INTEGRATED;
+    }
+    if( !queued )
+      ROS_INFO("Inserted new pointcloud");
     return true;
   }
   
+  TEMPT
+  uint64_t CSCOPE::receiveCloud( const sensor_msgs::PointCloud2::ConstPtr& cloud, bool& queued )
+  {
+    QueuedCloud new_cloud;
+    new_cloud.cloud = cloud;
+    
+    // the pose is looked up right away: by the time a queued cloud is integrated, the sensor has moved on
+    bool has_pose = lookupSensorToWorld(cloud->header.frame_id,new_cloud.sensor_to_world);
+    
+    std::vector<uint64_t> dropped;
+    {
+      boost::mutex::scoped_lock lock(queue_mutex_);
+      new_cloud.sequence_nr = next_sequence_nr_++;
+      
+      queued = has_pose && config_.async;
+      if( !has_pose )
+      {
+	setState(new_cloud.sequence_nr,DROPPED);
+	dropped.push_back(new_cloud.sequence_nr);
+      }
+      else
+      {
+	setState(new_cloud.sequence_nr,PENDING);
+      }
+      
+      if( queued )
+      {
+	if( queue_.size()>=config_.queue_size )
+	{
+	  setState(queue_.front().sequence_nr,DROPPED);
+	  dropped.push_back(queue_.front().sequence_nr);
+	  queue_.pop_front();
+	  ROS_WARN("RosPclInput<TREE_TYPE,POINTCLOUD_TYPE>::Input queue is full, dropped the oldest queued pointcloud.");
+	}
+	queue_.push_back(new_cloud);
+      }
+    }
+    publishDropped(dropped);
+    
+    if( queued )
+      queue_changed_.notify_one();
+    else if( has_pose )
+      integrate(new_cloud);
+    
+    return new_cloud.sequence_nr;
+  }
+  
+  TEMPT
+  void CSCOPE::integrationLoop()
+  {
+    while( true )
+    {
+      QueuedCloud next_cloud;
+      {
+	boost::mutex::scoped_lock lock(queue_mutex_);
+	while( queue_.empty() && !shutdown_ )
+	{
+	  queue_changed_.wait(lock);
+	}
+	if( queue_.empty() )
+	  return;
+	
+	next_cloud = queue_.front();
+	queue_.pop_front();
+      }
+      integrate(next_cloud);
+    }
+  }
+  
+  TEMPT
+  void CSCOPE::integrate( QueuedCloud& queued_cloud )
+  {
+    insertCloud(*queued_cloud.cloud,queued_cloud.sensor_to_world);
+    {
+      boost::mutex::scoped_lock lock(queue_mutex_);
+      setState(queued_cloud.sequence_nr,INTEGRATED);
+    }
+    
+    std_msgs::UInt64 msg;
+    msg.data = queued_cloud.sequence_nr;
+    integrated_publisher_.publish(msg);
+  }
+  
+  TEMPT
+  void CSCOPE::setState( uint64_t sequence_nr, CloudState state )
+  {
+    states_[sequence_nr] = state;
+    
+    // only the states of the most recent clouds are kept
+    while( states_.size()>1000 )
+    {
+      states_.erase(states_.begin());
+    }
+    state_changed_.notify_all();
+  }
+  
+  TEMPT
+  void CSCOPE::publishDropped( const std::vector<uint64_t>& sequence_nrs )
+  {
+    BOOST_FOREACH( uint64_t sequence_nr, sequence_nrs )
+    {
+      std_msgs::UInt64 msg;
+      msg.data = sequence_nr;
+      dropped_publisher_.publish(msg);
+    }
+  }
+  
   TEMPT
   void CSCOPE::issueInputDoneSignals()
   {
@@ -83,30 +265,79 @@ namespace octomap
   }
   
   TEMPT
-  void CSCOPE::insertCloud( POINTCLOUD_TYPE& pointcloud )
+  void CSCOPE::insertCloud( const sensor_msgs::PointCloud2& cloud, const Eigen::Transform<double,3,Eigen::Affine>& sensor_to_world )
+  {
+    RawPointCloud raw_cloud;
+    if( !getRawPointCloud(cloud,raw_cloud) || !pcl_input_->pushRaw(sensor_to_world,raw_cloud) )
+    {
+      POINTCLOUD_TYPE pointcloud;
+      pcl::fromROSMsg(cloud, pointcloud);
+      pcl_input_->push(sensor_to_world,pointcloud);
+    }
+    
+    issueInputDoneSignals();
+  }
+  
+  TEMPT
+  bool CSCOPE::lookupSensorToWorld( const std::string& frame_id, Eigen::Transform<double,3,Eigen::Affine>& sensor_to_world )
   {
     tf::StampedTransform sensor_to_world_tf;
     try
     {
-      tf_listener_.lookupTransform(world_frame_name_, pointcloud.header.frame_id, ros::Time(0), sensor_to_world_tf);
+      tf_listener_.lookupTransform(world_frame_name_, frame_id, ros::Time(0), sensor_to_world_tf);
     }
     catch(tf::TransformException& ex)
     {
       ROS_ERROR_STREAM( "RosPclInput<TREE_TYPE,POINTCLOUD_TYPE>::Transform error of sensor data: " << ex.what() << ", quitting callback.");
-      return;
+      return false;
     }
     
-    Eigen::Matrix4f sensor_to_world;
-    pcl_ros::transformAsMatrix(sensor_to_world_tf, sensor_to_world);
-    
-    Eigen::Transform<double,3,Eigen::Affine> sensor_to_world_transform;
-    sensor_to_world_transform = sensor_to_world.cast<double>();
-    
-    pcl_input_->push(sensor_to_world_transform,pointcloud);
+    Eigen::Matrix4f sensor_to_world_mat;
+    pcl_ros::transformAsMatrix(sensor_to_world_tf, sensor_to_world_mat);
     
+    sensor_to_world = sensor_to_world_mat.cast<double>();
+    return true;
+  }
+  
+  TEMPT
+  bool CSCOPE::getRawPointCloud( const sensor_msgs::PointCloud2& cloud, RawPointCloud& raw_cloud )
+  {
+    const uint16_t endianness_test = 1;
+    bool host_is_bigendian = *reinterpret_cast<const uint8_t*>(&endianness_test)==0;
+    if( cloud.is_bigendian!=host_is_bigendian || cloud.data.empty() )
+      return false;
     
+    bool found_x = false, found_y = false, found_z = false;
+    BOOST_FOREACH( const sensor_msgs::PointField& field, cloud.fields )
+    {
+      if( field.datatype!=sensor_msgs::PointField::FLOAT32 || field.count!=1 )
+	continue;
+      
+      if( field.name=="x" )
+      {
+	raw_cloud.x_offset = field.offset;
+	found_x = true;
+      }
+      else if( field.name=="y" )
+      {
+	raw_cloud.y_offset = field.offset;
+	found_y = true;
+      }
+      else if( field.name=="z" )
+      {
+	raw_cloud.z_offset = field.offset;
+	found_z = true;
+      }
+    }
+    if( !found_x || !found_y || !found_z )
+      return false;
     
-    issueInputDoneSignals();
+    raw_cloud.data = &cloud.data[0];
+    raw_cloud.width = cloud.width;
+    raw_cloud.height = cloud.height;
+    raw_cloud.point_step = cloud.point_step;
+    raw_cloud.row_step = cloud.row_step;
+    return true;
   }
   
 }
@@ -0,0 +1,235 @@
+/* Copyright (c) 2016, Stefan Isler, islerstefan@bluewin.ch
+ * (ETH Zurich / Robotics and Perception Group, University of Zurich, Switzerland)
+ *
+ * This file is part of ig_active_reconstruction, software for information gain based, active reconstruction.
+ *
+ * ig_active_reconstruction is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * ig_active_reconstruction is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ * Please refer to the GNU Lesser General Public License for details on the license,
+ * on <http://www.gnu.org/licenses/>.
+*/
+
+#define TEMPT template<class TREE_TYPE, class METRIC_SET>
+#define CSCOPE StaticRayIgCalculator<TREE_TYPE,METRIC_SET>
+
+#include <stdexcept>
+#include <boost/bind.hpp>
+#include <boost/foreach.hpp>
+#include <boost/make_shared.hpp>
+
+namespace ig_active_reconstruction
+{
+  
+namespace world_representation
+{
+
+namespace octomap
+{
+  TEMPT
+  CSCOPE::StaticRayIgCalculator( Config config )
+  : BasicRayIgCalculator<TREE_TYPE>(config)
+  , ig_config_(config.ig_config)
+  {
+    METRIC_SET prototypes;
+    boost::fusion::for_each( prototypes, Configure(ig_config_) );
+    boost::fusion::for_each( prototypes, Register(this) );
+    
+    nr_of_static_metrics_ = this->ig_factory_.end() - this->ig_factory_.begin();
+  }
+  
+  TEMPT
+  typename CSCOPE::ResultInformation CSCOPE::computeViewIg(IgRetrievalCommand& command, ViewIgRetrievalResult& output_ig)
+  {
+    if( command.path.empty() )
+      return BasicRayIgCalculator<TREE_TYPE>::computeViewIg(command,output_ig);
+    
+    // find the requested metrics in the set, anything else is left to the dynamic calculation
+    std::vector<unsigned int> requested_ids;
+    if( !command.metric_ids.empty() )
+    {
+      requested_ids = command.metric_ids;
+    }
+    else
+    {
+      BOOST_FOREACH( std::string& name, command.metric_names )
+      {
+	try
+	{
+	  requested_ids.push_back( this->ig_factory_.idOf(name) );
+	}
+	catch( std::invalid_argument& )
+	{
+	  return BasicRayIgCalculator<TREE_TYPE>::computeViewIg(command,output_ig);
+	}
+      }
+    }
+    BOOST_FOREACH( unsigned int& id, requested_ids )
+    {
+      if( id>=nr_of_static_metrics_ )
+	return BasicRayIgCalculator<TREE_TYPE>::computeViewIg(command,output_ig);
+    }
+    
+    output_ig.clear();
+    
+    // cast rays - all metrics of the set are evaluated, even if only some were requested
+    typename WorldRepresentation<TREE_TYPE>::ReadLock map_lock(*this->link_.octree_mutex, boost::defer_lock);
+    boost::shared_ptr<const TREE_TYPE> octree = this->pinOctree(map_lock);
+    
+    RayCastSettings ray_cast_settings;
+    ray_cast_settings.max_ray_depth = this->config_.ray_caster_config.max_ray_depth_m;
+    ray_cast_settings.octree = octree.get();
+    
+    RayCaster::RayBatch& rays = this->rayBuffer();
+    std::vector<unsigned int> ray_weights;
+    typename InformationGain<TREE_TYPE>::Config ig_config = this->withLookupTable(ig_config_);
+    this->getViewRays(command.path[0],command.config,ig_config,ray_cast_settings,rays,ray_weights);
+    METRIC_SET metrics;
+    boost::fusion::for_each( metrics, Configure(ig_config) );
+    boost::fusion::for_each( metrics, SetOctree(octree.get()) );
+    
+    size_t nr_of_rays = rays.size();
+    if( this->worker_pool_==NULL || nr_of_rays<=this->config_.rays_per_chunk )
+    {
+      calculateIgsOnRays( &rays, &ray_weights, 0, nr_of_rays, ray_cast_settings, &ig_config, &metrics );
+    }
+    else
+    {
+      size_t nr_of_chunks = (nr_of_rays+this->config_.rays_per_chunk-1)/this->config_.rays_per_chunk;
+      
+      std::vector<METRIC_SET> chunk_metrics(nr_of_chunks,metrics);
+      std::vector<WorkerPool::Task> tasks;
+      for( size_t i=0; i<nr_of_chunks; ++i )
+      {
+	size_t first = i*this->config_.rays_per_chunk;
+	size_t last = std::min( first+this->config_.rays_per_chunk, nr_of_rays );
+	
+	tasks.push_back( boost::bind(&CSCOPE::calculateIgsOnRays, this, &rays, &ray_weights, first, last, ray_cast_settings, &ig_config, &chunk_metrics[i]) );
+      }
+      this->worker_pool_->run(tasks);
+      
+      std::vector< InformationGain<TREE_TYPE>* > total;
+      boost::fusion::for_each( metrics, Collect(total) );
+      BOOST_FOREACH( METRIC_SET& chunk, chunk_metrics )
+      {
+	std::vector< InformationGain<TREE_TYPE>* > partial;
+	boost::fusion::for_each( chunk, Collect(partial) );
+	for( size_t i=0; i<total.size(); ++i )
+	{
+	  total[i]->merge( *partial[i] );
+	}
+      }
+    }
+    
+    // retrieve information gains and build output
+    std::vector< InformationGain<TREE_TYPE>* > results;
+    boost::fusion::for_each( metrics, Collect(results) );
+    
+    BOOST_FOREACH( unsigned int& id, requested_ids )
+    {
+      IgRetrievalResult res;
+      res.status = ResultInformation::SUCCEEDED;
+      res.predicted_gain = results[id]->getInformation();
+      output_ig.push_back(res);
+    }
+    
+    return ResultInformation::SUCCEEDED;
+  }
+  
+  TEMPT
+  void CSCOPE::calculateIgsOnRays( const RayCaster::RayBatch* rays, const std::vector<unsigned int>* ray_weights, size_t first, size_t last, RayCastSettings setting, const typename InformationGain<TREE_TYPE>::Config* ig_config, METRIC_SET* metrics )
+  {
+    typename InformationGain<TREE_TYPE>::Utils utils(*ig_config);
+    MetricSetSink sink(*metrics,utils);
+    
+    std::vector< InformationGain<TREE_TYPE>* > total;
+    boost::fusion::for_each( *metrics, Collect(total) );
+    
+    // scratch metrics for weighted rays
+    typename InformationGain<TREE_TYPE>::Config ray_config = *ig_config;
+    METRIC_SET ray_metrics;
+    boost::fusion::for_each( ray_metrics, Configure(ray_config) );
+    boost::fusion::for_each( ray_metrics, SetOctree(setting.octree) );
+    MetricSetSink ray_sink(ray_metrics,utils);
+    std::vector< InformationGain<TREE_TYPE>* > partial;
+    boost::fusion::for_each( ray_metrics, Collect(partial) );
+    
+    for( size_t i=first; i<last; ++i )
+    {
+      unsigned int weight = ray_weights->empty()? 1 : (*ray_weights)[i];
+      if( weight==1 )
+      {
+	this->traverseRay( rays->origin, rays->direction(i), setting, sink );
+	continue;
+      }
+      
+      for( size_t j=0; j<partial.size(); ++j )
+      {
+	partial[j]->reset();
+      }
+      
+      // merging with the weight is equivalent to evaluating the ray weight times
+      this->traverseRay( rays->origin, rays->direction(i), setting, ray_sink );
+      for( size_t j=0; j<total.size(); ++j )
+      {
+	total[j]->merge( *partial[j], weight );
+      }
+    }
+  }
+  
+  TEMPT
+  template<class IG_METRIC_TYPE>
+  boost::shared_ptr< InformationGain<TREE_TYPE> > CSCOPE::makeShared( typename InformationGain<TREE_TYPE>::Config utils )
+  {
+    return boost::shared_ptr< InformationGain<TREE_TYPE> >( new IG_METRIC_TYPE( this->withLookupTable(utils) ) );
+  }
+  
+  TEMPT
+  template<class IG_METRIC_TYPE>
+  void CSCOPE::Register::operator()( IG_METRIC_TYPE& metric ) const
+  {
+    boost::function< boost::shared_ptr< InformationGain<TREE_TYPE> >() > creator;
+    creator = boost::bind(&CSCOPE::template makeShared<IG_METRIC_TYPE>, calculator, calculator->ig_config_);
+    
+    calculator->ig_factory_.add(metric.type(),creator);
+  }
+  
+  TEMPT
+  void CSCOPE::MetricSetSink::startRay()
+  {
+    boost::fusion::for_each( metrics_, MakeReadyForNewRay() );
+  }
+  
+  TEMPT
+  void CSCOPE::MetricSetSink::includeRayMeasurement( typename TREE_TYPE::NodeType* node )
+  {
+    typename InformationGain<TREE_TYPE>::Voxel voxel(node,utils_);
+    boost::fusion::for_each( metrics_, IncludeRayMeasurement(voxel) );
+  }
+  
+  TEMPT
+  void CSCOPE::MetricSetSink::includeEndPointMeasurement( typename TREE_TYPE::NodeType* node )
+  {
+    typename InformationGain<TREE_TYPE>::Voxel voxel(node,utils_);
+    boost::fusion::for_each( metrics_, IncludeEndPointMeasurement(voxel) );
+  }
+  
+  TEMPT
+  void CSCOPE::MetricSetSink::informAboutVoidRay()
+  {
+    boost::fusion::for_each( metrics_, InformAboutVoidRay() );
+  }
+  
+}
+
+}
+
+}
+
+#undef CSCOPE
+#undef TEMPT
\ No newline at end of file
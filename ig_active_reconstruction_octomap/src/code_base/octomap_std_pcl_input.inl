@@ -19,6 +19,13 @@
 #define CSCOPE StdPclInput<TREE_TYPE, POINTCLOUD_TYPE>
 
 #include <limits>
+#include <cstring>
+#include <algorithm>
+#include <boost/bind.hpp>
+#include <boost/foreach.hpp>
+#include <boost/make_shared.hpp>
+#include <boost/unordered_map.hpp>
+#include <boost/math/special_functions/fpclassify.hpp>
 
 #include <pcl/common/transforms.h>
 #include <pcl/filters/passthrough.h>
@@ -38,6 +45,10 @@ namespace octomap
   , bounding_box_min_point_m( -std::numeric_limits<double>::max(), -std::numeric_limits<double>::max(), -std::numeric_limits<double>::max() )
   , bounding_box_max_point_m( std::numeric_limits<double>::max(), std::numeric_limits<double>::max(), std::numeric_limits<double>::max() )
   , max_sensor_range_m(-1)
+  , nr_of_threads(0)
+  , points_per_chunk(10000)
+  , bin_points_by_voxel(false)
+  , cast_rays_to_centroids(false)
   {
     
   }
@@ -46,7 +57,13 @@ namespace octomap
   CSCOPE::StdPclInput( Config config )
   : config_(config)
   {
+    unsigned int nr_of_threads = (config_.nr_of_threads!=0)?config_.nr_of_threads:boost::thread::hardware_concurrency();
+    if( config_.points_per_chunk==0 )
+      config_.points_per_chunk = 1;
     
+    // the thread calling push takes part in the computation
+    if( nr_of_threads>1 )
+      worker_pool_ = boost::make_shared<WorkerPool>(nr_of_threads-1);
   }
   
   TEMPT
@@ -83,12 +100,72 @@ namespace octomap
     
     pcl::removeNaNFromPointCloud(*pc_cpy,valid_indices);
     
-    std::cout<<"Inserting "<<pc_cpy->points.size()<<" valid points.";
+    integrate(sensor_to_world.translation(),pc_cpy,valid_indices);
+  }
+  
+  TEMPT
+  bool CSCOPE::pushRaw( const Eigen::Transform<double,3,Eigen::Affine>& sensor_to_world, const RawPointCloud& pcl )
+  {
+    // transform, bounding box and NAN check in a single pass over the buffer, only valid points are copied
+    typename POINTCLOUD_TYPE::Ptr pc = boost::make_shared<POINTCLOUD_TYPE>();
+    pc->points.reserve( (size_t)pcl.width*pcl.height );
     
+    const ::octomap::point3d& bb_min = config_.bounding_box_min_point_m;
+    const ::octomap::point3d& bb_max = config_.bounding_box_max_point_m;
     
-    // insert points into octree through raycasting
-    Eigen::Vector3d sensor_position = sensor_to_world.translation();
+    for( unsigned int row=0; row<pcl.height; ++row )
+    {
+      const unsigned char* point_data = pcl.data + (size_t)row*pcl.row_step;
+      for( unsigned int col=0; col<pcl.width; ++col, point_data+=pcl.point_step )
+      {
+	float x, y, z;
+	std::memcpy( &x, point_data+pcl.x_offset, sizeof(float) );
+	std::memcpy( &y, point_data+pcl.y_offset, sizeof(float) );
+	std::memcpy( &z, point_data+pcl.z_offset, sizeof(float) );
+	
+	if( !boost::math::isfinite(x) || !boost::math::isfinite(y) || !boost::math::isfinite(z) )
+	  continue;
+	
+	Eigen::Vector3d world_point = sensor_to_world*Eigen::Vector3d(x,y,z);
+	typename POINTCLOUD_TYPE::PointType point;
+	point.x = world_point(0);
+	point.y = world_point(1);
+	point.z = world_point(2);
+	
+	if( config_.use_bounding_box &&
+	  ( point.x<bb_min.x() || point.x>bb_max.x() || point.y<bb_min.y() || point.y>bb_max.y() || point.z<bb_min.z() || point.z>bb_max.z() ) )
+	  continue;
+	
+	pc->points.push_back(point);
+      }
+    }
+    pc->width = pc->points.size();
+    pc->height = 1;
+    pc->is_dense = true;
     
+    std::vector<int> valid_indices( pc->points.size() );
+    for( size_t i=0; i<valid_indices.size(); ++i )
+    {
+      valid_indices[i] = i;
+    }
+    
+    integrate(sensor_to_world.translation(),pc,valid_indices);
+    return true;
+  }
+  
+  TEMPT
+  void CSCOPE::integrate( const Eigen::Vector3d& sensor_position, typename POINTCLOUD_TYPE::Ptr pc_cpy, std::vector<int>& valid_indices )
+  {
+    std::cout<<"Inserting "<<valid_indices.size()<<" valid points.";
+    
+    if( config_.bin_points_by_voxel )
+    {
+      binPointsByVoxel(pc_cpy,valid_indices);
+      std::cout<<"\nCasting rays to "<<valid_indices.size()<<" voxels.";
+    }
+    
+    
+    // insert points into octree through raycasting
     using ::octomap::point3d;
     using ::octomap::KeySet;
     using ::octomap::KeyRay;
@@ -97,48 +174,65 @@ namespace octomap
     point3d sensor_origin(sensor_position(0),sensor_position(1),sensor_position(2));
     
     
-    // build sets of free and occupied voxels
+    // the occlusion calculator can prepare its update concurrently to the computation of the first wave below if it supports it
+    boost::shared_ptr<typename OcclusionCalculator<TREE_TYPE,POINTCLOUD_TYPE>::PreparedUpdate> occlusion_update;
+    bool prepare_occlusions = this->occlusion_calculator_!=NULL && worker_pool_!=NULL;
+    
+    // build sets of free and occupied voxels: The key rays of the points are computed chunk-wise in parallel, in waves of two chunks
+    // per thread. The keys of the chunks are then inserted into the sets ray by ray and in order, i.e. exactly as if they were computed
+    // serially. The iteration order of the sets and with it the order of the node updates below (which matters e.g. for pruned nodes
+    // without measurement) thus doesn't depend on the number of threads.
     KeySet free_cells, occupied_cells;
-    KeyRay key_ray_temp;
     
-    typename POINTCLOUD_TYPE::const_iterator it, end;
-    //for(it = pc_cpy->begin(), end = pc_cpy->end(); it != end; ++it)
-    for( size_t i = 0; i<valid_indices.size(); ++i )
+    size_t nr_of_points = valid_indices.size();
+    size_t nr_of_chunks = (nr_of_points+config_.points_per_chunk-1)/config_.points_per_chunk;
+    size_t chunks_per_wave = (worker_pool_!=NULL)? 2*(worker_pool_->size()+1) : 1;
+    
+    std::vector<KeyChunk> chunks(chunks_per_wave);
+    for( size_t wave_start=0; wave_start<nr_of_chunks; wave_start+=chunks_per_wave )
     {
-      //point3d point(it->x, it->y, it->z);
-      point3d point(pc_cpy->points[valid_indices[i]].x, pc_cpy->points[valid_indices[i]].y, pc_cpy->points[valid_indices[i]].z);
-      // maxrange check
-      point3d curr_ray = point - sensor_origin;
+      size_t wave_end = std::min( wave_start+chunks_per_wave, nr_of_chunks );
       
-      if(i%100==0)
-	std::cout<<"\nBuilding iterator set: "<<i<<"/"<<valid_indices.size();
+      std::vector<WorkerPool::Task> tasks;
+      if( wave_start==0 && prepare_occlusions )
+	tasks.push_back( boost::bind(&CSCOPE::prepareOcclusions, this, &sensor_position, pc_cpy.get(), &valid_indices, &occlusion_update) );
       
-      if ((config_.max_sensor_range_m< 0.0) || (curr_ray.norm() <= (config_.max_sensor_range_m+0.000001)) )
+      for( size_t i=wave_start; i<wave_end; ++i )
       {
-	// free cells
-	if(this->link_.octree->computeRayKeys(sensor_origin, point, key_ray_temp))
-	{
-	  free_cells.insert(key_ray_temp.begin(), key_ray_temp.end());
-	}
-	// occupied endpoint
-	OcTreeKey key;
-	if(this->link_.octree->coordToKeyChecked(point, key))
+	size_t first = i*config_.points_per_chunk;
+	size_t last = std::min( first+config_.points_per_chunk, nr_of_points );
+	tasks.push_back( boost::bind(&CSCOPE::computeKeys, this, &sensor_origin, pc_cpy.get(), &valid_indices, first, last, &chunks[i-wave_start]) );
+      }
+      if( worker_pool_!=NULL && tasks.size()>1 )
+      {
+	worker_pool_->run(tasks);
+      }
+      else
+      {
+	BOOST_FOREACH( WorkerPool::Task& task, tasks )
 	{
-	  occupied_cells.insert(key);
+	  task();
 	}
       }
-      else
+      
+      for( size_t i=0; i<wave_end-wave_start; ++i )
       {
-	// ray longer than max range
-	point3d new_end = sensor_origin + curr_ray.normalized() * config_.max_sensor_range_m;
-	if (this->link_.octree->computeRayKeys(sensor_origin, new_end, key_ray_temp))
+	KeyChunk& chunk = chunks[i];
+	size_t ray_start = 0;
+	BOOST_FOREACH( size_t ray_end, chunk.ray_ends )
 	{
-	  free_cells.insert(key_ray_temp.begin(), key_ray_temp.end());
+	  free_cells.insert( chunk.free_cells.begin()+ray_start, chunk.free_cells.begin()+ray_end );
+	  ray_start = ray_end;
+	}
+	BOOST_FOREACH( OcTreeKey& key, chunk.occupied_cells )
+	{
+	  occupied_cells.insert(key);
 	}
       }
     }
     
-    // update occupancy likelihoods
+    // update occupancy likelihoods - only this commit phase needs exclusive access to the octree, the key sets above only depend on its geometry
+    typename WorldRepresentation<TREE_TYPE>::WriteLock map_lock(*this->link_.octree_mutex);
     
     // mark free cells only if not seen occupied in this cloud - attention: voxels may already exist even though no actual measurement has yet been received at their position (e.g. if their occlusion distance was calculated) - need to check hasMeasurement()!
     size_t count = 0;
@@ -174,7 +268,7 @@ namespace octomap
     
     count = 0;
     // now mark all occupied cells:
-    for (KeySet::iterator it = occupied_cells.begin(), end=free_cells.end(); it!= end; ++it)
+    for (KeySet::iterator it = occupied_cells.begin(), end=occupied_cells.end(); it!= end; ++it)
     {
       if( count++%100==0)
 	std::cout<<"\nInserting occupied: "<<count<<"/"<<occupied_cells.size();
@@ -203,12 +297,149 @@ namespace octomap
     if( this->occlusion_calculator_!=NULL )
     {
       std::cout<<"\nCalling occlusion calculator";
-      this->occlusion_calculator_->insert(sensor_position,*pc_cpy,valid_indices);
+      if( occlusion_update!=NULL )
+	this->occlusion_calculator_->commit(*occlusion_update);
+      else
+	this->occlusion_calculator_->insert(sensor_position,*pc_cpy,valid_indices);
     }
     
+    // publish the new version for readers - they keep working on the previous snapshot until then
+    map_lock.unlock();
+    typename WorldRepresentation<TREE_TYPE>::ReadLock read_lock(*this->link_.octree_mutex);
+    this->link_.snapshots->publish(*this->link_.octree);
+    
     std::cout<<"\nFinsihed calculations";
   }
   
+  TEMPT
+  void CSCOPE::prepareOcclusions( const Eigen::Vector3d* sensor_position, const POINTCLOUD_TYPE* pc, std::vector<int>* indices, boost::shared_ptr<typename OcclusionCalculator<TREE_TYPE,POINTCLOUD_TYPE>::PreparedUpdate>* update )
+  {
+    *update = this->occlusion_calculator_->prepare(*sensor_position,*pc,*indices);
+  }
+  
+  TEMPT
+  void CSCOPE::binPointsByVoxel( typename POINTCLOUD_TYPE::Ptr& pc, std::vector<int>& indices )
+  {
+    using ::octomap::point3d;
+    using ::octomap::OcTreeKey;
+    
+    typedef boost::unordered_map<OcTreeKey, size_t, OcTreeKey::KeyHash> BinMap;
+    BinMap bin_map;
+    bin_map.rehash( indices.size()/4 );
+    std::vector<VoxelBin> bins; // in the order of the first point of each bin, such that the result doesn't depend on hashing
+    bins.reserve( indices.size()/4 );
+    std::vector<int> unbinned_indices;
+    
+    BOOST_FOREACH( int index, indices )
+    {
+      const typename POINTCLOUD_TYPE::PointType& point = pc->points[index];
+      OcTreeKey key;
+      if( !this->link_.octree->coordToKeyChecked( point3d(point.x,point.y,point.z), key ) )
+      {
+	unbinned_indices.push_back(index);
+	continue;
+      }
+      
+      std::pair<BinMap::iterator,bool> inserted = bin_map.insert( std::make_pair(key,bins.size()) );
+      if( inserted.second )
+      {
+	VoxelBin bin;
+	bin.first_index = index;
+	bin.x = point.x;
+	bin.y = point.y;
+	bin.z = point.z;
+	bin.nr_of_points = 1;
+	bins.push_back(bin);
+      }
+      else
+      {
+	VoxelBin& bin = bins[inserted.first->second];
+	bin.x += point.x;
+	bin.y += point.y;
+	bin.z += point.z;
+	++bin.nr_of_points;
+      }
+    }
+    
+    typename POINTCLOUD_TYPE::Ptr representatives = boost::make_shared<POINTCLOUD_TYPE>();
+    representatives->points.reserve( bins.size()+unbinned_indices.size() );
+    BOOST_FOREACH( VoxelBin& bin, bins )
+    {
+      typename POINTCLOUD_TYPE::PointType point = pc->points[bin.first_index];
+      if( config_.cast_rays_to_centroids )
+      {
+	point.x = bin.x/bin.nr_of_points;
+	point.y = bin.y/bin.nr_of_points;
+	point.z = bin.z/bin.nr_of_points;
+      }
+      representatives->points.push_back(point);
+    }
+    BOOST_FOREACH( int index, unbinned_indices )
+    {
+      representatives->points.push_back( pc->points[index] );
+    }
+    representatives->width = representatives->points.size();
+    representatives->height = 1;
+    representatives->is_dense = true;
+    
+    pc = representatives;
+    indices.resize( pc->points.size() );
+    for( size_t i=0; i<indices.size(); ++i )
+    {
+      indices[i] = i;
+    }
+  }
+  
+  TEMPT
+  void CSCOPE::computeKeys( const ::octomap::point3d* sensor_origin, const POINTCLOUD_TYPE* pc, const std::vector<int>* indices, size_t first, size_t last, KeyChunk* chunk )
+  {
+    using ::octomap::point3d;
+    using ::octomap::KeySet;
+    using ::octomap::KeyRay;
+    using ::octomap::OcTreeKey;
+    
+    chunk->free_cells.clear();
+    chunk->ray_ends.clear();
+    chunk->occupied_cells.clear();
+    
+    KeySet occupied_cells;
+    KeyRay key_ray_temp;
+    
+    for( size_t i = first; i<last; ++i )
+    {
+      const typename POINTCLOUD_TYPE::PointType& pcl_point = pc->points[ (*indices)[i] ];
+      point3d point(pcl_point.x, pcl_point.y, pcl_point.z);
+      // maxrange check
+      point3d curr_ray = point - *sensor_origin;
+      
+      if ((config_.max_sensor_range_m< 0.0) || (curr_ray.norm() <= (config_.max_sensor_range_m+0.000001)) )
+      {
+	// free cells
+	if(this->link_.octree->computeRayKeys(*sensor_origin, point, key_ray_temp))
+	{
+	  chunk->free_cells.insert( chunk->free_cells.end(), key_ray_temp.begin(), key_ray_temp.end() );
+	  chunk->ray_ends.push_back( chunk->free_cells.size() );
+	}
+	// occupied endpoint
+	OcTreeKey key;
+	if(this->link_.octree->coordToKeyChecked(point, key))
+	{
+	  if( occupied_cells.insert(key).second )
+	    chunk->occupied_cells.push_back(key);
+	}
+      }
+      else
+      {
+	// ray longer than max range
+	point3d new_end = *sensor_origin + curr_ray.normalized() * config_.max_sensor_range_m;
+	if (this->link_.octree->computeRayKeys(*sensor_origin, new_end, key_ray_temp))
+	{
+	  chunk->free_cells.insert( chunk->free_cells.end(), key_ray_temp.begin(), key_ray_temp.end() );
+	  chunk->ray_ends.push_back( chunk->free_cells.size() );
+	}
+      }
+    }
+  }
   
 }
 
@@ -0,0 +1,365 @@
+/* Copyright (c) 2016, Stefan Isler, islerstefan@bluewin.ch
+ * (ETH Zurich / Robotics and Perception Group, University of Zurich, Switzerland)
+ *
+ * This file is part of ig_active_reconstruction, software for information gain based, active reconstruction.
+ *
+ * ig_active_reconstruction is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * ig_active_reconstruction is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ * Please refer to the GNU Lesser General Public License for details on the license,
+ * on <http://www.gnu.org/licenses/>.
+*/
+
+#include "ig_active_reconstruction_octomap/octomap_voxel_block_map.hpp"
+
+namespace ig_active_reconstruction
+{
+  
+namespace world_representation
+{
+
+namespace octomap
+{
+  
+  VoxelBlockMap::VoxelBlockMap(double resolution_m)
+  : geometry_(resolution_m)
+  , nr_of_known_voxels_(0)
+  {
+    config_.resolution_m = resolution_m;
+    updateMapConfig();
+  }
+  
+  VoxelBlockMap::VoxelBlockMap(Config config)
+  : config_(config)
+  , geometry_(config.resolution_m)
+  , nr_of_known_voxels_(0)
+  {
+    updateMapConfig();
+  }
+  
+  VoxelBlockMap::VoxelBlockMap(const VoxelBlockMap& rhs)
+  : config_(rhs.config_)
+  , geometry_(rhs.config_.resolution_m)
+  , occupancy_threshold_log_(rhs.occupancy_threshold_log_)
+  , hit_log_(rhs.hit_log_)
+  , miss_log_(rhs.miss_log_)
+  , clamping_threshold_min_log_(rhs.clamping_threshold_min_log_)
+  , clamping_threshold_max_log_(rhs.clamping_threshold_max_log_)
+  , nr_of_known_voxels_(rhs.nr_of_known_voxels_)
+  {
+    blocks_.rehash( rhs.blocks_.bucket_count() );
+    for( BlockMap::const_iterator it = rhs.blocks_.begin(), end = rhs.blocks_.end(); it!=end; ++it )
+    {
+      blocks_.insert( std::make_pair(it->first, new Block(*it->second)) );
+    }
+  }
+  
+  VoxelBlockMap::~VoxelBlockMap()
+  {
+    clear();
+  }
+  
+  const VoxelBlockMap::Config& VoxelBlockMap::config() const
+  {
+    return config_;
+  }
+  
+  void VoxelBlockMap::clear()
+  {
+    for( BlockMap::iterator it = blocks_.begin(), end = blocks_.end(); it!=end; ++it )
+    {
+      delete it->second;
+    }
+    blocks_.clear();
+    nr_of_known_voxels_ = 0;
+  }
+  
+  size_t VoxelBlockMap::size() const
+  {
+    return nr_of_known_voxels_;
+  }
+  
+  size_t VoxelBlockMap::getNumberOfBlocks() const
+  {
+    return blocks_.size();
+  }
+  
+  double VoxelBlockMap::getResolution() const
+  {
+    return geometry_.getResolution();
+  }
+  
+  unsigned int VoxelBlockMap::getTreeDepth() const
+  {
+    return geometry_.getTreeDepth();
+  }
+  
+  double VoxelBlockMap::getNodeSize( unsigned int depth ) const
+  {
+    return geometry_.getNodeSize(depth);
+  }
+  
+  ::octomap::OcTreeKey VoxelBlockMap::coordToKey( const ::octomap::point3d& coord ) const
+  {
+    return geometry_.coordToKey(coord);
+  }
+  
+  bool VoxelBlockMap::coordToKeyChecked( const ::octomap::point3d& coord, ::octomap::OcTreeKey& key ) const
+  {
+    return geometry_.coordToKeyChecked(coord,key);
+  }
+  
+  double VoxelBlockMap::keyToCoord( ::octomap::key_type key ) const
+  {
+    return geometry_.keyToCoord(key);
+  }
+  
+  ::octomap::point3d VoxelBlockMap::keyToCoord( const ::octomap::OcTreeKey& key ) const
+  {
+    return geometry_.keyToCoord(key);
+  }
+  
+  bool VoxelBlockMap::computeRayKeys( const ::octomap::point3d& origin, const ::octomap::point3d& end, ::octomap::KeyRay& ray ) const
+  {
+    return geometry_.computeRayKeys(origin,end,ray);
+  }
+  
+  VoxelBlockMap::NodeType* VoxelBlockMap::search( const ::octomap::OcTreeKey& key, unsigned int depth ) const
+  {
+    if( depth!=0 && depth<getTreeDepth() )
+      return NULL;
+    
+    Block* block = searchBlock( blockKey(key) );
+    if( block==NULL )
+      return NULL;
+    
+    NodeType* voxel = &block->voxels[ voxelIndex(key) ];
+    return voxel->isKnown()? voxel : NULL;
+  }
+  
+  VoxelBlockMap::NodeType* VoxelBlockMap::search( const ::octomap::point3d& coord, unsigned int depth ) const
+  {
+    ::octomap::OcTreeKey key;
+    if( !coordToKeyChecked(coord,key) )
+      return NULL;
+    
+    return search(key,depth);
+  }
+  
+  VoxelBlockMap::NodeType* VoxelBlockMap::updateNode( const ::octomap::OcTreeKey& key, bool occupied )
+  {
+    return updateNode( key, occupied? hit_log_ : miss_log_ );
+  }
+  
+  VoxelBlockMap::NodeType* VoxelBlockMap::updateNode( const ::octomap::point3d& coord, bool occupied )
+  {
+    ::octomap::OcTreeKey key;
+    if( !coordToKeyChecked(coord,key) )
+      return NULL;
+    
+    return updateNode(key,occupied);
+  }
+  
+  VoxelBlockMap::NodeType* VoxelBlockMap::updateNode( const ::octomap::OcTreeKey& key, float log_odds_update )
+  {
+    NodeType* voxel = createVoxel(key);
+    
+    // nothing to do if the voxel is already clamped in the direction of the update
+    if( (log_odds_update>=0 && voxel->getLogOdds()>=clamping_threshold_max_log_) || (log_odds_update<=0 && voxel->getLogOdds()<=clamping_threshold_min_log_) )
+      return voxel;
+    
+    voxel->addValue(log_odds_update);
+    if( voxel->getLogOdds()<clamping_threshold_min_log_ )
+      voxel->setLogOdds(clamping_threshold_min_log_);
+    else if( voxel->getLogOdds()>clamping_threshold_max_log_ )
+      voxel->setLogOdds(clamping_threshold_max_log_);
+    
+    return voxel;
+  }
+  
+  bool VoxelBlockMap::isNodeOccupied( const NodeType* node ) const
+  {
+    return node->getLogOdds()>=occupancy_threshold_log_;
+  }
+  
+  bool VoxelBlockMap::isNodeOccupied( const NodeType& node ) const
+  {
+    return node.getLogOdds()>=occupancy_threshold_log_;
+  }
+  
+  VoxelBlockMap::iterator VoxelBlockMap::begin() const
+  {
+    return iterator(this,blocks_.begin());
+  }
+  
+  VoxelBlockMap::iterator VoxelBlockMap::end() const
+  {
+    return iterator(this,blocks_.end());
+  }
+  
+  VoxelBlockMap::Block* VoxelBlockMap::searchBlock( uint64_t block_key ) const
+  {
+    BlockMap::const_iterator it = blocks_.find(block_key);
+    return (it==blocks_.end())? NULL : it->second;
+  }
+  
+  VoxelBlockMap::NodeType* VoxelBlockMap::createVoxel( const ::octomap::OcTreeKey& key )
+  {
+    std::pair<BlockMap::iterator,bool> inserted = blocks_.insert( std::make_pair(blockKey(key),(Block*)NULL) );
+    if( inserted.second )
+    {
+      const ::octomap::key_type mask = ~::octomap::key_type(BLOCK_WIDTH-1);
+      inserted.first->second = new Block( ::octomap::OcTreeKey(key[0]&mask, key[1]&mask, key[2]&mask) );
+    }
+    Block& block = *inserted.first->second;
+    
+    NodeType& voxel = block.voxels[ voxelIndex(key) ];
+    if( !voxel.isKnown() )
+    {
+      voxel.setKnown();
+      ++block.nr_of_known_voxels;
+      ++nr_of_known_voxels_;
+    }
+    return &voxel;
+  }
+  
+  void VoxelBlockMap::updateMapConfig()
+  {
+    occupancy_threshold_log_ = ::octomap::logodds(config_.occupancy_threshold);
+    hit_log_ = ::octomap::logodds(config_.hit_probability);
+    miss_log_ = ::octomap::logodds(config_.miss_probability);
+    clamping_threshold_min_log_ = ::octomap::logodds(config_.clamping_threshold_min);
+    clamping_threshold_max_log_ = ::octomap::logodds(config_.clamping_threshold_max);
+  }
+  
+  
+  VoxelBlockMap::iterator::iterator( const VoxelBlockMap* map, BlockMap::const_iterator block )
+  : map_(map)
+  , block_(block)
+  , voxel_(0)
+  {
+    skipUnknown();
+  }
+  
+  VoxelBlockMap::iterator& VoxelBlockMap::iterator::operator++()
+  {
+    ++voxel_;
+    skipUnknown();
+    return *this;
+  }
+  
+  bool VoxelBlockMap::iterator::operator==( const iterator& rhs ) const
+  {
+    return block_==rhs.block_ && voxel_==rhs.voxel_;
+  }
+  
+  bool VoxelBlockMap::iterator::operator!=( const iterator& rhs ) const
+  {
+    return !(*this==rhs);
+  }
+  
+  VoxelBlockMap::NodeType& VoxelBlockMap::iterator::operator*() const
+  {
+    return block_->second->voxels[voxel_];
+  }
+  
+  VoxelBlockMap::NodeType* VoxelBlockMap::iterator::operator->() const
+  {
+    return &block_->second->voxels[voxel_];
+  }
+  
+  ::octomap::OcTreeKey VoxelBlockMap::iterator::getKey() const
+  {
+    const ::octomap::OcTreeKey& origin = block_->second->origin;
+    const unsigned int mask = BLOCK_WIDTH-1;
+    return ::octomap::OcTreeKey( origin[0] + (voxel_&mask), origin[1] + ((voxel_>>BLOCK_BITS)&mask), origin[2] + (voxel_>>(2*BLOCK_BITS)) );
+  }
+  
+  ::octomap::point3d VoxelBlockMap::iterator::getCoordinate() const
+  {
+    return map_->keyToCoord( getKey() );
+  }
+  
+  double VoxelBlockMap::iterator::getX() const
+  {
+    return map_->keyToCoord( getKey()[0] );
+  }
+  
+  double VoxelBlockMap::iterator::getY() const
+  {
+    return map_->keyToCoord( getKey()[1] );
+  }
+  
+  double VoxelBlockMap::iterator::getZ() const
+  {
+    return map_->keyToCoord( getKey()[2] );
+  }
+  
+  double VoxelBlockMap::iterator::getSize() const
+  {
+    return map_->getResolution();
+  }
+  
+  unsigned int VoxelBlockMap::iterator::getDepth() const
+  {
+    return map_->getTreeDepth();
+  }
+  
+  void VoxelBlockMap::iterator::skipUnknown()
+  {
+    if( map_==NULL )
+      return;
+    
+    BlockMap::const_iterator end = map_->blocks_.end();
+    while( block_!=end )
+    {
+      const Block& block = *block_->second;
+      for( ; voxel_<BLOCK_VOLUME; ++voxel_ )
+      {
+	if( block.voxels[voxel_].isKnown() )
+	  return;
+      }
+      ++block_;
+      voxel_ = 0;
+    }
+  }
+  
+  
+  NodeLookup<VoxelBlockMap>::NodeLookup( const VoxelBlockMap& map )
+  : map_(map)
+  , block_(NULL)
+  , block_key_(0)
+  , has_previous_(false)
+  {
+    
+  }
+  
+  NodeLookup<VoxelBlockMap>::NodeType* NodeLookup<VoxelBlockMap>::search( const ::octomap::OcTreeKey& key, unsigned int depth )
+  {
+    if( depth!=0 && depth<map_.getTreeDepth() )
+      return NULL;
+    
+    uint64_t block_key = VoxelBlockMap::blockKey(key);
+    if( !has_previous_ || block_key!=block_key_ )
+    {
+      block_ = map_.searchBlock(block_key);
+      block_key_ = block_key;
+      has_previous_ = true;
+    }
+    if( block_==NULL )
+      return NULL;
+    
+    VoxelBlockMap::NodeType* voxel = &block_->voxels[ VoxelBlockMap::voxelIndex(key) ];
+    return voxel->isKnown()? voxel : NULL;
+  }
+  
+}
+
+}
+
+}
\ No newline at end of file
@@ -0,0 +1,47 @@
+/* Copyright (c) 2016, Stefan Isler, islerstefan@bluewin.ch
+ * (ETH Zurich / Robotics and Perception Group, University of Zurich, Switzerland)
+ *
+ * This file is part of ig_active_reconstruction, software for information gain based, active reconstruction.
+ *
+ * ig_active_reconstruction is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * ig_active_reconstruction is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ * Please refer to the GNU Lesser General Public License for details on the license,
+ * on <http://www.gnu.org/licenses/>.
+*/
+
+#include "ig_active_reconstruction_octomap/octomap_voxel_block_map_world_representation.hpp"
+#include "ig_active_reconstruction_octomap/octomap_ray_occlusion_calculator.hpp"
+#include "ig_active_reconstruction_octomap/octomap_std_pcl_input_point_xyz.hpp"
+#include "ig_active_reconstruction_octomap/octomap_static_ray_ig_calculator_all_metrics.hpp"
+#include "ig_active_reconstruction_octomap/octomap_ros_pcl_input.hpp"
+#include "ig_active_reconstruction_octomap/octomap_ros_interface.hpp"
+
+namespace ig_active_reconstruction
+{
+  
+namespace world_representation
+{
+
+namespace octomap
+{
+  // The voxel block map backend is only used through templates, instantiate everything it supports here to have it compiled with the library.
+  // The projection ig calculator walks the octree hierarchy and is not available for it.
+  template class WorldRepresentation<VoxelBlockMap>;
+  template class StdPclInput< VoxelBlockMap, StdPclInputPointXYZ<VoxelBlockMap>::PclType >;
+  template class RayOcclusionCalculator< VoxelBlockMap, StdPclInputPointXYZ<VoxelBlockMap>::PclType >;
+  template class BasicRayIgCalculator<VoxelBlockMap>;
+  template class StaticRayIgCalculator< VoxelBlockMap, StaticRayIgCalculatorAllMetrics<VoxelBlockMap>::MetricSet >;
+  template class RosPclInput< VoxelBlockMap, StdPclInputPointXYZ<VoxelBlockMap>::PclType >;
+  template class RosInterface<VoxelBlockMap>;
+  
+}
+
+}
+
+}
\ No newline at end of file
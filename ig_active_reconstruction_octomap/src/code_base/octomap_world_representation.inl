@@ -28,10 +28,12 @@ namespace octomap
 {
   
   TEMPT
-  CSCOPE::WorldRepresentation( typename TREE_TYPE::Config config )
+  CSCOPE::WorldRepresentation( typename TREE_TYPE::Config config, typename Snapshots::Config snapshot_config )
   : octree_( boost::make_shared<TREE_TYPE>(config) )
+  , octree_mutex_( boost::make_shared<boost::shared_mutex>() )
+  , snapshots_( boost::make_shared<Snapshots>(snapshot_config,octree_,octree_mutex_) )
   {
-    
+    snapshots_->publish(*octree_);
   }
   
   TEMPT
@@ -40,6 +42,124 @@ namespace octomap
     
   }
   
+  TEMPT
+  CSCOPE::Snapshots::Config::Config()
+  : enabled(true)
+  , min_interval_s(0)
+  {
+    
+  }
+  
+  TEMPT
+  CSCOPE::Snapshots::Snapshots( Config config, boost::shared_ptr<const TREE_TYPE> octree, boost::shared_ptr<boost::shared_mutex> octree_mutex )
+  : config_(config)
+  , octree_(octree)
+  , octree_mutex_(octree_mutex)
+  , version_(0)
+  , pending_(false)
+  , stop_(false)
+  {
+    if( config_.enabled && config_.min_interval_s>0 && octree_!=NULL && octree_mutex_!=NULL )
+      publisher_ = boost::thread(&Snapshots::publishHeldBack,this);
+  }
+  
+  TEMPT
+  CSCOPE::Snapshots::~Snapshots()
+  {
+    {
+      boost::mutex::scoped_lock lock(mutex_);
+      stop_ = true;
+    }
+    pending_condition_.notify_all();
+    if( publisher_.joinable() )
+      publisher_.join();
+  }
+  
+  TEMPT
+  boost::shared_ptr<const TREE_TYPE> CSCOPE::Snapshots::current()
+  {
+    boost::mutex::scoped_lock lock(mutex_);
+    return current_;
+  }
+  
+  TEMPT
+  uint64_t CSCOPE::Snapshots::version()
+  {
+    boost::mutex::scoped_lock lock(mutex_);
+    return version_;
+  }
+  
+  TEMPT
+  void CSCOPE::Snapshots::publish( const TREE_TYPE& octree )
+  {
+    if( !config_.enabled )
+      return;
+    
+    {
+      boost::mutex::scoped_lock lock(mutex_);
+      pending_ = true;
+      if( publisher_.joinable() && current_!=NULL && boost::get_system_time() < last_publish_time_ + boost::posix_time::microseconds( static_cast<int64_t>(config_.min_interval_s*1e6) ) )
+      {
+	pending_condition_.notify_one(); // held back, the publisher thread takes it when the interval elapsed
+	return;
+      }
+    }
+    take(octree);
+  }
+  
+  TEMPT
+  void CSCOPE::Snapshots::take( const TREE_TYPE& octree )
+  {
+    // a modification is copied by whoever comes first, later takers find nothing pending anymore
+    boost::mutex::scoped_lock take_lock(take_mutex_);
+    {
+      boost::mutex::scoped_lock lock(mutex_);
+      if( !pending_ )
+	return;
+      pending_ = false; // the octree can't change during the copy, later modifications set it again
+    }
+    
+    // copy outside of the lock, only the swap itself is synchronized
+    boost::shared_ptr<const TREE_TYPE> snapshot = boost::make_shared<TREE_TYPE>(octree);
+    boost::shared_ptr<const TREE_TYPE> previous;
+    
+    boost::mutex::scoped_lock lock(mutex_);
+    previous = current_; // the previous snapshot is freed after the lock is released if no reader holds it anymore
+    current_ = snapshot;
+    last_publish_time_ = boost::get_system_time();
+    ++version_;
+  }
+  
+  TEMPT
+  void CSCOPE::Snapshots::publishHeldBack()
+  {
+    boost::posix_time::microseconds interval( static_cast<int64_t>(config_.min_interval_s*1e6) );
+    
+    boost::mutex::scoped_lock lock(mutex_);
+    while( !stop_ )
+    {
+      if( !pending_ )
+      {
+	pending_condition_.wait(lock);
+	continue;
+      }
+      
+      boost::system_time due = last_publish_time_ + interval;
+      if( boost::get_system_time() < due )
+      {
+	pending_condition_.timed_wait(lock,due);
+	continue;
+      }
+      
+      lock.unlock();
+      {
+	ReadLock map_lock(*octree_mutex_);
+	take(*octree_);
+      }
+      lock.lock();
+    }
+  }
+  
   /*TEMPT // cpp11 version
   template< template<typename, typename ...> class INPUT_OBJ_TYPE, class ... TEMPLATE_ARGS, class ... CONSTRUCTOR_ARGS >
   boost::shared_ptr< INPUT_OBJ_TYPE<TREE_TYPE,TEMPLATE_ARGS ...> > CSCOPE::getLinkedObj( CONSTRUCTOR_ARGS ... args )
@@ -48,6 +168,8 @@ namespace octomap
     
     Link new_link;
     new_link.octree = octree_;
+    new_link.octree_mutex = octree_mutex_;
+    new_link.snapshots = snapshots_;
     ptr->setLink(new_link);
     
     return ptr;
@@ -61,6 +183,8 @@ namespace octomap
     
     Link new_link;
     new_link.octree = octree_;
+    new_link.octree_mutex = octree_mutex_;
+    new_link.snapshots = snapshots_;
     ptr->setLink(new_link);
     
     return ptr;
@@ -74,6 +198,8 @@ namespace octomap
     
     Link new_link;
     new_link.octree = octree_;
+    new_link.octree_mutex = octree_mutex_;
+    new_link.snapshots = snapshots_;
     ptr->setLink(new_link);
     
     return ptr;
@@ -87,6 +213,8 @@ namespace octomap
     
     Link new_link;
     new_link.octree = octree_;
+    new_link.octree_mutex = octree_mutex_;
+    new_link.snapshots = snapshots_;
     ptr->setLink(new_link);
     
     return ptr;
@@ -20,16 +20,12 @@
 
 
 #include "ig_active_reconstruction_octomap/octomap_ig_tree_world_representation.hpp"
+#include "ig_active_reconstruction_octomap/octomap_compact_ig_tree_world_representation.hpp"
+#include "ig_active_reconstruction_octomap/octomap_voxel_block_map_world_representation.hpp"
 #include "ig_active_reconstruction_octomap/octomap_ray_occlusion_calculator.hpp"
 #include "ig_active_reconstruction_octomap/octomap_std_pcl_input_point_xyz.hpp"
-#include "ig_active_reconstruction_octomap/octomap_basic_ray_ig_calculator.hpp"
-#include "ig_active_reconstruction_octomap/ig/occlusion_aware.hpp"
-#include "ig_active_reconstruction_octomap/ig/unobserved_voxel.hpp"
-#include "ig_active_reconstruction_octomap/ig/rear_side_voxel.hpp"
-#include "ig_active_reconstruction_octomap/ig/rear_side_entropy.hpp"
-#include "ig_active_reconstruction_octomap/ig/proximity_count.hpp"
-#include "ig_active_reconstruction_octomap/ig/vasquez_gomez_area_factor.hpp"
-#include "ig_active_reconstruction_octomap/ig/average_entropy.hpp"
+#include "ig_active_reconstruction_octomap/octomap_static_ray_ig_calculator_all_metrics.hpp"
+#include "ig_active_reconstruction_octomap/octomap_projection_ig_calculator.hpp"
 #include "ig_active_reconstruction_octomap/octomap_ros_pcl_input.hpp"
 #include "ig_active_reconstruction_octomap/octomap_ros_interface.hpp"
 
@@ -37,25 +33,51 @@
 #include "ig_active_reconstruction_ros/world_representation_ros_server_ci.hpp"
 
 
-/*! Implements a ROS node holding an octomap world represenation and listening on a PCL topic.
+namespace iar = ig_active_reconstruction;
+using namespace iar::world_representation::octomap;
+
+/*! Creates the projection based information gain calculator with all available metrics.
+ * 
+ * @return The calculator or NULL if the map type doesn't support it.
  */
-int main(int argc, char **argv)
+template<class TREE_TYPE>
+boost::shared_ptr<iar::world_representation::CommunicationInterface> createProjectionIgCalculator( WorldRepresentation<TREE_TYPE>& world_representation, typename ProjectionIgCalculator<TREE_TYPE>::Config ig_calc_config, typename InformationGain<TREE_TYPE>::Config ig_config )
 {
-  ros::init(argc, argv, "octomap_world_representation");
-  ros::NodeHandle nh;
-  
-  namespace iar = ig_active_reconstruction;
-  
-  using namespace iar::world_representation::octomap;
-  typedef IgTreeWorldRepresentation WorldRepresentation;
-  typedef WorldRepresentation::TreeType TreeType;
-  typedef StdPclInputPointXYZ<TreeType>::PclType PclType;
+  typename ProjectionIgCalculator<TREE_TYPE>::Ptr projection_ig_calculator = world_representation.template getLinkedObj<ProjectionIgCalculator>(ig_calc_config);
+  projection_ig_calculator->template registerInformationGain<OcclusionAwareIg>(ig_config);
+  projection_ig_calculator->template registerInformationGain<UnobservedVoxelIg>(ig_config);
+  projection_ig_calculator->template registerInformationGain<RearSideVoxelIg>(ig_config);
+  projection_ig_calculator->template registerInformationGain<RearSideEntropyIg>(ig_config);
+  projection_ig_calculator->template registerInformationGain<ProximityCountIg>(ig_config);
+  projection_ig_calculator->template registerInformationGain<VasquezGomezAreaFactorIg>(ig_config);
+  projection_ig_calculator->template registerInformationGain<AverageEntropyIg>(ig_config);
+  return projection_ig_calculator;
+}
+
+/*! The projection engine walks the octree hierarchy, which the voxel block map doesn't have.
+ */
+template<>
+boost::shared_ptr<iar::world_representation::CommunicationInterface> createProjectionIgCalculator<VoxelBlockMap>( WorldRepresentation<VoxelBlockMap>& world_representation, ProjectionIgCalculator<VoxelBlockMap>::Config ig_calc_config, InformationGain<VoxelBlockMap>::Config ig_config )
+{
+  ROS_WARN("octomap_world_representation: The projection engine is not available for the voxel block map, using the ray engine.");
+  return boost::shared_ptr<iar::world_representation::CommunicationInterface>();
+}
+
+/*! Sets up the world representation on the given map type and spins.
+ */
+template<class TREE_TYPE>
+int runWorldRepresentation( ros::NodeHandle& nh )
+{
+  typedef WorldRepresentation<TREE_TYPE> WorldRepresentationType;
+  typedef TREE_TYPE TreeType;
+  typedef typename StdPclInputPointXYZ<TreeType>::PclType PclType;
+  typedef typename StaticRayIgCalculatorAllMetrics<TreeType>::Type IgCalculatorType;
   
   
   // Load parameters
   // .............................................................................................
   // Octree config
-  TreeType::Config octree_config;
+  typename TreeType::Config octree_config;
   ros_tools::getParamIfAvailable(octree_config.resolution_m,"resolution_m");
   ros_tools::getParamIfAvailable(octree_config.occupancy_threshold,"occupancy_threshold");
   ros_tools::getParamIfAvailable(octree_config.hit_probability,"hit_probability");
@@ -63,8 +85,13 @@ int main(int argc, char **argv)
   ros_tools::getParamIfAvailable(octree_config.clamping_threshold_min,"clamping_threshold_min");
   ros_tools::getParamIfAvailable(octree_config.clamping_threshold_max,"clamping_threshold_max");
   
+  // Snapshot config
+  typename WorldRepresentationType::Snapshots::Config snapshot_config;
+  ros_tools::getParamIfAvailable(snapshot_config.enabled,"snapshots/enabled");
+  ros_tools::getParamIfAvailable(snapshot_config.min_interval_s,"snapshots/min_interval_s");
+  
   // Input config
-  StdPclInputPointXYZ<TreeType>::Type::Config input_config;
+  typename StdPclInputPointXYZ<TreeType>::Type::Config input_config;
   ros_tools::getParamIfAvailable(input_config.use_bounding_box,"use_bounding_box");
   ros_tools::getParamIfAvailable<float,double>(input_config.bounding_box_min_point_m.x(),"bounding_box_min_point_m/x");
   ros_tools::getParamIfAvailable<float,double>(input_config.bounding_box_min_point_m.y(),"bounding_box_min_point_m/y");
@@ -73,16 +100,24 @@ int main(int argc, char **argv)
   ros_tools::getParamIfAvailable<float,double>(input_config.bounding_box_max_point_m.y(),"bounding_box_max_point_m/y");
   ros_tools::getParamIfAvailable<float,double>(input_config.bounding_box_max_point_m.z(),"bounding_box_max_point_m/z");
   ros_tools::getParamIfAvailable(input_config.max_sensor_range_m,"max_sensor_range_m");
+  ros_tools::getParamIfAvailable<unsigned int,int>(input_config.nr_of_threads,"input/nr_of_threads");
+  ros_tools::getParamIfAvailable<unsigned int,int>(input_config.points_per_chunk,"input/points_per_chunk");
+  ros_tools::getParamIfAvailable(input_config.bin_points_by_voxel,"input/bin_points_by_voxel");
+  ros_tools::getParamIfAvailable(input_config.cast_rays_to_centroids,"input/cast_rays_to_centroids");
   
   std::string world_frame;
   ros_tools::getExpParam(world_frame,"world_frame_name");
   
+  typename RosPclInput<TreeType,PclType>::Config ros_input_config;
+  ros_tools::getParamIfAvailable(ros_input_config.async,"input/async");
+  ros_tools::getParamIfAvailable<unsigned int,int>(ros_input_config.queue_size,"input/queue_size");
+  
   // Occlusion calculation config
-  RayOcclusionCalculator<TreeType,PclType>::Options occlusion_config(0.3);
+  typename RayOcclusionCalculator<TreeType,PclType>::Options occlusion_config(0.3);
   ros_tools::getParamIfAvailable(occlusion_config.occlusion_update_dist_m,"occlusion_update_dist_m");
   
   // Raycaster configuration - TODO cam intrinsics can be loaded from ROS topics
-  BasicRayIgCalculator<IgTreeWorldRepresentation::TreeType>::Config ig_calc_config;
+  typename IgCalculatorType::Config ig_calc_config;
   
   ros_tools::getParamIfAvailable<unsigned int,int>(ig_calc_config.ray_caster_config.img_width_px,"img_width_px");
   ros_tools::getParamIfAvailable<unsigned int,int>(ig_calc_config.ray_caster_config.img_height_px,"img_height_px");
@@ -99,50 +134,62 @@ int main(int argc, char **argv)
   ros_tools::getParamIfAvailable(ig_calc_config.ray_caster_config.resolution.max_x_perc,"raycasting/max_x_perc");
   ros_tools::getParamIfAvailable(ig_calc_config.ray_caster_config.resolution.max_y_perc,"raycasting/max_y_perc");
   
+  ros_tools::getParamIfAvailable<unsigned int,int>(ig_calc_config.nr_of_threads,"ig_calculation/nr_of_threads");
+  ros_tools::getParamIfAvailable<unsigned int,int>(ig_calc_config.rays_per_chunk,"ig_calculation/rays_per_chunk");
+  ros_tools::getParamIfAvailable(ig_calc_config.hierarchical_ig,"ig_calculation/hierarchical");
+  ros_tools::getParamIfAvailable<unsigned int,int>(ig_calc_config.tile_size_rays,"ig_calculation/tile_size_rays");
+  ros_tools::getParamIfAvailable<unsigned int,int>(ig_calc_config.coarse_depth_offset,"ig_calculation/coarse_depth_offset");
+  ros_tools::getParamIfAvailable(ig_calc_config.refined_tile_fraction,"ig_calculation/refined_tile_fraction");
+  
+  std::string ig_engine = "ray"; // "ray": Cast a ray per pixel, "projection": Project the octree leaves into the view
+  ros_tools::getParamIfAvailable(ig_engine,"ig_calculation/engine");
+  
   // Information gain config
-  InformationGain<IgTreeWorldRepresentation::TreeType>::Config ig_config;
+  typename InformationGain<TreeType>::Config& ig_config = ig_calc_config.ig_config;
   ros_tools::getParamIfAvailable(ig_config.p_unknown_prior,"ig/p_unknown_prior");
   ros_tools::getParamIfAvailable(ig_config.p_unknown_upper_bound,"ig/p_unknown_upper_bound");
   ros_tools::getParamIfAvailable(ig_config.p_unknown_lower_bound,"ig/p_unknown_lower_bound");
   ros_tools::getParamIfAvailable<unsigned int,int>(ig_config.voxels_in_void_ray,"ig/voxels_in_void_ray");
+  ros_tools::getParamIfAvailable(ig_config.use_lookup_table,"ig/use_lookup_table");
+  ros_tools::getParamIfAvailable(ig_config.lookup_table_resolution,"ig/lookup_table_resolution");
   
   
   
   
   // Instantiate main world object
   // .............................................................................................
-  WorldRepresentation world_representation(octree_config);
+  WorldRepresentationType world_representation(octree_config,snapshot_config);
   // Create ROS interface
-  RosInterface<TreeType>::Config wri_config;
+  typename RosInterface<TreeType>::Config wri_config;
   wri_config.nh = ros::NodeHandle("world");
   wri_config.world_frame_name = world_frame;
-  RosInterface<TreeType>::Ptr world_ros_interface = world_representation.getLinkedObj<RosInterface>(wri_config);
+  typename RosInterface<TreeType>::Ptr world_ros_interface = world_representation.template getLinkedObj<RosInterface>(wri_config);
   
   // Add input
   // .............................................................................................
-  typename StdPclInputPointXYZ<TreeType>::Ptr std_input = world_representation.getLinkedObj<StdPclInputPointXYZ>(input_config);
+  typename StdPclInputPointXYZ<TreeType>::Ptr std_input = world_representation.template getLinkedObj<StdPclInputPointXYZ>(input_config);
   
   // Calculate occlusion
-  std_input->setOcclusionCalculator<RayOcclusionCalculator>(occlusion_config);
+  std_input->template setOcclusionCalculator<RayOcclusionCalculator>(occlusion_config);
   
   // Expose input to ROS
-  RosPclInput<TreeType,PclType> ros_pcl_input(ros::NodeHandle("world"), std_input, world_frame);
+  RosPclInput<TreeType,PclType> ros_pcl_input(ros::NodeHandle("world"), std_input, world_frame, ros_input_config);
   // Publish map after inserting inputs
   boost::function<void()> publish_map = boost::bind(&RosInterface<TreeType>::publishVoxelMap,world_ros_interface);
   ros_pcl_input.addInputDoneSignalCall(publish_map);
   
   // Add information gain calculator
   // .............................................................................................
-  BasicRayIgCalculator<IgTreeWorldRepresentation::TreeType>::Ptr ig_calculator = world_representation.getLinkedObj<BasicRayIgCalculator>(ig_calc_config);
-  
-  // set information gains that shall be used
-  ig_calculator->registerInformationGain<OcclusionAwareIg>(ig_config);
-  ig_calculator->registerInformationGain<UnobservedVoxelIg>(ig_config);
-  ig_calculator->registerInformationGain<RearSideVoxelIg>(ig_config);
-  ig_calculator->registerInformationGain<RearSideEntropyIg>(ig_config);
-  ig_calculator->registerInformationGain<ProximityCountIg>(ig_config);
-  ig_calculator->registerInformationGain<VasquezGomezAreaFactorIg>(ig_config);
-  ig_calculator->registerInformationGain<AverageEntropyIg>(ig_config);
+  // both engines provide OcclusionAwareIg, UnobservedVoxelIg, RearSideVoxelIg, RearSideEntropyIg, ProximityCountIg, VasquezGomezAreaFactorIg and AverageEntropyIg (in that order)
+  boost::shared_ptr<iar::world_representation::CommunicationInterface> ig_calculator;
+  if( ig_engine=="projection" )
+  {
+    ig_calculator = createProjectionIgCalculator(world_representation,ig_calc_config,ig_config);
+  }
+  if( ig_calculator==NULL )
+  {
+    ig_calculator = world_representation.template getLinkedObj<StaticRayIgCalculatorAllMetrics>(ig_calc_config);
+  }
   
   // Expose the information gain calculator to ROS
   iar::world_representation::RosServerCI<boost::shared_ptr> ig_server(nh,ig_calculator);
@@ -155,4 +202,22 @@ int main(int argc, char **argv)
   spinner.spin();
   
   return 0;
+}
+
+/*! Implements a ROS node holding an octomap world represenation and listening on a PCL topic.
+ */
+int main(int argc, char **argv)
+{
+  ros::init(argc, argv, "octomap_world_representation");
+  ros::NodeHandle nh;
+  
+  std::string map_type = "ig_tree"; // "ig_tree": Octree, "compact_ig_tree": Octree with smaller nodes, "voxel_block_map": Hashed voxel blocks without hierarchy (no projection engine)
+  ros_tools::getParamIfAvailable(map_type,"map_type");
+  
+  if( map_type=="compact_ig_tree" )
+    return runWorldRepresentation<CompactIgTree>(nh);
+  if( map_type=="voxel_block_map" )
+    return runWorldRepresentation<VoxelBlockMap>(nh);
+  
+  return runWorldRepresentation<IgTree>(nh);
 }
\ No newline at end of file
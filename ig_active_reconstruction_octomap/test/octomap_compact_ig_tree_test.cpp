@@ -0,0 +1,247 @@
+/* Copyright (c) 2016, Stefan Isler, islerstefan@bluewin.ch
+ * (ETH Zurich / Robotics and Perception Group, University of Zurich, Switzerland)
+ *
+ * This file is part of ig_active_reconstruction, software for information gain based, active reconstruction.
+ *
+ * ig_active_reconstruction is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * ig_active_reconstruction is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ * Please refer to the GNU Lesser General Public License for details on the license,
+ * on <http://www.gnu.org/licenses/>.
+*/
+
+#include <cmath>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "ig_active_reconstruction_octomap/octomap_ig_tree_world_representation.hpp"
+#include "ig_active_reconstruction_octomap/octomap_compact_ig_tree_world_representation.hpp"
+#include "ig_active_reconstruction_octomap/octomap_ray_occlusion_calculator.hpp"
+#include "ig_active_reconstruction_octomap/octomap_std_pcl_input_point_xyz.hpp"
+#include "ig_active_reconstruction_octomap/octomap_static_ray_ig_calculator_all_metrics.hpp"
+#include "ig_active_reconstruction_octomap/octomap_projection_ig_calculator.hpp"
+
+namespace iar = ig_active_reconstruction;
+using namespace iar::world_representation::octomap;
+
+namespace
+{
+  typedef pcl::PointCloud<pcl::PointXYZ> PclType;
+  typedef iar::world_representation::CommunicationInterface CommunicationInterface;
+  
+  const unsigned int NR_OF_METRICS = 7;
+  
+  /*! Gives access to the octree of a world representation.
+   */
+  template<class TREE_TYPE>
+  class OctreeAccess: public WorldRepresentation<TREE_TYPE>::LinkedObject
+  {
+  public:
+    struct Config{};
+    OctreeAccess( Config ){};
+    boost::shared_ptr<TREE_TYPE> octree(){ return this->link_.octree; };
+  };
+  
+  /*! Wavy surface in front of the sensor with a few far outliers, as seen from the given view.
+   */
+  PclType surfaceCloud( int view )
+  {
+    PclType pc;
+    for( int u=0; u<160; ++u )
+    {
+      for( int v=0; v<120; ++v )
+      {
+	double x = (u-80)/100.0;
+	double y = (v-60)/100.0;
+	double z = 2.0 + 0.3*std::sin(3*x+view) + 0.2*std::cos(5*y);
+	if( (u*7+v*3+view)%53==0 )
+	  z = 3.5;
+	pc.push_back( pcl::PointXYZ(x*z,y*z,z) );
+      }
+    }
+    return pc;
+  }
+  
+  Eigen::Transform<double,3,Eigen::Affine> sensorToWorld( int view )
+  {
+    return Eigen::Translation3d(0.1*view,0,0)*Eigen::AngleAxisd(0.1*view,Eigen::Vector3d::UnitY());
+  }
+  
+  /*! World representation on TREE_TYPE into which the same clouds are inserted (with occlusions), with an information gain
+   * calculator that computes all metrics.
+   */
+  template<class TREE_TYPE>
+  class TestWorld
+  {
+  public:
+    /*! Constructor.
+     * @param projection_engine Whether to use the ProjectionIgCalculator instead of the StaticRayIgCalculator.
+     * @param occlusion_update_dist_m Maximal distance up to which occlusions are registered behind occupied voxels [m].
+     */
+    TestWorld( bool projection_engine, double occlusion_update_dist_m = 0.3 )
+    : world_( octreeConfig() )
+    {
+      typename StdPclInputPointXYZ<TREE_TYPE>::Type::Config input_config;
+      input_config.max_sensor_range_m = 2.5;
+      input_ = world_.template getLinkedObj<StdPclInputPointXYZ>(input_config);
+      input_->template setOcclusionCalculator<RayOcclusionCalculator>( typename RayOcclusionCalculator<TREE_TYPE,PclType>::Options(occlusion_update_dist_m) );
+      
+      typename StaticRayIgCalculatorAllMetrics<TREE_TYPE>::Type::Config ig_calc_config;
+      ig_calc_config.ray_caster_config.img_width_px = 128;
+      ig_calc_config.ray_caster_config.img_height_px = 96;
+      ig_calc_config.ray_caster_config.camera_matrix(0,0) = 100;
+      ig_calc_config.ray_caster_config.camera_matrix(1,1) = 100;
+      ig_calc_config.ray_caster_config.camera_matrix(0,2) = 64;
+      ig_calc_config.ray_caster_config.camera_matrix(1,2) = 48;
+      ig_calc_config.ray_caster_config.max_ray_depth_m = 3.0;
+      ig_calc_config.nr_of_threads = 1; // same summation order for both trees
+      
+      if( projection_engine )
+      {
+	typename ProjectionIgCalculator<TREE_TYPE>::Ptr projection_ig_calculator = world_.template getLinkedObj<ProjectionIgCalculator>(ig_calc_config);
+	projection_ig_calculator->template registerInformationGain<OcclusionAwareIg>(ig_calc_config.ig_config);
+	projection_ig_calculator->template registerInformationGain<UnobservedVoxelIg>(ig_calc_config.ig_config);
+	projection_ig_calculator->template registerInformationGain<RearSideVoxelIg>(ig_calc_config.ig_config);
+	projection_ig_calculator->template registerInformationGain<RearSideEntropyIg>(ig_calc_config.ig_config);
+	projection_ig_calculator->template registerInformationGain<ProximityCountIg>(ig_calc_config.ig_config);
+	projection_ig_calculator->template registerInformationGain<VasquezGomezAreaFactorIg>(ig_calc_config.ig_config);
+	projection_ig_calculator->template registerInformationGain<AverageEntropyIg>(ig_calc_config.ig_config);
+	ig_calculator_ = projection_ig_calculator;
+      }
+      else
+      {
+	ig_calculator_ = world_.template getLinkedObj<StaticRayIgCalculatorAllMetrics>(ig_calc_config);
+      }
+    }
+    
+    /*! Inserts the clouds.
+     * @return Number of nodes in the octree.
+     */
+    size_t insertClouds()
+    {
+      for( int view=0; view<3; ++view )
+      {
+	PclType pc = surfaceCloud(view);
+	input_->push( sensorToWorld(view), pc );
+      }
+      return world_.template getLinkedObj<OctreeAccess>()->octree()->size();
+    }
+    
+    /*! Computes all metrics for a few views.
+     * @return The metrics of all views, view after view.
+     */
+    std::vector<double> metrics()
+    {
+      CommunicationInterface::IgRetrievalCommand command;
+      for( unsigned int id=0; id<NR_OF_METRICS; ++id )
+	command.metric_ids.push_back(id);
+      
+      // one view from the sensor side, two from behind the surface, where the occluded voxels are
+      movements::PoseVector views;
+      views.push_back( movements::Pose( Eigen::Vector3d(0.05,-0.1,0.0), Eigen::Quaterniond(Eigen::AngleAxisd(0.1,Eigen::Vector3d::UnitY())) ) );
+      views.push_back( movements::Pose( Eigen::Vector3d(0.0,0.0,4.5), Eigen::Quaterniond(Eigen::AngleAxisd(M_PI,Eigen::Vector3d::UnitY())) ) );
+      views.push_back( movements::Pose( Eigen::Vector3d(0.3,0.1,4.3), Eigen::Quaterniond(Eigen::AngleAxisd(M_PI-0.2,Eigen::Vector3d::UnitY())) ) );
+      
+      std::vector<double> metrics;
+      for( size_t view=0; view<views.size(); ++view )
+      {
+	command.path.clear();
+	command.path.push_back( views[view] );
+	
+	CommunicationInterface::ViewIgResult result;
+	ig_calculator_->computeViewIg(command,result);
+	
+	EXPECT_EQ( NR_OF_METRICS, result.size() );
+	for( unsigned int i=0; i<result.size(); ++i )
+	{
+	  EXPECT_EQ( CommunicationInterface::ResultInformation::SUCCEEDED, result[i].status.res );
+	  metrics.push_back( result[i].predicted_gain );
+	}
+      }
+      return metrics;
+    }
+    
+  private:
+    static typename TREE_TYPE::Config octreeConfig()
+    {
+      typename TREE_TYPE::Config octree_config;
+      octree_config.resolution_m = 0.05;
+      return octree_config;
+    }
+    
+  private:
+    WorldRepresentation<TREE_TYPE> world_;
+    typename StdPclInputPointXYZ<TREE_TYPE>::Ptr input_;
+    boost::shared_ptr<CommunicationInterface> ig_calculator_;
+  };
+  
+  void expectEqualMetrics( const std::vector<double>& ig_tree_metrics, const std::vector<double>& compact_ig_tree_metrics )
+  {
+    ASSERT_EQ( ig_tree_metrics.size(), compact_ig_tree_metrics.size() );
+    for( size_t i=0; i<ig_tree_metrics.size(); ++i )
+    {
+      EXPECT_DOUBLE_EQ( ig_tree_metrics[i], compact_ig_tree_metrics[i] )<<"metric "<<i%NR_OF_METRICS<<" of view "<<i/NR_OF_METRICS;
+    }
+  }
+  
+  void expectSameMetrics( bool projection_engine )
+  {
+    TestWorld<IgTree> ig_tree(projection_engine);
+    TestWorld<CompactIgTree> compact_ig_tree(projection_engine);
+    size_t ig_tree_size = ig_tree.insertClouds();
+    size_t compact_ig_tree_size = compact_ig_tree.insertClouds();
+    
+    EXPECT_LT( 0u, ig_tree_size );
+    EXPECT_EQ( ig_tree_size, compact_ig_tree_size );
+    
+    std::vector<double> ig_tree_metrics = ig_tree.metrics();
+    expectEqualMetrics( ig_tree_metrics, compact_ig_tree.metrics() );
+    
+    // make sure the views see the map, and the rear views the occluded voxels, which carry the maximal occlusion distance
+    EXPECT_LT( 0, ig_tree_metrics[0] ); // occlusion aware ig, sensor side view
+    EXPECT_LT( 0, ig_tree_metrics[NR_OF_METRICS+4] ); // proximity count, first rear view
+  }
+}
+
+TEST(CompactIgTreeTest, rayEngineMetricsEqualIgTree)
+{
+  expectSameMetrics(false);
+}
+
+TEST(CompactIgTreeTest, projectionEngineMetricsEqualIgTree)
+{
+  expectSameMetrics(true);
+}
+
+TEST(CompactIgTreeTest, maximalOcclusionDistanceIsKeptPerTree)
+{
+  // both compact trees are filled before either is evaluated, such that a maximal occlusion distance shared among trees would be overwritten
+  TestWorld<CompactIgTree> near_compact_ig_tree(false,0.3);
+  TestWorld<CompactIgTree> far_compact_ig_tree(false,0.6);
+  near_compact_ig_tree.insertClouds();
+  far_compact_ig_tree.insertClouds();
+  
+  TestWorld<IgTree> near_ig_tree(false,0.3);
+  TestWorld<IgTree> far_ig_tree(false,0.6);
+  near_ig_tree.insertClouds();
+  far_ig_tree.insertClouds();
+  
+  std::vector<double> near_metrics = near_ig_tree.metrics();
+  std::vector<double> far_metrics = far_ig_tree.metrics();
+  expectEqualMetrics( near_metrics, near_compact_ig_tree.metrics() );
+  expectEqualMetrics( far_metrics, far_compact_ig_tree.metrics() );
+  
+  EXPECT_NE( near_metrics[NR_OF_METRICS+4], far_metrics[NR_OF_METRICS+4] ); // proximity count, first rear view
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
\ No newline at end of file
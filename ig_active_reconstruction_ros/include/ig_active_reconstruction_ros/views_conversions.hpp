@@ -19,6 +19,7 @@
 
 #include "ig_active_reconstruction_msgs/ViewMsg.h"
 #include "ig_active_reconstruction_msgs/ViewSpaceMsg.h"
+#include "ig_active_reconstruction_msgs/CompactViewsMsg.h"
 
 #include "ig_active_reconstruction/view.hpp"
 #include "ig_active_reconstruction/view_space.hpp"
@@ -46,6 +47,16 @@ namespace ros_conversions
     /** Construct view space from message */
     views::ViewSpace viewSpaceFromMsg( ig_active_reconstruction_msgs::ViewSpaceMsg& msg );
     
+    /*! Appends a view to a compact views message.
+     * @param with_pose If false, only id, flags and visit count are appended, otherwise also pose and source frame.
+     */
+    void appendToCompactMsg( const views::View& view, ig_active_reconstruction_msgs::CompactViewsMsg& msg, bool with_pose = true );
+    
+    /*! Constructs the i-th view of a compact views message, which must contain poses.
+     * @throws std::out_of_range if the message holds less views or no poses.
+     */
+    views::View viewFromCompactMsg( const ig_active_reconstruction_msgs::CompactViewsMsg& msg, size_t i );
+    
   
     views::CommunicationInterface::ViewSpaceStatus viewSpaceStatusFromMsg( int& msg );
     int viewSpaceStatusToMsg( views::CommunicationInterface::ViewSpaceStatus& status );
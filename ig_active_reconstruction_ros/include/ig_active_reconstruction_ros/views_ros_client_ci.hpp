@@ -20,6 +20,8 @@
 #include "ros/ros.h"
 #include "ig_active_reconstruction/views_communication_interface.hpp"
 
+#include "ig_active_reconstruction_msgs/ViewSpaceSync.h"
+
 namespace ig_active_reconstruction
 {
   
@@ -27,17 +29,22 @@ namespace views
 {
   
   /*! ROS client implementation of a views::CommunicationInterface. Forwards calls over the ROS network via Server calls.
+   * 
+   * The viewspace is kept locally and synchronized incrementally: after the first (paged) transfer, only the changes are
+   * requested on subsequent getViewSpace() calls. If the server does not provide the "views/sync" service, the whole viewspace
+   * is transferred at once.
    */
   class RosClientCI: public CommunicationInterface
   {
   public:
     /*! Constructor
      * @param nh ROS node handle defines the namespace in which ROS communication will be carried out.
+     * @param page_size Maximal number of views transferred per service call, 0 for no limit.
+     * @param poses_only If true, views are transferred in the compact encoding (id, pose, flags and visit count only), without source frame and additional fields.
      */
-    RosClientCI( ros::NodeHandle nh );
+    RosClientCI( ros::NodeHandle nh, unsigned int page_size = 5000, bool poses_only = false );
     
-    /*! Returns the view space that is available for planning.
-      * @param _space pointer to the ViewSpace object that should be filled
+    /*! Returns the view space that is available for planning, after synchronizing it with the server.
       */
     virtual const ViewSpace& getViewSpace();
     
@@ -63,14 +70,31 @@ namespace views
      */
     virtual ViewSpaceUpdateResult deleteView( View::IdType view_id );
     
+  protected:
+    /*! Synchronizes the local viewspace with the server, using the paged and incremental sync service.
+     * @return False if the service is not available or failed.
+     */
+    bool synchronizeViewSpace();
+    
+    /*! Applies a page received from the sync service to the local viewspace.
+     * @throws std::out_of_range if the page is malformed.
+     */
+    void applySyncPage( ig_active_reconstruction_msgs::ViewSpaceSync::Response& page );
+    
   protected:
     ros::NodeHandle nh_;
     
     ros::ServiceClient planning_space_receiver_;
+    ros::ServiceClient viewspace_syncer_;
     ros::ServiceClient views_adder_;
     ros::ServiceClient views_deleter_;
     
     ViewSpace viewspace_;
+    
+    unsigned int page_size_;
+    bool poses_only_;
+    uint64_t synced_epoch_; //! Epoch of the server viewspace the local copy corresponds to, 0 if none.
+    uint64_t synced_version_; //! Version of the server viewspace the local copy corresponds to.
   };
   
 }
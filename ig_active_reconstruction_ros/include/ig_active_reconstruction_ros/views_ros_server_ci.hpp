@@ -22,6 +22,7 @@
 
 #include "ig_active_reconstruction_msgs/DeleteViews.h"
 #include "ig_active_reconstruction_msgs/ViewSpaceRequest.h"
+#include "ig_active_reconstruction_msgs/ViewSpaceSync.h"
 #include "ig_active_reconstruction_msgs/ViewSpaceUpdate.h"
 
 namespace ig_active_reconstruction
@@ -70,6 +71,10 @@ namespace views
   protected:
     bool viewspaceService( ig_active_reconstruction_msgs::ViewSpaceRequest::Request& req, ig_active_reconstruction_msgs::ViewSpaceRequest::Response& res );
     
+    /*! Paged and incremental viewspace transfer, see ViewSpaceSync.srv.
+     */
+    bool viewspaceSyncService( ig_active_reconstruction_msgs::ViewSpaceSync::Request& req, ig_active_reconstruction_msgs::ViewSpaceSync::Response& res );
+    
     bool viewsAdderService( ig_active_reconstruction_msgs::ViewSpaceUpdate::Request& req, ig_active_reconstruction_msgs::ViewSpaceUpdate::Response& res );
     
     bool viewsDeleterService( ig_active_reconstruction_msgs::DeleteViews::Request& req, ig_active_reconstruction_msgs::DeleteViews::Response& res );
@@ -80,8 +85,13 @@ namespace views
     boost::shared_ptr<CommunicationInterface> linked_interface_; //! Linked interface.
     
     ros::ServiceServer viewspace_service_;
+    ros::ServiceServer viewspace_sync_service_;
     ros::ServiceServer views_adder_service_;
     ros::ServiceServer views_deleter_service_;
+    
+    ViewSpace::IdSet sorted_ids_; //! Sorted ids of all views, cached for the transfer of all pages of a viewspace version.
+    uint64_t sorted_ids_epoch_;
+    uint64_t sorted_ids_version_;
   };
   
 }
@@ -18,6 +18,7 @@
 #pragma once
 
 #include "ig_active_reconstruction_msgs/InformationGainRetrievalCommand.h"
+#include "ig_active_reconstruction_msgs/ViewspaceInformationGainRetrievalCommand.h"
 #include "ig_active_reconstruction_msgs/InformationGain.h"
 
 #include "ig_active_reconstruction/world_representation_communication_interface.hpp"
@@ -35,6 +36,10 @@ namespace ros_conversions
     
     ig_active_reconstruction_msgs::InformationGainRetrievalCommand igRetrievalCommandToMsg(world_representation::CommunicationInterface::IgRetrievalCommand& command);
     
+    world_representation::CommunicationInterface::ViewspaceIgRetrievalCommand viewspaceIgRetrievalCommandFromMsg(ig_active_reconstruction_msgs::ViewspaceInformationGainRetrievalCommand& command_msg);
+    
+    ig_active_reconstruction_msgs::ViewspaceInformationGainRetrievalCommand viewspaceIgRetrievalCommandToMsg(world_representation::CommunicationInterface::ViewspaceIgRetrievalCommand& command);
+    
     world_representation::CommunicationInterface::ResultInformation resultInformationFromMsg(int& msg);
     
     int resultInformationToMsg(world_representation::CommunicationInterface::ResultInformation& msg);
@@ -45,6 +45,12 @@ namespace world_representation
      */
     virtual ResultInformation computeViewIg(IgRetrievalCommand& command, ViewIgResult& output_ig);
     
+    /*! Calculates a set of information gains for each view of a set of views, using a single service call.
+     * @param command Specifies the views and which information gains have to be calculated for them, along with further parameters that define how the ig('s) will be collected.
+     * @param output_ig (Output) One ViewIgResult per view, in the order of the views within the passed command.
+     */
+    virtual ResultInformation computeViewspaceIg(ViewspaceIgRetrievalCommand& command, ViewspaceIgResult& output_ig);
+    
     /*! Calculates a set of evaluation metrics on the complete map.
      * @param command Specifies which metrics shall be calculated.
      */
@@ -60,10 +66,15 @@ namespace world_representation
      */
     virtual void availableMapMetrics( std::vector<MetricInfo>& available_map_metrics );
     
+    /*! All calls are forwarded over the ROS network.
+     */
+    virtual bool isRemote() const{ return true; };
+    
   protected:
     ros::NodeHandle nh_;
     
     ros::ServiceClient view_ig_computation_;
+    ros::ServiceClient viewspace_ig_computation_;
     ros::ServiceClient map_metric_computation_;
     ros::ServiceClient available_ig_receiver_;
     ros::ServiceClient available_mm_receiver_;
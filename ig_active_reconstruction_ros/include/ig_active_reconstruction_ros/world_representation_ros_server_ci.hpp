@@ -22,6 +22,7 @@
 #include "ig_active_reconstruction/world_representation_communication_interface.hpp"
 
 #include "ig_active_reconstruction_msgs/InformationGainCalculation.h"
+#include "ig_active_reconstruction_msgs/ViewspaceInformationGainCalculation.h"
 #include "ig_active_reconstruction_msgs/MapMetricCalculation.h"
 #include "ig_active_reconstruction_msgs/StringList.h"
 
@@ -51,6 +52,12 @@ namespace world_representation
      */
     virtual ResultInformation computeViewIg(IgRetrievalCommand& command, ViewIgResult& output_ig);
     
+    /*! Calculates a set of information gains for each view of a set of views.
+     * @param command Specifies the views and which information gains have to be calculated for them, along with further parameters that define how the ig('s) will be collected.
+     * @param output_ig (Output) One ViewIgResult per view, in the order of the views within the passed command.
+     */
+    virtual ResultInformation computeViewspaceIg(ViewspaceIgRetrievalCommand& command, ViewspaceIgResult& output_ig);
+    
     /*! Calculates a set of evaluation metrics on the complete map.
      * @param command Specifies which metrics shall be calculated.
      */
@@ -68,6 +75,7 @@ namespace world_representation
     
   protected:
     bool igComputationService( ig_active_reconstruction_msgs::InformationGainCalculation::Request& req, ig_active_reconstruction_msgs::InformationGainCalculation::Response& res );
+    bool viewspaceIgComputationService( ig_active_reconstruction_msgs::ViewspaceInformationGainCalculation::Request& req, ig_active_reconstruction_msgs::ViewspaceInformationGainCalculation::Response& res );
     bool mmComputationService( ig_active_reconstruction_msgs::MapMetricCalculation::Request& req, ig_active_reconstruction_msgs::MapMetricCalculation::Response& res );
     bool availableIgService( ig_active_reconstruction_msgs::StringList::Request& req, ig_active_reconstruction_msgs::StringList::Response& res );
     bool availableMmService( ig_active_reconstruction_msgs::StringList::Request& req, ig_active_reconstruction_msgs::StringList::Response& res );
@@ -78,6 +86,7 @@ namespace world_representation
     POINTER_TYPE<CommunicationInterface> linked_interface_; //! Linked interface.
     
     ros::ServiceServer view_ig_computation_;
+    ros::ServiceServer viewspace_ig_computation_;
     ros::ServiceServer map_metric_computation_;
     ros::ServiceServer available_ig_receiver_;
     ros::ServiceServer available_mm_receiver_;
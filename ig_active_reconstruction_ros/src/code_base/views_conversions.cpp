@@ -76,6 +76,52 @@ namespace ros_conversions
     return view_space;
   }
   
+  void appendToCompactMsg( const views::View& view, ig_active_reconstruction_msgs::CompactViewsMsg& msg, bool with_pose )
+  {
+    msg.ids.push_back( view.index() );
+    msg.flags.push_back( (view.reachable()? 1 : 0) | (view.bad()? 2 : 0) | (view.nonViewSpace()? 4 : 0) );
+    msg.visited.push_back( view.timesVisited() );
+    
+    if( with_pose )
+    {
+      const movements::Pose& pose = view.pose();
+      msg.poses.push_back( pose.position.x() );
+      msg.poses.push_back( pose.position.y() );
+      msg.poses.push_back( pose.position.z() );
+      msg.poses.push_back( pose.orientation.x() );
+      msg.poses.push_back( pose.orientation.y() );
+      msg.poses.push_back( pose.orientation.z() );
+      msg.poses.push_back( pose.orientation.w() );
+      
+      // a single source frame as long as all views share it, one per view otherwise
+      bool shares_frame = msg.ids.size()>1 && msg.source_frames.size()==1 && msg.source_frames[0]==view.sourceFrame();
+      if( !shares_frame )
+      {
+	std::string shared_frame = msg.source_frames.empty()? "" : msg.source_frames[0];
+	msg.source_frames.resize( msg.ids.size()-1, shared_frame );
+	msg.source_frames.push_back( view.sourceFrame() );
+      }
+    }
+  }
+  
+  views::View viewFromCompactMsg( const ig_active_reconstruction_msgs::CompactViewsMsg& msg, size_t i )
+  {
+    if( i>=msg.ids.size() || i>=msg.flags.size() || i>=msg.visited.size() || 7*i+7>msg.poses.size() || (msg.source_frames.size()!=1 && i>=msg.source_frames.size()) )
+      throw std::out_of_range("ig_active_reconstruction::ros_conversions::viewFromCompactMsg:: Invalid msg received.");
+    
+    views::View view( msg.ids[i] );
+    const double* p = &msg.poses[7*i];
+    view.pose().position = Eigen::Vector3d( p[0], p[1], p[2] );
+    view.pose().orientation = Eigen::Quaterniond( p[6], p[3], p[4], p[5] );
+    view.sourceFrame() = msg.source_frames.size()==1? msg.source_frames[0] : msg.source_frames[i];
+    view.reachable() = (msg.flags[i] & 1)!=0;
+    view.bad() = (msg.flags[i] & 2)!=0;
+    view.nonViewSpace() = (msg.flags[i] & 4)!=0;
+    view.timesVisited() = msg.visited[i];
+    
+    return view;
+  }
+  
   views::CommunicationInterface::ViewSpaceStatus viewSpaceStatusFromMsg( int& msg )
   {
     switch(msg)
@@ -31,27 +31,143 @@ namespace ig_active_reconstruction
 namespace views
 {
   
-  RosClientCI::RosClientCI( ros::NodeHandle nh )
+  RosClientCI::RosClientCI( ros::NodeHandle nh, unsigned int page_size, bool poses_only )
   : nh_(nh)
+  , page_size_(page_size)
+  , poses_only_(poses_only)
+  , synced_epoch_(0)
+  , synced_version_(0)
   {
     planning_space_receiver_ = nh.serviceClient<ig_active_reconstruction_msgs::ViewSpaceRequest>("views/space");
+    viewspace_syncer_ = nh.serviceClient<ig_active_reconstruction_msgs::ViewSpaceSync>("views/sync");
     views_adder_ = nh.serviceClient<ig_active_reconstruction_msgs::ViewSpaceUpdate>("views/add");
     views_deleter_ = nh.serviceClient<ig_active_reconstruction_msgs::DeleteViews>("views/delete");
   }
   
   const ViewSpace& RosClientCI::getViewSpace()
   {
-    ig_active_reconstruction_msgs::ViewSpaceRequest call;
-    
     ROS_INFO("Demanding viewspace.");
+    if( synchronizeViewSpace() )
+      return viewspace_;
+    
+    // fall back to transferring the whole viewspace at once
+    ig_active_reconstruction_msgs::ViewSpaceRequest call;
     bool response = planning_space_receiver_.call(call);
     
     if( response )
+    {
       viewspace_ = ros_conversions::viewSpaceFromMsg(call.response.viewspace);
+      synced_epoch_ = 0;
+    }
     
     return viewspace_;
   }
   
+  bool RosClientCI::synchronizeViewSpace()
+  {
+    if( !viewspace_syncer_.exists() )
+      return false;
+    
+    // if the viewspace changes while the pages are transferred, the next round fetches these changes
+    for( unsigned int round=0; round<3; ++round )
+    {
+      ig_active_reconstruction_msgs::ViewSpaceSync call;
+      call.request.epoch = synced_epoch_;
+      call.request.since_version = synced_version_;
+      call.request.page_start_id = 0;
+      call.request.max_views = page_size_;
+      call.request.poses_only = poses_only_;
+      
+      uint64_t epoch = 0, version = 0;
+      bool is_delta = false;
+      bool first_page = true;
+      bool consistent = true;
+      do
+      {
+	if( !viewspace_syncer_.call(call) )
+	  return false;
+	
+	ig_active_reconstruction_msgs::ViewSpaceSync::Response& page = call.response;
+	if( ros_conversions::viewSpaceStatusFromMsg(page.viewspace_status)!=ViewSpaceStatus::OK )
+	  return false;
+	if( first_page )
+	{
+	  epoch = page.epoch;
+	  version = page.version;
+	  is_delta = page.is_delta;
+	  if( !is_delta )
+	    viewspace_ = ViewSpace();
+	}
+	else if( page.is_delta!=is_delta || page.epoch!=epoch ) // the server could not continue the transfer consistently
+	{
+	  consistent = false;
+	  break;
+	}
+	
+	try
+	{
+	  applySyncPage(page);
+	}
+	catch( std::out_of_range& e )
+	{
+	  ROS_WARN_STREAM("views::RosClientCI::Received a malformed viewspace page: "<<e.what());
+	  synced_epoch_ = 0;
+	  return false;
+	}
+	
+	first_page = false;
+	call.request.page_start_id = page.next_page_start_id;
+      }while( !call.response.complete );
+      
+      if( !consistent ) // start over with a full transfer
+      {
+	synced_epoch_ = 0;
+	continue;
+      }
+      
+      synced_epoch_ = epoch;
+      synced_version_ = version;
+      
+      if( call.response.version==version ) // nothing changed during the transfer
+	break;
+    }
+    return true;
+  }
+  
+  void RosClientCI::applySyncPage( ig_active_reconstruction_msgs::ViewSpaceSync::Response& page )
+  {
+    for( uint64_t& id: page.deleted_ids )
+    {
+      viewspace_.deleteView(id);
+    }
+    
+    for( ig_active_reconstruction_msgs::ViewMsg& view_msg: page.views )
+    {
+      viewspace_.push_back( ros_conversions::viewFromMsg(view_msg) );
+    }
+    for( size_t i=0; i<page.compact_views.ids.size(); ++i )
+    {
+      viewspace_.push_back( ros_conversions::viewFromCompactMsg(page.compact_views,i) );
+    }
+    
+    ig_active_reconstruction_msgs::CompactViewsMsg& states = page.changed_states;
+    if( states.flags.size()!=states.ids.size() || states.visited.size()!=states.ids.size() )
+      throw std::out_of_range("Number of flags or visit counts does not match the number of ids.");
+    for( size_t i=0; i<states.ids.size(); ++i )
+    {
+      View::IdType id = states.ids[i];
+      if( states.flags[i] & 1 )
+	viewspace_.setReachable(id);
+      else
+	viewspace_.setUnReachable(id);
+      if( states.flags[i] & 2 )
+	viewspace_.setBad(id);
+      else
+	viewspace_.setGood(id);
+      viewspace_.setTimesVisited( id, states.visited[i] );
+    }
+  }
+  
   RosClientCI::ViewSpaceUpdateResult RosClientCI::addViews( std::vector<View>& new_views )
   {
     ig_active_reconstruction_msgs::ViewSpaceUpdate call;
@@ -16,6 +16,7 @@
 */
 
 #include <stdexcept>
+#include <algorithm>
 
 #include "ig_active_reconstruction_ros/views_ros_server_ci.hpp"
 #include "ig_active_reconstruction_ros/views_conversions.hpp"
@@ -30,8 +31,11 @@ namespace views
   RosServerCI::RosServerCI( ros::NodeHandle nh, boost::shared_ptr<CommunicationInterface> linked_interface )
   : nh_(nh)
   , linked_interface_(linked_interface)
+  , sorted_ids_epoch_(0)
+  , sorted_ids_version_(0)
   {
     viewspace_service_ = nh.advertiseService("views/space", &RosServerCI::viewspaceService, this );
+    viewspace_sync_service_ = nh.advertiseService("views/sync", &RosServerCI::viewspaceSyncService, this );
     views_adder_service_ = nh.advertiseService("views/add", &RosServerCI::viewsAdderService, this );
     views_deleter_service_ = nh.advertiseService("views/delete", &RosServerCI::viewsDeleterService, this );
   }
@@ -96,6 +100,68 @@ namespace views
     return true;
   }
   
+  bool RosServerCI::viewspaceSyncService( ig_active_reconstruction_msgs::ViewSpaceSync::Request& req, ig_active_reconstruction_msgs::ViewSpaceSync::Response& res )
+  {
+    ROS_DEBUG("Received 'viewspace sync' call.");
+    if( linked_interface_ == nullptr )
+    {
+      ViewSpaceStatus status = ViewSpaceStatus::BAD;
+      res.viewspace_status = ros_conversions::viewSpaceStatusToMsg(status);
+      res.complete = true;
+      return true;
+    }
+    
+    const ViewSpace& viewspace = linked_interface_->getViewSpace();
+    res.epoch = viewspace.epoch();
+    res.version = viewspace.version();
+    
+    ViewSpace::ChangeSet changes;
+    res.is_delta = req.epoch==viewspace.epoch() && viewspace.getChangesSince(req.since_version,changes);
+    
+    const ViewSpace::IdSet* ids = &changes.updated;
+    if( !res.is_delta )
+    {
+      // the sorted ids are needed for every page, only sort them once per version
+      if( sorted_ids_epoch_!=viewspace.epoch() || sorted_ids_version_!=viewspace.version() )
+      {
+	sorted_ids_.clear();
+	for( const View& view: viewspace )
+	{
+	  sorted_ids_.push_back( view.index() );
+	}
+	std::sort( sorted_ids_.begin(), sorted_ids_.end() );
+	sorted_ids_epoch_ = viewspace.epoch();
+	sorted_ids_version_ = viewspace.version();
+      }
+      ids = &sorted_ids_;
+    }
+    else if( req.page_start_id==0 ) // state changes and deletions are sent with the first page
+    {
+      for( View::IdType& id: changes.state_changed )
+      {
+	ros_conversions::appendToCompactMsg( viewspace.getViewRef(id), res.changed_states, false );
+      }
+      res.deleted_ids = changes.deleted;
+    }
+    
+    ViewSpace::IdSet::const_iterator it = std::lower_bound( ids->begin(), ids->end(), req.page_start_id );
+    for( unsigned int nr_of_views=0; it!=ids->end() && (req.max_views==0 || nr_of_views<req.max_views); ++it, ++nr_of_views )
+    {
+      const View& view = viewspace.getViewRef(*it);
+      if( req.poses_only )
+	ros_conversions::appendToCompactMsg( view, res.compact_views );
+      else
+	res.views.push_back( ros_conversions::viewToMsg(view) );
+    }
+    res.complete = ( it==ids->end() );
+    res.next_page_start_id = res.complete? 0 : *it;
+    
+    ViewSpaceStatus status = ViewSpaceStatus::OK;
+    res.viewspace_status = ros_conversions::viewSpaceStatusToMsg(status);
+    
+    return true;
+  }
+  
   bool RosServerCI::viewsAdderService( ig_active_reconstruction_msgs::ViewSpaceUpdate::Request& req, ig_active_reconstruction_msgs::ViewSpaceUpdate::Response& res )
   {
     ROS_INFO("Received 'add view(s)' call.");
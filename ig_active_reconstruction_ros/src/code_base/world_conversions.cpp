@@ -100,6 +100,54 @@ namespace ros_conversions
     return command_msg;
   }
   
+  world_representation::CommunicationInterface::ViewspaceIgRetrievalCommand viewspaceIgRetrievalCommandFromMsg(ig_active_reconstruction_msgs::ViewspaceInformationGainRetrievalCommand& command_msg)
+  {
+    world_representation::CommunicationInterface::ViewspaceIgRetrievalCommand command;
+    
+    BOOST_FOREACH( geometry_msgs::Pose& pose, command_msg.views )
+    {
+      command.views.push_back( movements::fromROS(pose) );
+    }
+    
+    BOOST_FOREACH( std::string& name, command_msg.metric_names )
+    {
+      command.metric_names.push_back(name);
+    }
+    
+    BOOST_FOREACH( unsigned int& id, command_msg.metric_ids )
+    {
+      command.metric_ids.push_back(id);
+    }
+    
+    command.config = igRetrievalConfigFromMsg(command_msg.config);
+    
+    return command;
+  }
+  
+  ig_active_reconstruction_msgs::ViewspaceInformationGainRetrievalCommand viewspaceIgRetrievalCommandToMsg(world_representation::CommunicationInterface::ViewspaceIgRetrievalCommand& command)
+  {
+    ig_active_reconstruction_msgs::ViewspaceInformationGainRetrievalCommand command_msg;
+    
+    BOOST_FOREACH(movements::Pose& pose, command.views)
+    {
+      command_msg.views.push_back( movements::toROS(pose) );
+    }
+    
+    BOOST_FOREACH(std::string& name, command.metric_names)
+    {
+      command_msg.metric_names.push_back(name);
+    }
+    
+    BOOST_FOREACH(unsigned int& id, command.metric_ids)
+    {
+      command_msg.metric_ids.push_back(id);
+    }
+    
+    command_msg.config = igRetrievalConfigToMsg(command.config);
+    
+    return command_msg;
+  }
+  
   world_representation::CommunicationInterface::ResultInformation resultInformationFromMsg(int& msg)
   {
     switch(msg)
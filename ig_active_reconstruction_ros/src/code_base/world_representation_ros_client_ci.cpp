@@ -21,6 +21,7 @@
 #include "ig_active_reconstruction_ros/world_conversions.hpp"
 
 #include "ig_active_reconstruction_msgs/InformationGainCalculation.h"
+#include "ig_active_reconstruction_msgs/ViewspaceInformationGainCalculation.h"
 #include "ig_active_reconstruction_msgs/MapMetricCalculation.h"
 #include "ig_active_reconstruction_msgs/StringList.h"
 
@@ -35,6 +36,7 @@ namespace world_representation
   : nh_(nh)
   {
     view_ig_computation_ = nh.serviceClient<ig_active_reconstruction_msgs::InformationGainCalculation>("world/information_gain");
+    viewspace_ig_computation_ = nh.serviceClient<ig_active_reconstruction_msgs::ViewspaceInformationGainCalculation>("world/viewspace_information_gain");
     map_metric_computation_ = nh.serviceClient<ig_active_reconstruction_msgs::MapMetricCalculation>("world/map_metric");
     available_ig_receiver_ = nh.serviceClient<ig_active_reconstruction_msgs::StringList>("world/ig_list");
     available_mm_receiver_ = nh.serviceClient<ig_active_reconstruction_msgs::StringList>("world/mm_list");
@@ -72,6 +74,43 @@ namespace world_representation
     }
   }
   
+  RosClientCI::ResultInformation RosClientCI::computeViewspaceIg(ViewspaceIgRetrievalCommand& command, ViewspaceIgResult& output_ig)
+  {
+    ig_active_reconstruction_msgs::ViewspaceInformationGainCalculation call;
+    call.request.command = ros_conversions::viewspaceIgRetrievalCommandToMsg(command);
+    
+    ROS_INFO_STREAM("Demanding information gain for "<<command.views.size()<<" views.");
+    bool response = viewspace_ig_computation_.call(call);
+    
+    if(!response)
+    {
+      unsigned int number_of_metrics = (!command.metric_ids.empty())?command.metric_ids.size():command.metric_names.size();
+      IgRetrievalResult failed;
+      failed.status = ResultInformation::FAILED;
+      failed.predicted_gain = 0;
+      
+      ViewIgResult failed_view(number_of_metrics,failed);
+      for(unsigned int i=0; i<command.views.size(); ++i )
+      {
+	output_ig.push_back(failed_view);
+      }
+      return ResultInformation::FAILED;
+    }
+    else
+    {
+      for(ig_active_reconstruction_msgs::ViewInformationGain& view_ig: call.response.expected_information)
+      {
+	ViewIgResult view_result;
+	for(ig_active_reconstruction_msgs::InformationGain& ig: view_ig.expected_information)
+	{
+	  view_result.push_back( ros_conversions::igRetrievalResultFromMsg(ig) );
+	}
+	output_ig.push_back(view_result);
+      }
+      return ResultInformation::SUCCEEDED;
+    }
+  }
+  
   RosClientCI::ResultInformation RosClientCI::computeMapMetric(MapMetricRetrievalCommand& command, MapMetricRetrievalResultSet& output)
   {
     ig_active_reconstruction_msgs::MapMetricCalculation call;
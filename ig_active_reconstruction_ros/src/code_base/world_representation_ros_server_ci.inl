@@ -36,6 +36,7 @@ namespace world_representation
   , linked_interface_(linked_interface)
   {
     view_ig_computation_ = nh.advertiseService("world/information_gain", &CSCOPE::igComputationService, this );
+    viewspace_ig_computation_ = nh.advertiseService("world/viewspace_information_gain", &CSCOPE::viewspaceIgComputationService, this );
     map_metric_computation_ = nh.advertiseService("world/map_metric", &CSCOPE::mmComputationService, this );
     available_ig_receiver_ = nh.advertiseService("world/ig_list", &CSCOPE::availableIgService, this );
     available_mm_receiver_ = nh.advertiseService("world/mm_list", &CSCOPE::availableMmService, this );
@@ -50,6 +51,15 @@ namespace world_representation
     return linked_interface_->computeViewIg(command, output_ig);
   }
   
+  TEMPT
+  typename CSCOPE::ResultInformation CSCOPE::computeViewspaceIg(ViewspaceIgRetrievalCommand& command, ViewspaceIgResult& output_ig)
+  {
+    if( linked_interface_ == NULL )
+      throw std::runtime_error("world_representation::CSCOPE::Interface not linked.");
+    
+    return linked_interface_->computeViewspaceIg(command, output_ig);
+  }
+  
   TEMPT
   typename CSCOPE::ResultInformation CSCOPE::computeMapMetric(MapMetricRetrievalCommand& command, MapMetricRetrievalResultSet& output)
   {
@@ -106,6 +116,39 @@ namespace world_representation
     return true;
   }
   
+  TEMPT
+  bool CSCOPE::viewspaceIgComputationService( ig_active_reconstruction_msgs::ViewspaceInformationGainCalculation::Request& req, ig_active_reconstruction_msgs::ViewspaceInformationGainCalculation::Response& res )
+  {
+    ROS_INFO_STREAM("Received 'viewspace ig computation' call for "<<req.command.views.size()<<" views.");
+    if( linked_interface_ == NULL )
+    {
+      ig_active_reconstruction_msgs::InformationGain failed;
+      failed.predicted_gain = 0;
+      ResultInformation failed_status = ResultInformation::FAILED;
+      failed.status = ros_conversions::resultInformationToMsg(failed_status);
+      unsigned int number_of_metrics = (!req.command.metric_ids.empty())?req.command.metric_ids.size():req.command.metric_names.size();
+      
+      ig_active_reconstruction_msgs::ViewInformationGain failed_view;
+      failed_view.expected_information.resize(number_of_metrics,failed);
+      res.expected_information.resize(req.command.views.size(),failed_view);
+      return true;
+    }
+    
+    ViewspaceIgResult result;
+    ViewspaceIgRetrievalCommand command = ros_conversions::viewspaceIgRetrievalCommandFromMsg(req.command);
+    linked_interface_->computeViewspaceIg(command,result);
+    
+    res.expected_information.resize(result.size());
+    for( unsigned int i=0; i<result.size(); ++i )
+    {
+      BOOST_FOREACH(IgRetrievalResult& ig_res, result[i])
+      {
+	res.expected_information[i].expected_information.push_back( ros_conversions::igRetrievalResultToMsg(ig_res) );
+      }
+    }
+    return true;
+  }
+  
   TEMPT
   bool CSCOPE::mmComputationService( ig_active_reconstruction_msgs::MapMetricCalculation::Request& req, ig_active_reconstruction_msgs::MapMetricCalculation::Response& res )
   {
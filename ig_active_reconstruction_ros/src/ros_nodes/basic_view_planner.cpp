@@ -61,11 +61,22 @@ int main(int argc, char **argv)
   std::vector<double> ig_weights;
   ros_tools::getParamIfAvailableSilent( ig_names, "ig_names" );
   ros_tools::getParamIfAvailableSilent( ig_weights, "ig_weights" );
+  unsigned int ig_threads, max_local_ig_requests, max_remote_ig_requests, views_per_ig_request;
+  ros_tools::getParam<unsigned int, int>( ig_threads, "ig_threads", 8 );
+  ros_tools::getParam<unsigned int, int>( max_local_ig_requests, "max_local_ig_requests", 0 );
+  ros_tools::getParam<unsigned int, int>( max_remote_ig_requests, "max_remote_ig_requests", 8 );
+  ros_tools::getParam<unsigned int, int>( views_per_ig_request, "views_per_ig_request", 0 );
   
   // for the termination critera
   unsigned int max_calls;
   ros_tools::getParam<unsigned int, int>( max_calls, "max_calls", 20 );
   
+  // for the viewspace transfer
+  unsigned int viewspace_page_size;
+  bool viewspace_poses_only;
+  ros_tools::getParam<unsigned int, int>( viewspace_page_size, "viewspace_page_size", 5000 );
+  ros_tools::getParam( viewspace_poses_only, "viewspace_poses_only", false );
+  
   
   
   // only the view planner resides here
@@ -76,7 +87,7 @@ int main(int argc, char **argv)
   // robot, viewspace module and world representation are external
   // ...................................................................................................................
   boost::shared_ptr<iar::robot::CommunicationInterface> robot_comm = boost::make_shared<iar::robot::RosClientCI>(nh);
-  boost::shared_ptr<iar::views::CommunicationInterface> views_comm = boost::make_shared<iar::views::RosClientCI>(nh);
+  boost::shared_ptr<iar::views::CommunicationInterface> views_comm = boost::make_shared<iar::views::RosClientCI>(nh,viewspace_page_size,viewspace_poses_only);
   boost::shared_ptr<iar::world_representation::CommunicationInterface> world_comm = boost::make_shared<iar::world_representation::RosClientCI>(nh);
   
   view_planner.setRobotCommUnit(robot_comm);
@@ -89,6 +100,9 @@ int main(int argc, char **argv)
   boost::shared_ptr<iar::WeightedLinearUtility> utility_calculator = boost::make_shared<iar::WeightedLinearUtility>(cost_weight);
   utility_calculator->setRobotCommUnit(robot_comm);
   utility_calculator->setWorldCommUnit(world_comm);
+  utility_calculator->setNumberOfThreads(ig_threads);
+  utility_calculator->setMaxRequestsInFlight(max_local_ig_requests,max_remote_ig_requests);
+  utility_calculator->setViewsPerRequest(views_per_ig_request);
   
   for(unsigned int i=0;i<ig_names.size() && i<ig_weights.size(); ++i)
   {